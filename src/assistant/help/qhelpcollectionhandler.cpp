@@ -13,6 +13,7 @@
 #include <QtCore/QFileInfo>
 #include <QtCore/QList>
 #include <QtCore/QMultiMap>
+#include <QtCore/QThreadStorage>
 #include <QtCore/QTimer>
 #include <QtCore/QVersionNumber>
 
@@ -56,9 +57,13 @@ private:
     bool m_inTransaction;
 };
 
+// Identifies the readers of a handler, see readerForNamespace()
+static QAtomicInteger<quint64> nextHandlerId;
+
 QHelpCollectionHandler::QHelpCollectionHandler(const QString &collectionFile, QObject *parent)
     : QObject(parent)
     , m_collectionFile(collectionFile)
+    , m_id(nextHandlerId++)
 {
     const QFileInfo fi(m_collectionFile);
     if (!fi.isAbsolute())
@@ -72,6 +77,7 @@ QHelpCollectionHandler::~QHelpCollectionHandler()
 
 bool QHelpCollectionHandler::isDBOpened() const
 {
+    QMutexLocker locker(&m_mutex);
     if (m_query)
         return true;
     auto *that = const_cast<QHelpCollectionHandler *>(this);
@@ -82,9 +88,11 @@ bool QHelpCollectionHandler::isDBOpened() const
 
 void QHelpCollectionHandler::closeDB()
 {
+    QMutexLocker locker(&m_mutex);
     if (!m_query)
         return;
 
+    clearReaders();
     delete m_query;
     m_query = nullptr;
     QSqlDatabase::removeDatabase(m_connectionName);
@@ -98,6 +106,7 @@ QString QHelpCollectionHandler::collectionFile() const
 
 bool QHelpCollectionHandler::openCollectionFile()
 {
+    QMutexLocker locker(&m_mutex);
     if (m_query)
         return true;
 
@@ -245,6 +254,7 @@ QString QHelpCollectionHandler::absoluteDocPath(const QString &fileName) const
 
 bool QHelpCollectionHandler::isTimeStampCorrect(const TimeStamp &timeStamp) const
 {
+    QMutexLocker locker(&m_mutex);
     const QFileInfo fi(absoluteDocPath(timeStamp.fileName));
 
     if (!fi.exists())
@@ -273,6 +283,7 @@ bool QHelpCollectionHandler::isTimeStampCorrect(const TimeStamp &timeStamp) cons
 
 bool QHelpCollectionHandler::hasTimeStampInfo(const QString &nameSpace) const
 {
+    QMutexLocker locker(&m_mutex);
     m_query->prepare(QLatin1String("SELECT "
                                       "TimeStampTable.NamespaceId "
                                   "FROM "
@@ -302,6 +313,7 @@ void QHelpCollectionHandler::scheduleVacuum()
 
 void QHelpCollectionHandler::execVacuum()
 {
+    QMutexLocker locker(&m_mutex);
     if (!m_query)
         return;
 
@@ -311,6 +323,7 @@ void QHelpCollectionHandler::execVacuum()
 
 bool QHelpCollectionHandler::copyCollectionFile(const QString &fileName)
 {
+    QMutexLocker locker(&m_mutex);
     if (!m_query)
         return false;
 
@@ -527,6 +540,7 @@ bool QHelpCollectionHandler::recreateIndexAndNamespaceFilterTables(QSqlQuery *qu
 
 QStringList QHelpCollectionHandler::customFilters() const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList list;
     if (m_query) {
         m_query->exec(QLatin1String("SELECT Name FROM FilterNameTable"));
@@ -539,6 +553,7 @@ QStringList QHelpCollectionHandler::customFilters() const
 
 QStringList QHelpCollectionHandler::filters() const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList list;
     if (m_query) {
         m_query->exec(QLatin1String("SELECT Name FROM Filter ORDER BY Name"));
@@ -550,6 +565,7 @@ QStringList QHelpCollectionHandler::filters() const
 
 QStringList QHelpCollectionHandler::availableComponents() const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList list;
     if (m_query) {
         m_query->exec(QLatin1String("SELECT DISTINCT Name FROM ComponentTable ORDER BY Name"));
@@ -561,6 +577,7 @@ QStringList QHelpCollectionHandler::availableComponents() const
 
 QList<QVersionNumber> QHelpCollectionHandler::availableVersions() const
 {
+    QMutexLocker locker(&m_mutex);
     QList<QVersionNumber> list;
     if (m_query) {
         m_query->exec(QLatin1String("SELECT DISTINCT Version FROM VersionTable ORDER BY Version"));
@@ -572,6 +589,7 @@ QList<QVersionNumber> QHelpCollectionHandler::availableVersions() const
 
 QMap<QString, QString> QHelpCollectionHandler::namespaceToComponent() const
 {
+    QMutexLocker locker(&m_mutex);
     QMap<QString, QString> result;
     if (m_query) {
         m_query->exec(QLatin1String("SELECT "
@@ -590,6 +608,7 @@ QMap<QString, QString> QHelpCollectionHandler::namespaceToComponent() const
 
 QMap<QString, QVersionNumber> QHelpCollectionHandler::namespaceToVersion() const
 {
+    QMutexLocker locker(&m_mutex);
     QMap<QString, QVersionNumber> result;
     if (m_query) {
         m_query->exec(QLatin1String("SELECT "
@@ -608,6 +627,7 @@ QMap<QString, QVersionNumber> QHelpCollectionHandler::namespaceToVersion() const
 
 QHelpFilterData QHelpCollectionHandler::filterData(const QString &filterName) const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList components;
     QList<QVersionNumber> versions;
     if (m_query) {
@@ -641,6 +661,7 @@ QHelpFilterData QHelpCollectionHandler::filterData(const QString &filterName) co
 bool QHelpCollectionHandler::setFilterData(const QString &filterName,
                                            const QHelpFilterData &filterData)
 {
+    QMutexLocker locker(&m_mutex);
     if (!removeFilter(filterName))
         return false;
 
@@ -686,6 +707,7 @@ bool QHelpCollectionHandler::setFilterData(const QString &filterName,
 
 bool QHelpCollectionHandler::removeFilter(const QString &filterName)
 {
+    QMutexLocker locker(&m_mutex);
     m_query->prepare(QLatin1String("SELECT FilterId "
                                    "FROM Filter "
                                    "WHERE Name = ?"));
@@ -721,6 +743,7 @@ bool QHelpCollectionHandler::removeFilter(const QString &filterName)
 
 bool QHelpCollectionHandler::removeCustomFilter(const QString &filterName)
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened() || filterName.isEmpty())
         return false;
 
@@ -750,6 +773,7 @@ bool QHelpCollectionHandler::removeCustomFilter(const QString &filterName)
 bool QHelpCollectionHandler::addCustomFilter(const QString &filterName,
                                              const QStringList &attributes)
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened() || filterName.isEmpty())
         return false;
 
@@ -807,6 +831,7 @@ bool QHelpCollectionHandler::addCustomFilter(const QString &filterName,
 QHelpCollectionHandler::FileInfo QHelpCollectionHandler::registeredDocumentation(
         const QString &namespaceName) const
 {
+    QMutexLocker locker(&m_mutex);
     FileInfo fileInfo;
 
     if (!m_query)
@@ -836,6 +861,7 @@ QHelpCollectionHandler::FileInfo QHelpCollectionHandler::registeredDocumentation
 
 QHelpCollectionHandler::FileInfoList QHelpCollectionHandler::registeredDocumentations() const
 {
+    QMutexLocker locker(&m_mutex);
     FileInfoList list;
     if (!m_query)
         return list;
@@ -862,6 +888,7 @@ QHelpCollectionHandler::FileInfoList QHelpCollectionHandler::registeredDocumenta
 
 bool QHelpCollectionHandler::registerDocumentation(const QString &fileName)
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return false;
 
@@ -891,6 +918,7 @@ bool QHelpCollectionHandler::registerDocumentation(const QString &fileName)
     for (const QString &filterName : reader.customFilters())
         addCustomFilter(filterName, reader.filterAttributes(filterName));
 
+    clearReaders();
     if (!registerIndexTable(reader.indexTable(), nsId, vfId, registeredDocumentation(ns).fileName))
         return false;
 
@@ -899,6 +927,7 @@ bool QHelpCollectionHandler::registerDocumentation(const QString &fileName)
 
 bool QHelpCollectionHandler::unregisterDocumentation(const QString &namespaceName)
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return false;
 
@@ -913,6 +942,7 @@ bool QHelpCollectionHandler::unregisterDocumentation(const QString &namespaceNam
 
     const int nsId = m_query->value(0).toInt();
 
+    clearReaders();
     m_query->prepare(QLatin1String("DELETE FROM NamespaceTable WHERE Id = ?"));
     m_query->bindValue(0, nsId);
     if (!m_query->exec())
@@ -968,6 +998,7 @@ static QHelpCollectionHandler::FileInfo extractFileInfo(const QUrl &url)
 
 bool QHelpCollectionHandler::fileExists(const QUrl &url) const
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return false;
 
@@ -1114,6 +1145,7 @@ void bindFilterQuery(QSqlQuery *query, int startingBindPos, const QStringList &f
 QString QHelpCollectionHandler::namespaceForFile(const QUrl &url,
                                                  const QStringList &filterAttributes) const
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return QString();
 
@@ -1173,6 +1205,7 @@ QString QHelpCollectionHandler::namespaceForFile(const QUrl &url,
 QString QHelpCollectionHandler::namespaceForFile(const QUrl &url,
                                                  const QString &filterName) const
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return QString();
 
@@ -1229,6 +1262,7 @@ QStringList QHelpCollectionHandler::files(const QString &namespaceName,
                                           const QStringList &filterAttributes,
                                           const QString &extensionFilter) const
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return QStringList();
 
@@ -1279,6 +1313,7 @@ QStringList QHelpCollectionHandler::files(const QString &namespaceName,
                                           const QString &filterName,
                                           const QString &extensionFilter) const
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return QStringList();
 
@@ -1350,8 +1385,83 @@ QUrl QHelpCollectionHandler::findFile(const QUrl &url, const QString &filterName
     return result;
 }
 
+// The documentation files that one thread has open, for all collection
+// handlers. An SQL connection must only be used, and closed, by the thread
+// that opened it, so the readers are deleted by their thread: on the next
+// lookup after the handler cleared them, or when the thread exits.
+struct ThreadReaders
+{
+    ~ThreadReaders() { qDeleteAll(readers); }
+
+    void remove(quint64 handlerId)
+    {
+        for (auto it = readers.begin(); it != readers.end(); ) {
+            if (it.key().first == handlerId) {
+                delete it.value();
+                it = readers.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        generations.remove(handlerId);
+    }
+
+    QHash<QPair<quint64, QString>, QHelpDBReader *> readers; // by handler and namespace
+    QHash<quint64, quint64> generations; // of the readers of each handler
+};
+
+static QThreadStorage<ThreadReaders *> threadReaders;
+
+// Must be called with m_mutex locked.
+QHelpDBReader *QHelpCollectionHandler::readerForNamespace(const QString &namespaceName) const
+{
+    const FileInfo docInfo = registeredDocumentation(namespaceName);
+    const QString absFileName = absoluteDocPath(docInfo.fileName);
+
+    ThreadReaders *local = threadReaders.localData();
+    if (!local) {
+        local = new ThreadReaders;
+        threadReaders.setLocalData(local);
+    }
+    const auto generation = local->generations.constFind(m_id);
+    if (generation == local->generations.cend() || *generation != m_readersGeneration) {
+        local->remove(m_id);
+        local->generations.insert(m_id, m_readersGeneration);
+    }
+
+    const QPair<quint64, QString> key(m_id, namespaceName);
+    QHelpDBReader *reader = local->readers.value(key);
+    if (reader && reader->databaseName() == absFileName)
+        return reader;
+    delete reader;
+    local->readers.remove(key);
+
+    // No parent, as the reader may live in another thread than the handler
+    auto *that = const_cast<QHelpCollectionHandler *>(this);
+    reader = new QHelpDBReader(absFileName, QHelpGlobal::uniquifyConnectionName(
+                                   docInfo.fileName, that), nullptr);
+    if (!reader->init()) {
+        delete reader;
+        return nullptr;
+    }
+    local->readers.insert(key, reader);
+    return reader;
+}
+
+void QHelpCollectionHandler::clearReaders()
+{
+    QMutexLocker locker(&m_mutex);
+    // The readers of other threads are deleted by them
+    ++m_readersGeneration;
+    if (ThreadReaders *local = threadReaders.localData())
+        local->remove(m_id);
+    m_fileDataCache.clear();
+}
+
 QByteArray QHelpCollectionHandler::fileData(const QUrl &url) const
 {
+    // Guards the collection query used by namespaceForFile(), and the page cache
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return QByteArray();
 
@@ -1361,19 +1471,24 @@ QByteArray QHelpCollectionHandler::fileData(const QUrl &url) const
 
     const FileInfo fileInfo = extractFileInfo(url);
 
-    const FileInfo docInfo = registeredDocumentation(namespaceName);
-    const QString absFileName = absoluteDocPath(docInfo.fileName);
+    const QString cacheKey = namespaceName + QLatin1Char('/') + fileInfo.folderName
+            + QLatin1Char('/') + fileInfo.fileName;
+    if (const QByteArray *data = m_fileDataCache.object(cacheKey))
+        return *data;
 
-    QHelpDBReader reader(absFileName, QHelpGlobal::uniquifyConnectionName(
-                             docInfo.fileName, const_cast<QHelpCollectionHandler *>(this)), nullptr);
-    if (!reader.init())
+    QHelpDBReader *reader = readerForNamespace(namespaceName);
+    if (!reader)
         return QByteArray();
 
-    return reader.fileData(fileInfo.folderName, fileInfo.fileName);
+    const QByteArray data = reader->fileData(fileInfo.folderName, fileInfo.fileName);
+    if (!data.isEmpty())
+        m_fileDataCache.insert(cacheKey, new QByteArray(data), data.size());
+    return data;
 }
 
 QStringList QHelpCollectionHandler::indicesForFilter(const QStringList &filterAttributes) const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList indices;
 
     if (!isDBOpened())
@@ -1414,6 +1529,7 @@ QStringList QHelpCollectionHandler::indicesForFilter(const QStringList &filterAt
 
 QStringList QHelpCollectionHandler::indicesForFilter(const QString &filterName) const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList indices;
 
     if (!isDBOpened())
@@ -1466,6 +1582,7 @@ static QString getTitle(const QByteArray &contents)
 QList<QHelpCollectionHandler::ContentsData> QHelpCollectionHandler::contentsForFilter(
         const QStringList &filterAttributes) const
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return QList<ContentsData>();
 
@@ -1529,6 +1646,7 @@ QList<QHelpCollectionHandler::ContentsData> QHelpCollectionHandler::contentsForF
 
 QList<QHelpCollectionHandler::ContentsData> QHelpCollectionHandler::contentsForFilter(const QString &filterName) const
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return QList<ContentsData>();
 
@@ -1588,6 +1706,7 @@ QList<QHelpCollectionHandler::ContentsData> QHelpCollectionHandler::contentsForF
 
 bool QHelpCollectionHandler::removeCustomValue(const QString &key)
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return false;
 
@@ -1599,6 +1718,7 @@ bool QHelpCollectionHandler::removeCustomValue(const QString &key)
 QVariant QHelpCollectionHandler::customValue(const QString &key,
                                              const QVariant &defaultValue) const
 {
+    QMutexLocker locker(&m_mutex);
     if (!m_query)
         return defaultValue;
 
@@ -1624,6 +1744,7 @@ QVariant QHelpCollectionHandler::customValue(const QString &key,
 bool QHelpCollectionHandler::setCustomValue(const QString &key,
                                             const QVariant &value)
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return false;
 
@@ -1645,6 +1766,7 @@ bool QHelpCollectionHandler::setCustomValue(const QString &key,
 bool QHelpCollectionHandler::registerFilterAttributes(const QList<QStringList> &attributeSets,
                                                       int nsId)
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return false;
 
@@ -1668,6 +1790,7 @@ bool QHelpCollectionHandler::registerFilterAttributes(const QList<QStringList> &
 bool QHelpCollectionHandler::registerFileAttributeSets(const QList<QStringList> &attributeSets,
                                                        int nsId)
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return false;
 
@@ -1713,6 +1836,7 @@ bool QHelpCollectionHandler::registerFileAttributeSets(const QList<QStringList>
 
 QStringList QHelpCollectionHandler::filterAttributes() const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList list;
     if (m_query) {
         m_query->exec(QLatin1String("SELECT Name FROM FilterAttributeTable"));
@@ -1724,6 +1848,7 @@ QStringList QHelpCollectionHandler::filterAttributes() const
 
 QStringList QHelpCollectionHandler::filterAttributes(const QString &filterName) const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList list;
     if (m_query) {
         m_query->prepare(QLatin1String(
@@ -1746,6 +1871,7 @@ QStringList QHelpCollectionHandler::filterAttributes(const QString &filterName)
 
 QList<QStringList> QHelpCollectionHandler::filterAttributeSets(const QString &namespaceName) const
 {
+    QMutexLocker locker(&m_mutex);
     QList<QStringList> result;
     if (!isDBOpened())
         return result;
@@ -1782,6 +1908,7 @@ QList<QStringList> QHelpCollectionHandler::filterAttributeSets(const QString &na
 
 QString QHelpCollectionHandler::namespaceVersion(const QString &namespaceName) const
 {
+    QMutexLocker locker(&m_mutex);
     if (!m_query)
         return QString();
 
@@ -1804,6 +1931,7 @@ QString QHelpCollectionHandler::namespaceVersion(const QString &namespaceName) c
 
 int QHelpCollectionHandler::registerNamespace(const QString &nspace, const QString &fileName)
 {
+    QMutexLocker locker(&m_mutex);
     const int errorValue = -1;
     if (!m_query)
         return errorValue;
@@ -1836,6 +1964,7 @@ int QHelpCollectionHandler::registerNamespace(const QString &nspace, const QStri
 
 int QHelpCollectionHandler::registerVirtualFolder(const QString &folderName, int namespaceId)
 {
+    QMutexLocker locker(&m_mutex);
     if (!m_query)
         return false;
 
@@ -1861,6 +1990,7 @@ int QHelpCollectionHandler::registerVirtualFolder(const QString &folderName, int
 
 int QHelpCollectionHandler::registerComponent(const QString &componentName, int namespaceId)
 {
+    QMutexLocker locker(&m_mutex);
     m_query->prepare(QLatin1String("SELECT ComponentId FROM ComponentTable WHERE Name = ?"));
     m_query->bindValue(0, componentName);
     if (!m_query->exec())
@@ -1891,6 +2021,7 @@ int QHelpCollectionHandler::registerComponent(const QString &componentName, int
 
 bool QHelpCollectionHandler::registerVersion(const QString &version, int namespaceId)
 {
+    QMutexLocker locker(&m_mutex);
     if (!m_query)
         return false;
 
@@ -1905,6 +2036,7 @@ bool QHelpCollectionHandler::registerVersion(const QString &version, int namespa
 bool QHelpCollectionHandler::registerIndexAndNamespaceFilterTables(
         const QString &nameSpace, bool createDefaultVersionFilter)
 {
+    QMutexLocker locker(&m_mutex);
     if (!isDBOpened())
         return false;
 
@@ -1967,6 +2099,7 @@ void QHelpCollectionHandler::createVersionFilter(const QString &version)
 bool QHelpCollectionHandler::registerIndexTable(const QHelpDBReader::IndexTable &indexTable,
                                                 int nsId, int vfId, const QString &fileName)
 {
+    QMutexLocker locker(&m_mutex);
     Transaction transaction(m_connectionName);
 
     QMap<QString, QVariantList> filterAttributeToNewFileId;
@@ -2183,6 +2316,7 @@ bool QHelpCollectionHandler::registerIndexTable(const QHelpDBReader::IndexTable
 
 bool QHelpCollectionHandler::unregisterIndexTable(int nsId, int vfId)
 {
+    QMutexLocker locker(&m_mutex);
     m_query->prepare(QLatin1String("DELETE FROM IndexFilterTable WHERE IndexId IN "
                                        "(SELECT Id FROM IndexTable WHERE NamespaceId = ?)"));
     m_query->bindValue(0, nsId);
@@ -2323,6 +2457,7 @@ QList<QHelpLink> QHelpCollectionHandler::documentsForField(
         const QString &fieldValue,
         const QStringList &filterAttributes) const
 {
+    QMutexLocker locker(&m_mutex);
     QList<QHelpLink> docList;
 
     if (!isDBOpened())
@@ -2418,6 +2553,7 @@ QList<QHelpLink> QHelpCollectionHandler::documentsForField(
         const QString &fieldValue,
         const QString &filterName) const
 {
+    QMutexLocker locker(&m_mutex);
     QList<QHelpLink> docList;
 
     if (!isDBOpened())
@@ -2466,6 +2602,7 @@ QList<QHelpLink> QHelpCollectionHandler::documentsForField(
 
 QStringList QHelpCollectionHandler::namespacesForFilter(const QString &filterName) const
 {
+    QMutexLocker locker(&m_mutex);
     QStringList namespaceList;
 
     if (!isDBOpened())
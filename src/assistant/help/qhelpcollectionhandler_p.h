@@ -15,7 +15,10 @@
 // We mean it.
 //
 
+#include <QtCore/QCache>
+#include <QtCore/QHash>
 #include <QtCore/QList>
+#include <QtCore/QMutex>
 #include <QtCore/QString>
 #include <QtCore/QObject>
 #include <QtCore/QVariant>
@@ -215,6 +218,8 @@ private:
                             int nsId, int vfId, const QString &fileName);
     bool unregisterIndexTable(int nsId, int vfId);
     QString absoluteDocPath(const QString &fileName) const;
+    QHelpDBReader *readerForNamespace(const QString &namespaceName) const;
+    void clearReaders();
     bool isTimeStampCorrect(const TimeStamp &timeStamp) const;
     bool hasTimeStampInfo(const QString &nameSpace) const;
     void scheduleVacuum();
@@ -223,6 +228,13 @@ private:
     QString m_collectionFile;
     QString m_connectionName;
     QSqlQuery *m_query = nullptr;
+    // Serializes the use of m_query and of the page cache, as fileData()
+    // may be called from several threads. The documentation files are
+    // opened by each thread on its own, see readerForNamespace().
+    mutable QRecursiveMutex m_mutex;
+    const quint64 m_id;
+    quint64 m_readersGeneration = 0;
+    mutable QCache<QString, QByteArray> m_fileDataCache { 16 * 1024 * 1024 };
     bool m_vacuumScheduled = false;
     bool m_readOnly = true;
 };
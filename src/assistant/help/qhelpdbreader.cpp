@@ -6,7 +6,7 @@
 
 #include <QtCore/QFile>
 #include <QtCore/QList>
-#include <QtCore/QMultiMap>
+#include <QtCore/QMap>
 #include <QtCore/QVariant>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
@@ -32,6 +32,7 @@ QHelpDBReader::QHelpDBReader(const QString &dbName, const QString &uniqueId,
 QHelpDBReader::~QHelpDBReader()
 {
     if (m_initDone) {
+        m_fileDataQuery.reset();
         delete m_query;
         QSqlDatabase::removeDatabase(m_uniqueId);
     }
@@ -385,7 +386,11 @@ QByteArray QHelpDBReader::fileData(const QString &virtualFolder,
         return ba;
 
     namespaceName();
-    m_query->prepare(QLatin1String(
+    // The same statement serves every page of a documentation set,
+    // so it is prepared only once.
+    if (!m_fileDataQuery) {
+        m_fileDataQuery = std::make_unique<QSqlQuery>(QSqlDatabase::database(m_uniqueId));
+        if (!m_fileDataQuery->prepare(QLatin1String(
                     "SELECT "
                         "FileDataTable.Data "
                     "FROM "
@@ -398,14 +403,18 @@ QByteArray QHelpDBReader::fileData(const QString &virtualFolder,
                     "AND FileNameTable.FolderId = FolderTable.Id "
                     "AND FolderTable.Name = ? "
                     "AND FolderTable.NamespaceId = NamespaceTable.Id "
-                    "AND NamespaceTable.Name = ?"));
-    m_query->bindValue(0, filePath);
-    m_query->bindValue(1, QString(QLatin1String("./") + filePath));
-    m_query->bindValue(2, virtualFolder);
-    m_query->bindValue(3, m_namespace);
-    m_query->exec();
-    if (m_query->next() && m_query->isValid())
-        ba = qUncompress(m_query->value(0).toByteArray());
+                    "AND NamespaceTable.Name = ?"))) {
+            m_fileDataQuery.reset();
+            return ba;
+        }
+    }
+    m_fileDataQuery->bindValue(0, filePath);
+    m_fileDataQuery->bindValue(1, QString(QLatin1String("./") + filePath));
+    m_fileDataQuery->bindValue(2, virtualFolder);
+    m_fileDataQuery->bindValue(3, m_namespace);
+    if (m_fileDataQuery->exec() && m_fileDataQuery->next() && m_fileDataQuery->isValid())
+        ba = qUncompress(m_fileDataQuery->value(0).toByteArray());
+    m_fileDataQuery->finish();
     return ba;
 }
 
@@ -446,29 +455,36 @@ QStringList QHelpDBReader::filterAttributes(const QString &filterName) const
     return lst;
 }
 
-QMultiMap<QString, QByteArray> QHelpDBReader::filesData(const QStringList &filterAttributes,
-                                                        const QString &extensionFilter) const
+// Only the file names are read up front; the data of each file is read
+// and uncompressed when the cursor reaches it, so that at most one file
+// is held in memory at a time.
+QHelpDBReader::FileDataCursor QHelpDBReader::filesData(const QStringList &filterAttributes,
+                                                       const QStringList &extensionFilters) const
 {
-    QMultiMap<QString, QByteArray> result;
+    FileDataCursor cursor;
     if (!m_query)
-        return result;
+        return cursor;
 
     QString query;
     QString extension;
-    if (!extensionFilter.isEmpty())
-        extension = QString(QLatin1String("AND FileNameTable.Name "
-                                          "LIKE \'%.%1\'")).arg(extensionFilter);
+    if (!extensionFilters.isEmpty()) {
+        QStringList conditions;
+        for (const QString &extensionFilter : extensionFilters) {
+            conditions.append(QString(QLatin1String("FileNameTable.Name LIKE \'%.%1\'"))
+                              .arg(quote(extensionFilter)));
+        }
+        extension = QLatin1String("AND (") + conditions.join(QLatin1String(" OR "))
+                + QLatin1Char(')');
+    }
 
     if (filterAttributes.isEmpty()) {
         query = QString(QLatin1String("SELECT "
-                                          "FileNameTable.Name, "
-                                          "FileDataTable.Data "
+                                          "FileNameTable.FileId, "
+                                          "FileNameTable.Name "
                                       "FROM "
                                           "FolderTable, "
-                                          "FileNameTable, "
-                                          "FileDataTable "
-                                      "WHERE FileDataTable.Id = FileNameTable.FileId "
-                                      "AND FileNameTable.FolderId = FolderTable.Id %1"))
+                                          "FileNameTable "
+                                      "WHERE FileNameTable.FolderId = FolderTable.Id %1"))
             .arg(extension);
     } else {
         for (int i = 0; i < filterAttributes.size(); ++i) {
@@ -476,27 +492,59 @@ QMultiMap<QString, QByteArray> QHelpDBReader::filesData(const QStringList &filte
                 query.append(QLatin1String(" INTERSECT "));
             query.append(QString(QLatin1String(
                                      "SELECT "
-                                         "FileNameTable.Name, "
-                                         "FileDataTable.Data "
+                                         "FileNameTable.FileId, "
+                                         "FileNameTable.Name "
                                      "FROM "
                                          "FolderTable, "
                                          "FileNameTable, "
-                                         "FileDataTable, "
                                          "FileFilterTable, "
                                          "FilterAttributeTable "
-                                     "WHERE FileDataTable.Id = FileNameTable.FileId "
-                                     "AND FileNameTable.FolderId = FolderTable.Id "
+                                     "WHERE FileNameTable.FolderId = FolderTable.Id "
                                      "AND FileNameTable.FileId = FileFilterTable.FileId "
                                      "AND FileFilterTable.FilterAttributeId = FilterAttributeTable.Id "
                                      "AND FilterAttributeTable.Name = \'%1\' %2"))
                          .arg(quote(filterAttributes.at(i)), extension));
         }
     }
+    query.append(QLatin1String(" ORDER BY 2"));
+
     m_query->exec(query);
     while (m_query->next())
-        result.insert(m_query->value(0).toString(), qUncompress(m_query->value(1).toByteArray()));
+        cursor.m_files.append({ m_query->value(0).toInt(), m_query->value(1).toString() });
 
-    return result;
+    cursor.m_dataQuery.reset(new QSqlQuery(QSqlDatabase::database(m_uniqueId)));
+    cursor.m_dataQuery->setForwardOnly(true);
+    cursor.m_dataQuery->prepare(QLatin1String("SELECT Data FROM FileDataTable WHERE Id = ?"));
+    return cursor;
+}
+
+QHelpDBReader::FileDataCursor::FileDataCursor() = default;
+QHelpDBReader::FileDataCursor::FileDataCursor(FileDataCursor &&other) noexcept = default;
+QHelpDBReader::FileDataCursor::~FileDataCursor() = default;
+
+bool QHelpDBReader::FileDataCursor::next()
+{
+    if (m_index >= m_files.size())
+        return false;
+    return ++m_index < m_files.size();
+}
+
+QString QHelpDBReader::FileDataCursor::fileName() const
+{
+    return m_index >= 0 && m_index < m_files.size() ? m_files.at(m_index).second : QString();
+}
+
+QByteArray QHelpDBReader::FileDataCursor::fileData() const
+{
+    if (!m_dataQuery || m_index < 0 || m_index >= m_files.size())
+        return QByteArray();
+
+    m_dataQuery->bindValue(0, m_files.at(m_index).first);
+    QByteArray data;
+    if (m_dataQuery->exec() && m_dataQuery->next())
+        data = qUncompress(m_dataQuery->value(0).toByteArray());
+    m_dataQuery->finish();
+    return data;
 }
 
 QVariant QHelpDBReader::metaData(const QString &name) const
@@ -21,6 +21,8 @@
 #include <QtCore/QByteArray>
 #include <QtCore/QSet>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 class QSqlQuery;
@@ -58,6 +60,25 @@ public:
         QStringList filterAttributes;
     };
 
+    class FileDataCursor
+    {
+    public:
+        FileDataCursor();
+        FileDataCursor(FileDataCursor &&other) noexcept;
+        ~FileDataCursor();
+
+        bool next();
+        QString fileName() const;
+        QByteArray fileData() const;
+
+    private:
+        friend class QHelpDBReader;
+
+        QList<std::pair<int, QString>> m_files;
+        qsizetype m_index = -1;
+        std::unique_ptr<QSqlQuery> m_dataQuery;
+    };
+
     class IndexTable
     {
     public:
@@ -74,13 +95,14 @@ public:
 
     bool init();
 
+    QString databaseName() const { return m_dbName; }
     QString namespaceName() const;
     QString virtualFolder() const;
     QString version() const;
     IndexTable indexTable() const;
     QList<QStringList> filterAttributeSets() const;
-    QMultiMap<QString, QByteArray> filesData(const QStringList &filterAttributes,
-                                             const QString &extensionFilter = QString()) const;
+    FileDataCursor filesData(const QStringList &filterAttributes,
+                             const QStringList &extensionFilters = QStringList()) const;
     QByteArray fileData(const QString &virtualFolder,
         const QString &filePath) const;
 
@@ -99,6 +121,7 @@ private:
     QString m_uniqueId;
     QString m_error;
     QSqlQuery *m_query = nullptr;
+    mutable std::unique_ptr<QSqlQuery> m_fileDataQuery;
     mutable QString m_namespace;
 };
 
@@ -9,17 +9,23 @@
 #include <QtCore/QDataStream>
 #include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QHash>
+#include <QtCore/QMutex>
+#include <QtCore/QSemaphore>
 #include <QtCore/QStringDecoder>
 #include <QtCore/QTextStream>
+#include <QtCore/QThreadPool>
 #include <QtCore/QSet>
 #include <QtCore/QUrl>
 #include <QtCore/QVariant>
+#include <QtGui/QTextDocumentFragment>
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlDriver>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlQuery>
 
-#include <QTextDocument>
+#include <deque>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
@@ -28,6 +34,10 @@ namespace qt {
 
 const char FTS_DB_NAME[] = "fts";
 
+// Documents queued by insertDoc() are written once either limit is reached
+static const qsizetype MaxPendingDocs = 256;
+static const qsizetype MaxPendingSize = 8 * 1024 * 1024; // characters
+
 Writer::Writer(const QString &path)
     : m_dbDir(path)
 {
@@ -186,6 +196,7 @@ void Writer::flush()
     m_urls = QVariantList();
     m_titles = QVariantList();
     m_contents = QVariantList();
+    m_pendingSize = 0;
 }
 
 void Writer::removeNamespace(const QString &namespaceName)
@@ -230,6 +241,10 @@ void Writer::insertDoc(const QString &namespaceName,
     m_urls.append(url);
     m_titles.append(title);
     m_contents.append(contents);
+
+    m_pendingSize += title.size() + contents.size();
+    if (m_contents.size() >= MaxPendingDocs || m_pendingSize >= MaxPendingSize)
+        flush();
 }
 
 void Writer::startTransaction()
@@ -327,6 +342,217 @@ static bool clearIndexMap(QHelpEngineCore *engine)
     return engine->removeCustomValue(QLatin1String(IndexedNamespacesKey));
 }
 
+static bool isBlockElement(QStringView name)
+{
+    static const char *const blockElements[] = {
+        "address", "article", "aside", "blockquote", "br", "caption", "dd", "div", "dl", "dt",
+        "figcaption", "figure", "footer", "h1", "h2", "h3", "h4", "h5", "h6", "header", "hr",
+        "li", "nav", "ol", "p", "pre", "section", "table", "td", "th", "tr", "ul"
+    };
+    for (const char *blockElement : blockElements) {
+        if (name.compare(QLatin1String(blockElement), Qt::CaseInsensitive) == 0)
+            return true;
+    }
+    return false;
+}
+
+// Appends the character referred to by entity, without the leading '&'
+// and the trailing ';', to text. Returns false if the entity is unknown.
+static bool appendEntity(QStringView entity, QString *text)
+{
+    if (entity.startsWith(QLatin1Char('#'))) {
+        bool ok = false;
+        const uint code = (entity.size() > 1 && (entity.at(1) == QLatin1Char('x')
+                                                 || entity.at(1) == QLatin1Char('X')))
+                ? entity.mid(2).toUInt(&ok, 16) : entity.mid(1).toUInt(&ok, 10);
+        if (!ok || code == 0 || code > 0x10ffff)
+            return false;
+        if (code == 0xa0)
+            text->append(QLatin1Char(' '));
+        else
+            text->append(QChar::fromUcs4(code));
+        return true;
+    }
+
+    static const struct {
+        const char *name;
+        char16_t character;
+    } entities[] = {
+        { "amp", u'&' }, { "lt", u'<' }, { "gt", u'>' }, { "quot", u'"' }, { "apos", u'\'' },
+        { "nbsp", u' ' }, { "copy", u'\u00a9' }, { "reg", u'\u00ae' }, { "trade", u'\u2122' },
+        { "times", u'\u00d7' }, { "ndash", u'\u2013' }, { "mdash", u'\u2014' },
+        { "lsquo", u'\u2018' }, { "rsquo", u'\u2019' }, { "ldquo", u'\u201c' },
+        { "rdquo", u'\u201d' }, { "hellip", u'\u2026' }, { "laquo", u'\u00ab' },
+        { "raquo", u'\u00bb' }, { "middot", u'\u00b7' }, { "bull", u'\u2022' }
+    };
+    for (const auto &e : entities) {
+        if (entity == QLatin1String(e.name)) {
+            text->append(QChar(e.character));
+            return true;
+        }
+    }
+
+    // Leave the other named entities to the rich text parser, which knows
+    // all of them, and remember its answer, as pages repeat them a lot
+    static QMutex mutex;
+    static QHash<QString, QString> decodedEntities;
+    QMutexLocker locker(&mutex);
+    const QString name = entity.toString();
+    auto it = decodedEntities.constFind(name);
+    if (it == decodedEntities.cend()) {
+        const QString html = QLatin1Char('&') + name + QLatin1Char(';');
+        QString decoded = QTextDocumentFragment::fromHtml(html).toPlainText();
+        if (decoded == html)
+            decoded.clear();
+        it = decodedEntities.insert(name, decoded);
+    }
+    if (it->isEmpty())
+        return false;
+    text->append(*it);
+    return true;
+}
+
+// Appends a separator to text, collapsing runs of whitespace.
+static void appendSeparator(QString *text, QChar separator)
+{
+    if (text->isEmpty())
+        return;
+    if (text->back().isSpace()) {
+        if (separator == QLatin1Char('\n'))
+            text->back() = separator;
+        return;
+    }
+    text->append(separator);
+}
+
+// Extracts the title and the plain text of an HTML page for indexing.
+// This does what QTextDocument::setHtml() followed by toPlainText()
+// did, as far as the search index is concerned, without laying out a
+// document, and is safe to use from any thread.
+static QString htmlToPlainText(QStringView html, QString *title)
+{
+    QString text;
+    text.reserve(html.size() / 2);
+
+    qsizetype i = 0;
+    const qsizetype size = html.size();
+    while (i < size) {
+        const QChar c = html.at(i);
+        if (c == QLatin1Char('<')) {
+            if (html.mid(i, 4) == QLatin1String("<!--")) {
+                const qsizetype end = html.indexOf(QLatin1String("-->"), i + 4);
+                i = end < 0 ? size : end + 3;
+                continue;
+            }
+
+            qsizetype nameStart = i + 1;
+            const bool closing = nameStart < size && html.at(nameStart) == QLatin1Char('/');
+            if (closing)
+                ++nameStart;
+            qsizetype nameEnd = nameStart;
+            while (nameEnd < size && (html.at(nameEnd).isLetterOrNumber()
+                                      || html.at(nameEnd) == QLatin1Char('-'))) {
+                ++nameEnd;
+            }
+            const QStringView name = html.mid(nameStart, nameEnd - nameStart);
+
+            // Find the end of the tag, skipping quoted attribute values
+            qsizetype tagEnd = nameEnd;
+            QChar quote;
+            while (tagEnd < size) {
+                const QChar t = html.at(tagEnd);
+                if (!quote.isNull()) {
+                    if (t == quote)
+                        quote = QChar();
+                } else if (t == QLatin1Char('"') || t == QLatin1Char('\'')) {
+                    quote = t;
+                } else if (t == QLatin1Char('>')) {
+                    break;
+                }
+                ++tagEnd;
+            }
+            i = tagEnd + 1;
+
+            if (name.isEmpty() || closing) {
+                if (!name.isEmpty() && isBlockElement(name))
+                    appendSeparator(&text, QLatin1Char('\n'));
+                continue;
+            }
+
+            const bool isTitle = name.compare(QLatin1String("title"), Qt::CaseInsensitive) == 0;
+            if (isTitle || name.compare(QLatin1String("script"), Qt::CaseInsensitive) == 0
+                || name.compare(QLatin1String("style"), Qt::CaseInsensitive) == 0) {
+                const QString endTag = QLatin1String("</") + name.toString();
+                qsizetype end = html.indexOf(endTag, i, Qt::CaseInsensitive);
+                if (end < 0)
+                    end = size;
+                if (isTitle && title && title->isEmpty())
+                    *title = htmlToPlainText(html.mid(i, end - i), nullptr).simplified();
+                const qsizetype close = html.indexOf(QLatin1Char('>'), end);
+                i = close < 0 ? size : close + 1;
+                continue;
+            }
+
+            if (isBlockElement(name))
+                appendSeparator(&text, QLatin1Char('\n'));
+        } else if (c == QLatin1Char('&')) {
+            const qsizetype end = html.indexOf(QLatin1Char(';'), i + 1);
+            // The longest named entity has 31 characters
+            if (end > i + 1 && end - i <= 32 && appendEntity(html.mid(i + 1, end - i - 1), &text)) {
+                i = end + 1;
+            } else {
+                text.append(c);
+                ++i;
+            }
+        } else if (c.isSpace()) {
+            appendSeparator(&text, QLatin1Char(' '));
+            ++i;
+        } else {
+            text.append(c);
+            ++i;
+        }
+    }
+    return text;
+}
+
+namespace {
+
+// A page whose text is extracted on the thread pool.
+struct IndexedDoc
+{
+    QString url;
+    QByteArray data;
+    QString title;
+    QString contents;
+    bool isEmpty = true;
+    QSemaphore ready;
+};
+
+}
+
+static void extractText(IndexedDoc *doc)
+{
+    QTextStream s(doc->data);
+    auto encoding = QStringDecoder::encodingForHtml(doc->data);
+    if (encoding)
+        s.setEncoding(*encoding);
+
+    const QString &text = s.readAll();
+    doc->data = QByteArray();
+    if (text.isEmpty())
+        return;
+
+    doc->isEmpty = false;
+    if (doc->url.endsWith(QLatin1String(".txt"))) {
+        doc->title = doc->url.mid(doc->url.lastIndexOf(QLatin1Char('/')) + 1);
+        doc->contents = text.toHtmlEscaped();
+    } else {
+        QString title;
+        doc->contents = htmlToPlainText(text, &title).toHtmlEscaped();
+        doc->title = title.toHtmlEscaped();
+    }
+}
+
 void QHelpSearchIndexWriter::run()
 {
     QMutexLocker lock(&m_mutex);
@@ -357,6 +583,12 @@ void QHelpSearchIndexWriter::run()
     const QStringList &registeredDocs = engine.registeredDocumentations();
     QMap<QString, QDateTime> indexMap = readIndexMap(engine);
 
+    // Pages are converted to text on the pool, and inserted in order
+    // by this thread, which owns the database connections.
+    QThreadPool pool;
+    const qsizetype maxPendingDocs = 2 * qMax(1, pool.maxThreadCount());
+    std::deque<std::shared_ptr<IndexedDoc>> pendingDocs;
+
     if (!reindex) {
         for (const QString &namespaceName : registeredDocs) {
             if (indexMap.contains(namespaceName)) {
@@ -422,18 +654,20 @@ void QHelpSearchIndexWriter::run()
         for (const QStringList &attributes : attributeSets) {
             const QString &attributesString = attributes.join(QLatin1Char('|'));
 
-            const QMultiMap<QString, QByteArray> htmlFiles =
-                    reader.filesData(attributes, QLatin1String("html"));
-            const QMultiMap<QString, QByteArray> htmFiles =
-                    reader.filesData(attributes, QLatin1String("htm"));
-            const QMultiMap<QString, QByteArray> txtFiles =
-                    reader.filesData(attributes, QLatin1String("txt"));
+            const auto insertOldestDoc = [&]() {
+                const std::shared_ptr<IndexedDoc> doc = pendingDocs.front();
+                pendingDocs.pop_front();
+                doc->ready.acquire();
+                if (!doc->isEmpty) {
+                    writer.insertDoc(namespaceName, attributesString, doc->url, doc->title,
+                                     doc->contents);
+                }
+            };
 
-            QMultiMap<QString, QByteArray> files = htmlFiles;
-            files.unite(htmFiles);
-            files.unite(txtFiles);
+            QHelpDBReader::FileDataCursor files = reader.filesData(attributes,
+                    { QLatin1String("html"), QLatin1String("htm"), QLatin1String("txt") });
 
-            for (auto it = files.cbegin(), end = files.cend(); it != end ; ++it) {
+            while (files.next()) {
                 lock.relock();
                 if (m_cancel) {
                     // store what we have done so far
@@ -444,8 +678,8 @@ void QHelpSearchIndexWriter::run()
                 }
                 lock.unlock();
 
-                const QString &file = it.key();
-                const QByteArray &data = it.value();
+                const QString file = files.fileName();
+                QByteArray data = files.fileData();
 
                 if (data.isEmpty())
                     continue;
@@ -465,30 +699,20 @@ void QHelpSearchIndexWriter::run()
                     continue;
                 }
 
-                QTextStream s(data);
-                auto encoding = QStringDecoder::encodingForHtml(data);
-                if (encoding)
-                    s.setEncoding(*encoding);
-
-                const QString &text = s.readAll();
-                if (text.isEmpty())
-                    continue;
-
-                QString title;
-                QString contents;
-                if (fullFileName.endsWith(QLatin1String(".txt"))) {
-                    title = fullFileName.mid(fullFileName.lastIndexOf(QLatin1Char('/')) + 1);
-                    contents = text.toHtmlEscaped();
-                } else {
-                    QTextDocument doc;
-                    doc.setHtml(text);
-
-                    title = doc.metaInformation(QTextDocument::DocumentTitle).toHtmlEscaped();
-                    contents = doc.toPlainText().toHtmlEscaped();
-                }
-
-                writer.insertDoc(namespaceName, attributesString, fullFileName, title, contents);
+                if (qsizetype(pendingDocs.size()) >= maxPendingDocs)
+                    insertOldestDoc();
+
+                auto doc = std::make_shared<IndexedDoc>();
+                doc->url = fullFileName;
+                doc->data = std::move(data);
+                pendingDocs.push_back(doc);
+                pool.start([doc]() {
+                    extractText(doc.get());
+                    doc->ready.release();
+                });
             }
+            while (!pendingDocs.empty())
+                insertOldestDoc();
         }
         writer.flush();
         const QString &path = engine.documentationFileName(namespaceName);
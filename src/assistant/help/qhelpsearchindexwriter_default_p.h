@@ -60,6 +60,7 @@ private:
     QVariantList m_urls;
     QVariantList m_titles;
     QVariantList m_contents;
+    qsizetype m_pendingSize = 0;
 };
 
 
@@ -18,8 +18,13 @@
 #include <QtCore/QDateTime>
 #include <QtCore/QStringConverter>
 #include <QtCore/QDataStream>
+#include <QtCore/QSemaphore>
+#include <QtCore/QThreadPool>
 #include <QtSql/QSqlQuery>
 
+#include <deque>
+#include <memory>
+
 #include <stdio.h>
 
 QT_BEGIN_NAMESPACE
@@ -35,6 +40,7 @@ public:
         const QString &outputFileName);
     bool checkLinks(const QHelpProjectData &helpData);
     QString error() const;
+    void setCompressionLevel(int level) { m_compressionLevel = level; }
 
 Q_SIGNALS:
     void statusChanged(const QString &msg);
@@ -49,6 +55,19 @@ private:
         QString title;
     };
 
+    // A file that is read and compressed on the thread pool.
+    struct CompressedFile
+    {
+        QString fileName;
+        QString filePath;
+        bool isHtml = false;
+        QString head;
+        QByteArray data;
+        QString warning;
+        QSemaphore ready;
+    };
+
+    static void compressFile(CompressedFile *file, int compressionLevel);
     void writeTree(QDataStream &s, QHelpDataContentItem *item, int depth);
     bool createTables();
     bool insertFileNotFoundFile();
@@ -69,6 +88,7 @@ private:
 
     QString m_error;
     QSqlQuery *m_query = nullptr;
+    int m_compressionLevel = -1;
 
     int m_namespaceId = -1;
     int m_virtualFolderId = -1;
@@ -426,104 +446,129 @@ bool HelpGeneratorPrivate::insertFiles(const QStringList &files, const QString &
     if (m_query->next())
         tableFileId = m_query->value(0).toInt() + 1;
 
-    QString title;
-    QString charSet;
-    QList<QByteArray> fileDataList;
     QMap<int, QSet<int> > tmpFileFilterMap;
     QList<FileNameTableData> fileNameDataList;
 
+    m_query->exec(QLatin1String("BEGIN"));
+    QSqlQuery dataQuery(QSqlDatabase::database(QLatin1String("builder")));
+    dataQuery.prepare(QLatin1String("INSERT INTO FileDataTable VALUES (Null, ?)"));
+
+    // New files are read and compressed on the pool, and written
+    // by this thread in the order in which they are listed.
+    QThreadPool pool;
+    const qsizetype maxPendingFiles = 2 * qMax(1, pool.maxThreadCount());
+    std::deque<std::shared_ptr<CompressedFile>> pendingFiles;
+    QSet<QString> pendingFileNames;
+
     int i = 0;
+    const auto insertOldestFile = [&]() {
+        const std::shared_ptr<CompressedFile> file = pendingFiles.front();
+        pendingFiles.pop_front();
+        pendingFileNames.remove(file->fileName);
+        file->ready.acquire();
+        if (!file->warning.isEmpty()) {
+            emit warning(file->warning);
+            return;
+        }
+
+        dataQuery.bindValue(0, file->data);
+        dataQuery.exec();
+        if (++i % 20 == 0)
+            addProgress(m_fileStep * 20.0);
+
+        FileNameTableData fileNameData;
+        fileNameData.name = file->fileName;
+        fileNameData.fileId = tableFileId;
+        fileNameData.title = file->isHtml
+                ? QHelpGlobal::documentTitle(file->head)
+                : file->fileName.mid(file->fileName.lastIndexOf(QLatin1Char('/')) + 1);
+        fileNameDataList.append(fileNameData);
+
+        m_fileMap.insert(file->fileName, tableFileId);
+        m_fileFilterMap.insert(tableFileId, filterAtts);
+        tmpFileFilterMap.insert(tableFileId, filterAtts);
+
+        ++tableFileId;
+    };
+
     for (const QString &file : files) {
         const QString fileName = QDir::cleanPath(file);
+        const QString filePath = rootPath + QDir::separator() + fileName;
+
+        // A file that is listed again is handled once its first listing
+        // has been inserted, to merge its filters or to warn again
+        while (pendingFileNames.contains(fileName))
+            insertOldestFile();
+
+        const auto &it = m_fileMap.constFind(fileName);
+        if (it == m_fileMap.cend()) {
+            if (qsizetype(pendingFiles.size()) >= maxPendingFiles)
+                insertOldestFile();
+
+            auto compressedFile = std::make_shared<CompressedFile>();
+            compressedFile->fileName = fileName;
+            compressedFile->filePath = filePath;
+            pendingFiles.push_back(compressedFile);
+            pendingFileNames.insert(fileName);
+            const int compressionLevel = m_compressionLevel;
+            pool.start([compressedFile, compressionLevel]() {
+                compressFile(compressedFile.get(), compressionLevel);
+                compressedFile->ready.release();
+            });
+            continue;
+        }
 
-        QFile fi(rootPath + QDir::separator() + fileName);
+        QFile fi(filePath);
         if (!fi.exists()) {
             emit warning(tr("The file %1 does not exist, skipping it...")
-                .arg(QDir::cleanPath(rootPath + QDir::separator() + fileName)));
+                .arg(QDir::cleanPath(filePath)));
             continue;
         }
 
         if (!fi.open(QIODevice::ReadOnly)) {
             emit warning(tr("Cannot open file %1, skipping it...")
-                .arg(QDir::cleanPath(rootPath + QDir::separator() + fileName)));
+                .arg(QDir::cleanPath(filePath)));
             continue;
         }
 
-        QByteArray data = fi.readAll();
-        if (fileName.endsWith(QLatin1String(".html"))
-            || fileName.endsWith(QLatin1String(".htm"))) {
-            auto encoding = QStringDecoder::encodingForHtml(data);
-            if (!encoding)
-                encoding = QStringDecoder::Utf8;
-            title = QHelpGlobal::documentTitle(QStringDecoder(*encoding)(data));
-        } else {
-            title = fileName.mid(fileName.lastIndexOf(QLatin1Char('/')) + 1);
-        }
-
-        int fileId = -1;
-        const auto &it = m_fileMap.constFind(fileName);
-        if (it == m_fileMap.cend()) {
-            fileDataList.append(qCompress(data));
-
-            FileNameTableData fileNameData;
-            fileNameData.name = fileName;
-            fileNameData.fileId = tableFileId;
-            fileNameData.title = title;
-            fileNameDataList.append(fileNameData);
-
-            m_fileMap.insert(fileName, tableFileId);
-            m_fileFilterMap.insert(tableFileId, filterAtts);
-            tmpFileFilterMap.insert(tableFileId, filterAtts);
-
-            ++tableFileId;
-        } else {
-            fileId = it.value();
-            QSet<int> &fileFilterSet = m_fileFilterMap[fileId];
-            QSet<int> &tmpFileFilterSet = tmpFileFilterMap[fileId];
-            for (int filter : std::as_const(filterAtts)) {
-                if (!fileFilterSet.contains(filter)
-                    && !tmpFileFilterSet.contains(filter)) {
-                    fileFilterSet.insert(filter);
-                    tmpFileFilterSet.insert(filter);
-                }
+        const int fileId = it.value();
+        QSet<int> &fileFilterSet = m_fileFilterMap[fileId];
+        QSet<int> &tmpFileFilterSet = tmpFileFilterMap[fileId];
+        for (int filter : std::as_const(filterAtts)) {
+            if (!fileFilterSet.contains(filter)
+                && !tmpFileFilterSet.contains(filter)) {
+                fileFilterSet.insert(filter);
+                tmpFileFilterSet.insert(filter);
             }
         }
     }
+    while (!pendingFiles.empty())
+        insertOldestFile();
 
     if (!tmpFileFilterMap.isEmpty()) {
-        m_query->exec(QLatin1String("BEGIN"));
+        m_query->prepare(QLatin1String("INSERT INTO FileFilterTable VALUES(?, ?)"));
         for (auto it = tmpFileFilterMap.cbegin(), end = tmpFileFilterMap.cend(); it != end; ++it) {
             QList<int> filterValues = it.value().values();
             std::sort(filterValues.begin(), filterValues.end());
             for (int fv : std::as_const(filterValues)) {
-                m_query->prepare(QLatin1String("INSERT INTO FileFilterTable "
-                    "VALUES(?, ?)"));
                 m_query->bindValue(0, fv);
                 m_query->bindValue(1, it.key());
                 m_query->exec();
             }
         }
 
-        for (const QByteArray &fileData : std::as_const(fileDataList)) {
-            m_query->prepare(QLatin1String("INSERT INTO FileDataTable VALUES "
-                "(Null, ?)"));
-            m_query->bindValue(0, fileData);
-            m_query->exec();
-            if (++i % 20 == 0)
-                addProgress(m_fileStep * 20.0);
-        }
-
+        m_query->prepare(QLatin1String("INSERT INTO FileNameTable "
+            "(FolderId, Name, FileId, Title) VALUES (?, ?, ?, ?)"));
         for (const FileNameTableData &fnd : std::as_const(fileNameDataList)) {
-            m_query->prepare(QLatin1String("INSERT INTO FileNameTable "
-                "(FolderId, Name, FileId, Title) VALUES (?, ?, ?, ?)"));
             m_query->bindValue(0, 1);
             m_query->bindValue(1, fnd.name);
             m_query->bindValue(2, fnd.fileId);
             m_query->bindValue(3, fnd.title);
             m_query->exec();
         }
-        m_query->exec(QLatin1String("COMMIT"));
     }
+    dataQuery.clear();
+    m_query->exec(QLatin1String("COMMIT"));
 
     m_query->exec(QLatin1String("SELECT MAX(Id) FROM FileDataTable"));
     if (m_query->next()
@@ -534,6 +579,37 @@ bool HelpGeneratorPrivate::insertFiles(const QStringList &files, const QString &
     return false;
 }
 
+void HelpGeneratorPrivate::compressFile(CompressedFile *file, int compressionLevel)
+{
+    QFile fi(file->filePath);
+    if (!fi.exists()) {
+        file->warning = tr("The file %1 does not exist, skipping it...")
+                .arg(QDir::cleanPath(file->filePath));
+        return;
+    }
+
+    if (!fi.open(QIODevice::ReadOnly)) {
+        file->warning = tr("Cannot open file %1, skipping it...")
+                .arg(QDir::cleanPath(file->filePath));
+        return;
+    }
+
+    const QByteArray data = fi.readAll();
+    if (file->fileName.endsWith(QLatin1String(".html"))
+        || file->fileName.endsWith(QLatin1String(".htm"))) {
+        auto encoding = QStringDecoder::encodingForHtml(data);
+        if (!encoding)
+            encoding = QStringDecoder::Utf8;
+        // Only the part up to the end of the title is needed to find it
+        const QString content = QStringDecoder(*encoding)(data);
+        const qsizetype titleEnd = content.indexOf(QLatin1String("</title>"), 0,
+                                                   Qt::CaseInsensitive);
+        file->isHtml = true;
+        file->head = titleEnd < 0 ? content : content.left(titleEnd + 8);
+    }
+    file->data = qCompress(data, compressionLevel);
+}
+
 bool HelpGeneratorPrivate::registerCustomFilter(const QString &filterName,
     const QStringList &filterAttribs, bool forceUpdate)
 {
@@ -738,6 +814,15 @@ bool HelpGeneratorPrivate::insertMetaData(const QMap<QString, QVariant> &metaDat
         m_query->bindValue(1, it.value());
         m_query->exec();
     }
+
+    // The data of all files is compressed with qCompress() at this
+    // level. Readers do not depend on it, qUncompress() handles any.
+    if (m_compressionLevel != -1) {
+        m_query->prepare(QLatin1String("INSERT INTO MetaDataTable VALUES(?, ?)"));
+        m_query->bindValue(0, QLatin1String("compressionLevel"));
+        m_query->bindValue(1, m_compressionLevel);
+        m_query->exec();
+    }
     return true;
 }
 
@@ -826,6 +911,16 @@ bool HelpGenerator::generate(QHelpProjectData *helpData,
     return m_private->generate(helpData, outputFileName);
 }
 
+/*!
+    Sets the zlib compression level used for the files of the
+    generated documentation sets to \a level, from 0 to 9, or -1
+    for the default level.
+*/
+void HelpGenerator::setCompressionLevel(int level)
+{
+    m_private->setCompressionLevel(level);
+}
+
 bool HelpGenerator::checkLinks(const QHelpProjectData &helpData)
 {
     return m_private->checkLinks(helpData);
@@ -19,6 +19,7 @@ public:
     HelpGenerator(bool silent = false);
     bool generate(QHelpProjectData *helpData,
         const QString &outputFileName);
+    void setCompressionLevel(int level);
     bool checkLinks(const QHelpProjectData &helpData);
     QString error() const;
 
@@ -38,7 +38,8 @@ namespace {
     }
 }
 
-int generateCollectionFile(const QByteArray &data, const QString &basePath, const QString outputFile)
+int generateCollectionFile(const QByteArray &data, const QString &basePath, const QString outputFile,
+                           int compressionLevel)
 {
     fputs(qPrintable(QHG::tr("Reading collection config file...\n")), stdout);
     CollectionConfigReader config;
@@ -59,6 +60,7 @@ int generateCollectionFile(const QByteArray &data, const QString &basePath, cons
         }
 
         HelpGenerator helpGenerator;
+        helpGenerator.setCompressionLevel(compressionLevel);
         if (!helpGenerator.generate(&helpData, absoluteFilePath(basePath, it.value()))) {
             fprintf(stderr, "%s\n", qPrintable(helpGenerator.error()));
             return 1;
@@ -231,6 +233,7 @@ int main(int argc, char *argv[])
     bool showVersion = false;
     bool checkLinks = false;
     bool silent = false;
+    int compressionLevel = -1;
 
     // don't require a window manager even though we're a QGuiApplication
     qputenv("QT_QPA_PLATFORM", QByteArrayLiteral("minimal"));
@@ -268,6 +271,12 @@ int main(int argc, char *argv[])
             checkLinks = true;
         } else if (arg == QLatin1String("-s")) {
             silent = true;
+        } else if (arg == QLatin1String("-z")) {
+            bool ok = false;
+            if (++i < argc)
+                compressionLevel = QString::fromLocal8Bit(argv[i]).toInt(&ok);
+            if (!ok || compressionLevel < 0 || compressionLevel > 9)
+                error = QHG::tr("Missing or invalid compression level.");
         } else {
             const QFileInfo fi(arg);
             inputFile = fi.absoluteFilePath();
@@ -318,6 +327,9 @@ int main(int argc, char *argv[])
         "  -c                     Checks whether all links in HTML files\n"
         "                         point to files in this help project.\n"
         "  -s                     Suppresses status messages.\n"
+        "  -z <level>             Compresses the files of the documentation\n"
+        "                         with the given level, from 0 (fastest)\n"
+        "                         to 9 (smallest).\n"
         "  -v                     Displays the version of \n"
         "                         qhelpgenerator.\n\n");
 
@@ -365,6 +377,7 @@ int main(int argc, char *argv[])
         }
 
         HelpGenerator generator(silent);
+        generator.setCompressionLevel(compressionLevel);
         bool success = true;
         if (checkLinks)
             success = generator.checkLinks(*helpData);
@@ -377,7 +390,7 @@ int main(int argc, char *argv[])
         }
     } else {
         const QByteArray data = file.readAll();
-        return generateCollectionFile(data, basePath, outputFile);
+        return generateCollectionFile(data, basePath, outputFile, compressionLevel);
 
     }
 
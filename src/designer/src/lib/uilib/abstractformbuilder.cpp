@@ -871,7 +871,7 @@ void QAbstractFormBuilder::applyProperties(QObject *o, const QList<DomProperty*>
             if (attributeName == "numDigits"_L1 && o->inherits("QLCDNumber")) // Deprecated in Qt 4, removed in Qt 5.
                 attributeName = u"digitCount"_s;
             if (!d->applyPropertyInternally(o, attributeName, v))
-                o->setProperty(attributeName.toUtf8(), v);
+                d->setObjectProperty(o, attributeName, v);
         }
     }
 }
@@ -894,6 +894,9 @@ bool QAbstractFormBuilder::applyPropertyInternally(QObject *o, const QString &pr
 
 QVariant QAbstractFormBuilder::toVariant(const QMetaObject *meta, DomProperty *p)
 {
+    // Resources depend on the working directory, so they are not cached
+    if (d->m_propertyCache && !d->resourceBuilder()->isResourceProperty(p))
+        return d->m_propertyCache->value(this, meta, p);
     return domPropertyToVariant(this, meta, p);
 }
 
@@ -14,6 +14,7 @@
 
 #include <QtCore/qvariant.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qmetaobject.h>
 #include <QtCore/qtextstream.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qcoreapplication.h>
@@ -159,6 +160,23 @@ bool QFormBuilderExtra::applyPropertyInternally(QObject *o, const QString &prope
     return true;
 }
 
+// Sets a property like QObject::setProperty(), but looks its index up in
+// the property cache while a template is instantiated.
+void QFormBuilderExtra::setObjectProperty(QObject *o, const QString &propertyName,
+                                          const QVariant &value) const
+{
+    if (m_propertyCache) {
+        const QMetaObject *meta = o->metaObject();
+        const int index = m_propertyCache->propertyIndex(meta, propertyName);
+        if (index >= 0) {
+            meta->property(index).write(o, value);
+            return;
+        }
+    }
+    // Also adds dynamic properties
+    o->setProperty(propertyName.toUtf8(), value);
+}
+
 void QFormBuilderExtra::applyInternalProperties() const
 {
     for (auto it = m_buddies.cbegin(), cend = m_buddies.cend(); it != cend; ++it )
@@ -758,6 +776,25 @@ QFormBuilderStrings::QFormBuilderStrings() :
         treeItemTextRoleHash.insert(it->second, it->first);
 }
 
+QVariant QFormBuilderPropertyCache::value(QAbstractFormBuilder *afb, const QMetaObject *meta,
+                                          const DomProperty *p)
+{
+    const auto key = qMakePair(meta, p);
+    auto it = m_values.constFind(key);
+    if (it == m_values.cend())
+        it = m_values.insert(key, domPropertyToVariant(afb, meta, p));
+    return it.value();
+}
+
+int QFormBuilderPropertyCache::propertyIndex(const QMetaObject *meta, const QString &name)
+{
+    const auto key = qMakePair(meta, name);
+    auto it = m_propertyIndexes.constFind(key);
+    if (it == m_propertyIndexes.cend())
+        it = m_propertyIndexes.insert(key, meta->indexOfProperty(name.toUtf8().constData()));
+    return it.value();
+}
+
 const QFormBuilderStrings &QFormBuilderStrings::instance()
 {
     static const QFormBuilderStrings rc;
@@ -18,9 +18,11 @@
 #include "uilib_global.h"
 
 #include <QtCore/qhash.h>
+#include <QtCore/qpair.h>
 #include <QtCore/qpointer.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qmap.h>
+#include <QtCore/qvariant.h>
 #include <QtCore/qdir.h>
 #include <QtGui/qpalette.h>
 
@@ -37,6 +39,7 @@ class QBoxLayout;
 class QGridLayout;
 class QAction;
 class QActionGroup;
+class QMetaObject;
 
 #ifdef QFORMINTERNAL_NAMESPACE
 namespace QFormInternal
@@ -56,6 +59,20 @@ class QAbstractFormBuilder;
 class QResourceBuilder;
 class QTextBuilder;
 
+// Caches the values converted from the properties of a DomUI that is
+// instantiated repeatedly, and the indexes of the properties in each class,
+// saving the property lookups by name. The DomUI must outlive the cache.
+class QDESIGNER_UILIB_EXPORT QFormBuilderPropertyCache
+{
+public:
+    QVariant value(QAbstractFormBuilder *afb, const QMetaObject *meta, const DomProperty *p);
+    int propertyIndex(const QMetaObject *meta, const QString &name);
+
+private:
+    QHash<QPair<const QMetaObject *, const DomProperty *>, QVariant> m_values;
+    QHash<QPair<const QMetaObject *, QString>, int> m_propertyIndexes;
+};
+
 class QDESIGNER_UILIB_EXPORT QFormBuilderExtra
 {
 public:
@@ -80,6 +97,7 @@ public:
     static QString msgInvalidUiFile();
 
     bool applyPropertyInternally(QObject *o, const QString &propertyName, const QVariant &value);
+    void setObjectProperty(QObject *o, const QString &propertyName, const QVariant &value) const;
 
     enum BuddyMode { BuddyApplyAll, BuddyApplyVisibleOnly };
 
@@ -156,6 +174,7 @@ public:
     QDir m_workingDirectory;
     QString m_errorString;
     QString m_language;
+    QFormBuilderPropertyCache *m_propertyCache = nullptr;
 
 private:
     void clearResourceBuilder();
@@ -0,0 +1,43 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef DISTANCEFIELDFONTWRITER_H
+#define DISTANCEFIELDFONTWRITER_H
+
+#include <QCoreApplication>
+#include <QList>
+#include <QString>
+#include <QtGui/private/qtextengine_p.h>
+
+QT_BEGIN_NAMESPACE
+
+class DistanceFieldModel;
+
+// Writes a copy of a font file with an additional 'qtdf' table, which
+// holds the distance fields of the selected glyphs of the model
+class DistanceFieldFontWriter
+{
+    Q_DECLARE_TR_FUNCTIONS(DistanceFieldFontWriter)
+public:
+    explicit DistanceFieldFontWriter(const DistanceFieldModel *model);
+
+    void setMaximumTextureSize(quint32 maximumTextureSize) { m_maximumTextureSize = maximumTextureSize; }
+
+    bool write(const QString &fontFile, const QString &fileName, const QList<glyph_t> &glyphIndexes);
+
+    QString errorTitle() const { return m_errorTitle; }
+    QString errorString() const { return m_errorString; }
+
+private:
+    QByteArray createSfntTable(const QList<glyph_t> &glyphIndexes);
+    void setError(const QString &errorTitle, const QString &errorString);
+
+    const DistanceFieldModel *m_model;
+    quint32 m_maximumTextureSize;
+    QString m_errorTitle;
+    QString m_errorString;
+};
+
+QT_END_NAMESPACE
+
+#endif // DISTANCEFIELDFONTWRITER_H
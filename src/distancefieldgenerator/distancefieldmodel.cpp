@@ -12,12 +12,16 @@ QT_BEGIN_NAMESPACE
 DistanceFieldModel::DistanceFieldModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_glyphCount(0)
+    , m_generation(0)
 {
     int index = metaObject()->indexOfEnumerator("UnicodeRange");
     Q_ASSERT(index >= 0);
 
     m_rangeEnum = metaObject()->enumerator(index);
 
+    qRegisterMetaType<glyph_t>("glyph_t");
+    qRegisterMetaType<QPainterPath>("QPainterPath");
+
     m_workerThread.reset(new QThread);
 
     m_worker = new DistanceFieldModelWorker;
@@ -25,16 +29,12 @@ DistanceFieldModel::DistanceFieldModel(QObject *parent)
     connect(m_workerThread.data(), &QThread::finished,
             m_worker, &QObject::deleteLater);
 
-    connect(m_worker, &DistanceFieldModelWorker::fontLoaded,
-            this, &DistanceFieldModel::startGeneration);
     connect(m_worker, &DistanceFieldModelWorker::fontLoaded,
             this, &DistanceFieldModel::reserveSpace);
     connect(m_worker, &DistanceFieldModelWorker::distanceFieldGenerated,
             this, &DistanceFieldModel::addDistanceField);
     connect(m_worker, &DistanceFieldModelWorker::fontGenerated,
-            this, &DistanceFieldModel::stopGeneration);
-    connect(m_worker, &DistanceFieldModelWorker::distanceFieldGenerated,
-            this, &DistanceFieldModel::distanceFieldGenerated);
+            this, &DistanceFieldModel::finishGeneration);
     connect(m_worker, &DistanceFieldModelWorker::error,
             this, &DistanceFieldModel::error);
 
@@ -43,6 +43,7 @@ DistanceFieldModel::DistanceFieldModel(QObject *parent)
 
 DistanceFieldModel::~DistanceFieldModel()
 {
+    m_worker->cancelGeneration();
     m_workerThread->quit();
     m_workerThread->wait();
 }
@@ -75,8 +76,9 @@ QVariant DistanceFieldModel::data(const QModelIndex &index, int role) const
         return QVariant();
 
     if (role == Qt::DecorationRole) {
-        if (index.row() < m_distanceFields.size()) {
-            return QPixmap::fromImage(m_distanceFields.at(index.row()).scaled(64, 64));
+        const QImage &distanceField = m_distanceFields.at(index.row());
+        if (!distanceField.isNull()) {
+            return QPixmap::fromImage(distanceField.scaled(64, 64));
         } else {
             return defaultImage;
         }
@@ -88,28 +90,39 @@ QVariant DistanceFieldModel::data(const QModelIndex &index, int role) const
 
 void DistanceFieldModel::setFont(const QString &fileName)
 {
+    m_worker->cancelGeneration();
+    const quint32 generation = ++m_generation;
     QMetaObject::invokeMethod(m_worker,
-                              [this, fileName] { m_worker->loadFont(fileName); },
+                              [this, fileName, generation] {
+                                  m_worker->loadFont(fileName, generation);
+                              },
                               Qt::QueuedConnection);
 }
 
-void DistanceFieldModel::reserveSpace(quint16 glyphCount,
+void DistanceFieldModel::reserveSpace(quint32 generation,
+                                      quint16 glyphCount,
                                       bool doubleResolution,
                                       qreal pixelSize)
 {
+    if (generation != m_generation)
+        return;
+
     beginResetModel();
     m_glyphsPerUnicodeRange.clear();
+    m_glyphsPerUcs4.clear();
     m_distanceFields.clear();
+    m_paths.clear();
     m_glyphCount = glyphCount;
-    if (glyphCount > 0)
-        m_distanceFields.reserve(glyphCount);
+    m_distanceFields.resize(glyphCount);
+    m_paths.resize(glyphCount);
     endResetModel();
 
     m_doubleGlyphResolution = doubleResolution;
     m_pixelSize = pixelSize;
 
+    emit startGeneration(glyphCount);
     QMetaObject::invokeMethod(m_worker,
-                              [this] { m_worker->generateOneDistanceField(); },
+                              [this] { m_worker->generateDistanceFields(); },
                               Qt::QueuedConnection);
 }
 
@@ -144,16 +157,17 @@ QString DistanceFieldModel::nameForUnicodeRange(UnicodeRange range) const
     return QString::fromLatin1(m_rangeEnum.valueToKey(int(range)));
 }
 
-void DistanceFieldModel::addDistanceField(const QImage &distanceField,
+void DistanceFieldModel::addDistanceField(quint32 generation,
+                                          const QImage &distanceField,
                                           const QPainterPath &path,
                                           glyph_t glyphId,
                                           quint32 ucs4)
 {
-    if (glyphId >= quint16(m_distanceFields.size()))
-        m_distanceFields.resize(glyphId + 1);
+    m_worker->releaseDistanceField();
+    if (generation != m_generation || glyphId >= m_glyphCount)
+        return;
+
     m_distanceFields[glyphId] = distanceField;
-    if (glyphId >= quint16(m_paths.size()))
-        m_paths.resize(glyphId + 1);
     m_paths[glyphId] = path;
 
     if (ucs4 != 0) {
@@ -163,10 +177,13 @@ void DistanceFieldModel::addDistanceField(const QImage &distanceField,
     }
 
     emit dataChanged(createIndex(glyphId, 0), createIndex(glyphId, 0));
+    emit distanceFieldGenerated();
+}
 
-    QMetaObject::invokeMethod(m_worker,
-                             [this] { m_worker->generateOneDistanceField(); },
-                             Qt::QueuedConnection);
+void DistanceFieldModel::finishGeneration(quint32 generation)
+{
+    if (generation == m_generation)
+        emit stopGeneration();
 }
 
 glyph_t DistanceFieldModel::glyphIndexForUcs4(quint32 ucs4) const
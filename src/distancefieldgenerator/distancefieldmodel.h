@@ -184,13 +184,16 @@ signals:
     void error(const QString &errorString);
 
 private slots:
-    void addDistanceField(const QImage &distanceField,
+    void addDistanceField(quint32 generation,
+                          const QImage &distanceField,
                           const QPainterPath &path,
                           glyph_t glyphId,
                           quint32 ucs4);
-    void reserveSpace(quint16 glyphCount,
+    void reserveSpace(quint32 generation,
+                      quint16 glyphCount,
                       bool doubleResolution,
                       qreal pixelSize);
+    void finishGeneration(quint32 generation);
 
 private:
     UnicodeRange unicodeRangeForUcs4(quint32 ucs4) const;
@@ -199,6 +202,8 @@ private:
     DistanceFieldModelWorker *m_worker;
     QScopedPointer<QThread> m_workerThread;
     quint16 m_glyphCount;
+    // Incremented for every font, so that results for an earlier one are ignored
+    quint32 m_generation;
     QList<QImage> m_distanceFields;
     QList<QPainterPath> m_paths;
     QMultiHash<UnicodeRange, glyph_t> m_glyphsPerUnicodeRange;
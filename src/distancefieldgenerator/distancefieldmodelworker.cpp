@@ -5,6 +5,8 @@
 
 #include "distancefieldmodel.h"
 #include <qendian.h>
+#include <QFile>
+#include <QThreadPool>
 #include <QtGui/private/qdistancefield_p.h>
 
 QT_BEGIN_NAMESPACE
@@ -80,11 +82,16 @@ struct SequentialMapGroup
 
 #   pragma pack()
 
+// The number of generated glyphs that may wait for the receiver at a time
+static const int maxGlyphsInFlight = 256;
+
 DistanceFieldModelWorker::DistanceFieldModelWorker(QObject *parent)
     : QObject(parent)
     , m_glyphCount(0)
-    , m_nextGlyphId(0)
     , m_doubleGlyphResolution(false)
+    , m_generation(0)
+    , m_canceled(false)
+    , m_freeSlots(maxGlyphsInFlight)
 {
 }
 
@@ -275,7 +282,6 @@ void DistanceFieldModelWorker::readCmap()
 
 void DistanceFieldModelWorker::readGlyphCount()
 {
-    m_nextGlyphId = 0;
     m_glyphCount = 0;
     if (m_font.isValid()) {
         QByteArray maxp = m_font.fontTable("maxp");
@@ -288,9 +294,16 @@ void DistanceFieldModelWorker::readGlyphCount()
     m_doubleGlyphResolution = qt_fontHasNarrowOutlines(m_font) && m_glyphCount < QT_DISTANCEFIELD_HIGHGLYPHCOUNT();
 }
 
-void DistanceFieldModelWorker::loadFont(const QString &fileName)
+void DistanceFieldModelWorker::loadFont(const QString &fileName, quint32 generation)
 {
-    m_font = QRawFont(fileName, 64);
+    m_generation = generation;
+    m_canceled = false;
+    m_cmapping.clear();
+
+    // The font data is kept, so that each generating thread can have its own QRawFont
+    QFile file(fileName);
+    m_fontData = file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    m_font = QRawFont(m_fontData, 64);
     if (!m_font.isValid())
         emit error(tr("File '%1' is not a valid font file.").arg(fileName));
 
@@ -300,28 +313,47 @@ void DistanceFieldModelWorker::loadFont(const QString &fileName)
     qreal pixelSize = QT_DISTANCEFIELD_BASEFONTSIZE(m_doubleGlyphResolution) * QT_DISTANCEFIELD_SCALE(m_doubleGlyphResolution);
     m_font.setPixelSize(pixelSize);
 
-    emit fontLoaded(m_glyphCount,
+    emit fontLoaded(m_generation,
+                    m_glyphCount,
                     m_doubleGlyphResolution,
                     pixelSize);
 }
 
-void DistanceFieldModelWorker::generateOneDistanceField()
+void DistanceFieldModelWorker::generateDistanceFields()
 {
-    Q_ASSERT(m_nextGlyphId <= m_glyphCount);
-
-    if (m_nextGlyphId == m_glyphCount) {
-        emit fontGenerated();
-        return;
+    // The glyphs are split into ranges that are generated in parallel. A
+    // QRawFont must not be used by several threads at once, so each range
+    // creates its own from the font data. A thread waits for a free slot
+    // before it passes a glyph on, so that the generated images do not pile
+    // up in the receiver's event queue.
+    const quint32 glyphsPerRange = 256;
+    const qreal pixelSize = m_font.pixelSize();
+    const quint32 generation = m_generation;
+
+    QThreadPool threadPool;
+    for (quint32 firstGlyphId = 0; firstGlyphId < m_glyphCount; firstGlyphId += glyphsPerRange) {
+        const quint32 endGlyphId = qMin(firstGlyphId + glyphsPerRange, quint32(m_glyphCount));
+        threadPool.start([this, firstGlyphId, endGlyphId, pixelSize, generation] {
+            QRawFont font(m_fontData, pixelSize);
+            for (glyph_t glyphId = firstGlyphId; glyphId < endGlyphId && !m_canceled; ++glyphId) {
+                QPainterPath path = font.pathForGlyph(glyphId);
+                QDistanceField distanceField(path, glyphId, m_doubleGlyphResolution);
+                while (!m_freeSlots.tryAcquire(1, 100)) {
+                    if (m_canceled)
+                        return;
+                }
+                emit distanceFieldGenerated(generation,
+                                            distanceField.toImage(QImage::Format_Alpha8),
+                                            path,
+                                            glyphId,
+                                            m_cmapping.value(glyphId));
+            }
+        });
     }
+    threadPool.waitForDone();
 
-    QPainterPath path = m_font.pathForGlyph(m_nextGlyphId);
-    QDistanceField distanceField(path, m_nextGlyphId, m_doubleGlyphResolution);
-    emit distanceFieldGenerated(distanceField.toImage(QImage::Format_Alpha8),
-                                path,
-                                m_nextGlyphId,
-                                m_cmapping.value(m_nextGlyphId));
-
-    m_nextGlyphId++;
+    if (!m_canceled)
+        emit fontGenerated(generation);
 }
 
 QT_END_NAMESPACE
@@ -6,8 +6,11 @@
 
 #include <QObject>
 #include <QRawFont>
+#include <QSemaphore>
 #include <QtGui/private/qtextengine_p.h>
 
+#include <atomic>
+
 QT_BEGIN_NAMESPACE
 
 struct CmapSubtable0;
@@ -21,8 +24,11 @@ class DistanceFieldModelWorker : public QObject
 public:
     explicit DistanceFieldModelWorker(QObject *parent = nullptr);
 
-    Q_INVOKABLE void generateOneDistanceField();
-    Q_INVOKABLE void loadFont(const QString &fileName);
+    Q_INVOKABLE void generateDistanceFields();
+    Q_INVOKABLE void loadFont(const QString &fileName, quint32 generation);
+    void cancelGeneration() { m_canceled = true; }
+    // Called by the receiver of distanceFieldGenerated() for every glyph it has handled
+    void releaseDistanceField() { m_freeSlots.release(); }
 
     void readCmapSubtable(const CmapSubtable0 *subtable, const void *end);
     void readCmapSubtable(const CmapSubtable4 *subtable, const void *end);
@@ -31,9 +37,11 @@ public:
     void readCmapSubtable(const CmapSubtable12 *subtable, const void *end);
 
 signals:
-    void fontLoaded(quint16 glyphCount, bool doubleResolution, qreal pixelSize);
-    void fontGenerated();
-    void distanceFieldGenerated(const QImage &distanceField,
+    void fontLoaded(quint32 generation, quint16 glyphCount, bool doubleResolution,
+                    qreal pixelSize);
+    void fontGenerated(quint32 generation);
+    void distanceFieldGenerated(quint32 generation,
+                                const QImage &distanceField,
                                 const QPainterPath &path,
                                 glyph_t glyphId,
                                 quint32 cmapAssignment);
@@ -44,10 +52,13 @@ private:
     void readCmap();
 
     QRawFont m_font;
+    QByteArray m_fontData;
     quint16 m_glyphCount;
-    quint16 m_nextGlyphId;
     bool m_doubleGlyphResolution;
     QHash<glyph_t, quint32> m_cmapping;
+    quint32 m_generation;
+    std::atomic<bool> m_canceled;
+    QSemaphore m_freeSlots;
 };
 
 QT_END_NAMESPACE
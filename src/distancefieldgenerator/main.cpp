@@ -2,18 +2,182 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include "mainwindow.h"
+#include "distancefieldfontwriter.h"
+#include "distancefieldmodel.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
+#include <QEventLoop>
+
+#include <algorithm>
+#include <cstring>
 
 QT_USE_NAMESPACE
 
+// The platform has to be chosen before the application is created, so the
+// output option is looked for before the command line is parsed properly
+static bool isBatchMode(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        if (!std::strcmp(arg, "-o") || !std::strcmp(arg, "--output")
+                || !std::strncmp(arg, "--output=", 9)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Parses a comma-separated list of numbers and ranges like "0-99,120"
+static bool parseRanges(const QString &list, int base, const QString &prefix,
+                        QList<QPair<quint32, quint32>> *ranges)
+{
+    for (const QString &item : list.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        const QStringList bounds = item.trimmed().split(QLatin1Char('-'));
+        if (bounds.size() > 2)
+            return false;
+
+        quint32 values[2];
+        for (int i = 0; i < bounds.size(); ++i) {
+            QString bound = bounds.at(i).trimmed();
+            if (!prefix.isEmpty() && bound.startsWith(prefix, Qt::CaseInsensitive))
+                bound = bound.mid(prefix.size());
+            bool ok;
+            values[i] = bound.toUInt(&ok, base);
+            if (!ok)
+                return false;
+        }
+        if (bounds.size() == 1)
+            values[1] = values[0];
+        if (values[1] < values[0])
+            return false;
+        ranges->append(qMakePair(values[0], values[1]));
+    }
+    return true;
+}
+
+static int generateFontFile(const QCommandLineParser &parser,
+                            const QCommandLineOption &outputOption,
+                            const QCommandLineOption &glyphsOption,
+                            const QCommandLineOption &unicodeRangesOption,
+                            const QCommandLineOption &charactersOption,
+                            const QCommandLineOption &textureSizeOption)
+{
+    if (parser.positionalArguments().isEmpty()) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate(
+                "main", "No font file given.")));
+        return 1;
+    }
+
+    bool ok;
+    const quint32 textureSize = parser.value(textureSizeOption).toUInt(&ok);
+    if (!ok || textureSize == 0) {
+        fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate(
+                "main", "Invalid texture size '%1'.").arg(parser.value(textureSizeOption))));
+        return 1;
+    }
+
+    const QString fontFile = parser.positionalArguments().constFirst();
+    bool failed = false;
+
+    DistanceFieldModel model;
+    QEventLoop loop;
+    QObject::connect(&model, &DistanceFieldModel::error, [&failed](const QString &errorString) {
+        fprintf(stderr, "%s\n", qPrintable(errorString));
+        failed = true;
+    });
+    QObject::connect(&model, &DistanceFieldModel::stopGeneration, &loop, &QEventLoop::quit);
+    model.setFont(fontFile);
+    loop.exec();
+
+    if (failed)
+        return 1;
+
+    QList<glyph_t> glyphIndexes;
+    if (parser.isSet(glyphsOption)) {
+        QList<QPair<quint32, quint32>> ranges;
+        if (!parseRanges(parser.value(glyphsOption), 10, QString(), &ranges)) {
+            fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate(
+                    "main", "Invalid glyph list '%1'.").arg(parser.value(glyphsOption))));
+            return 1;
+        }
+        for (const auto &range : std::as_const(ranges)) {
+            for (quint32 glyphIndex = range.first;
+                 glyphIndex <= range.second && glyphIndex < quint32(model.rowCount());
+                 ++glyphIndex) {
+                glyphIndexes.append(glyphIndex);
+            }
+        }
+    }
+
+    if (parser.isSet(unicodeRangesOption)) {
+        const QList<DistanceFieldModel::UnicodeRange> unicodeRanges = model.unicodeRanges();
+        for (const QString &name : parser.value(unicodeRangesOption).split(QLatin1Char(','),
+                                                                           Qt::SkipEmptyParts)) {
+            const auto it = std::find_if(unicodeRanges.cbegin(), unicodeRanges.cend(),
+                                         [&model, &name](DistanceFieldModel::UnicodeRange range) {
+                return model.nameForUnicodeRange(range).compare(name.trimmed(),
+                                                                Qt::CaseInsensitive) == 0;
+            });
+            if (it == unicodeRanges.cend()) {
+                fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate(
+                        "main", "The font has no glyphs in the Unicode range '%1'.")
+                        .arg(name.trimmed())));
+                return 1;
+            }
+            glyphIndexes.append(model.glyphIndexesForUnicodeRange(*it));
+        }
+    }
+
+    if (parser.isSet(charactersOption)) {
+        QList<QPair<quint32, quint32>> ranges;
+        if (!parseRanges(parser.value(charactersOption), 16, QStringLiteral("U+"), &ranges)) {
+            fprintf(stderr, "%s\n", qPrintable(QCoreApplication::translate(
+                    "main", "Invalid character list '%1'.").arg(parser.value(charactersOption))));
+            return 1;
+        }
+        for (const auto &range : std::as_const(ranges)) {
+            for (quint32 ucs4 = range.first; ucs4 <= range.second; ++ucs4) {
+                const glyph_t glyphIndex = model.glyphIndexForUcs4(ucs4);
+                if (glyphIndex != 0)
+                    glyphIndexes.append(glyphIndex);
+                if (ucs4 == range.second)
+                    break;
+            }
+        }
+    }
+
+    if (!parser.isSet(glyphsOption) && !parser.isSet(unicodeRangesOption)
+            && !parser.isSet(charactersOption)) {
+        for (int glyphIndex = 0; glyphIndex < model.rowCount(); ++glyphIndex)
+            glyphIndexes.append(glyphIndex);
+    }
+
+    std::sort(glyphIndexes.begin(), glyphIndexes.end());
+    glyphIndexes.erase(std::unique(glyphIndexes.begin(), glyphIndexes.end()), glyphIndexes.end());
+
+    DistanceFieldFontWriter writer(&model);
+    writer.setMaximumTextureSize(textureSize);
+    if (!writer.write(fontFile, parser.value(outputOption), glyphIndexes)) {
+        fprintf(stderr, "%s\n", qPrintable(writer.errorString()));
+        return 1;
+    }
+
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
-    QApplication app(argc, argv);
-    app.setOrganizationName(QStringLiteral("QtProject"));
-    app.setApplicationName(QStringLiteral("Qt Distance Field Generator"));
-    app.setApplicationVersion(QStringLiteral(QT_VERSION_STR));
+    // Files can be generated without a display, for instance on build machines
+    const bool batchMode = isBatchMode(argc, argv);
+    if (batchMode && !qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QScopedPointer<QGuiApplication> app(batchMode ? new QGuiApplication(argc, argv)
+                                                  : new QApplication(argc, argv));
+    app->setOrganizationName(QStringLiteral("QtProject"));
+    app->setApplicationName(QStringLiteral("Qt Distance Field Generator"));
+    app->setApplicationVersion(QStringLiteral(QT_VERSION_STR));
 
     QCommandLineParser parser;
     parser.setApplicationDescription(
@@ -24,12 +188,53 @@ int main(int argc, char **argv)
     parser.addPositionalArgument(QLatin1String("file"),
                                  QCoreApplication::translate("main",
                                                              "Font file (*.ttf, *.otf)"));
-    parser.process(app);
+
+    QCommandLineOption outputOption(QStringList() << QStringLiteral("o") << QStringLiteral("output"),
+                                    QCoreApplication::translate("main",
+                                                                "Save the font with the distance fields to <file> "
+                                                                "without showing the user interface."),
+                                    QCoreApplication::translate("main", "file"));
+    parser.addOption(outputOption);
+
+    QCommandLineOption glyphsOption(QStringLiteral("glyphs"),
+                                    QCoreApplication::translate("main",
+                                                                "Glyph indexes to save, for instance 0-99,120."),
+                                    QCoreApplication::translate("main", "indexes"));
+    parser.addOption(glyphsOption);
+
+    QCommandLineOption unicodeRangesOption(QStringLiteral("unicode-ranges"),
+                                           QCoreApplication::translate("main",
+                                                                       "Comma-separated names of Unicode ranges to save, "
+                                                                       "as listed in the user interface."),
+                                           QCoreApplication::translate("main", "names"));
+    parser.addOption(unicodeRangesOption);
+
+    QCommandLineOption charactersOption(QStringLiteral("characters"),
+                                        QCoreApplication::translate("main",
+                                                                    "Code points of the characters to save, "
+                                                                    "for instance U+0020-U+007E,U+00E9."),
+                                        QCoreApplication::translate("main", "code points"));
+    parser.addOption(charactersOption);
+
+    QCommandLineOption textureSizeOption(QStringLiteral("texture-size"),
+                                         QCoreApplication::translate("main",
+                                                                     "Maximum size of the textures holding the "
+                                                                     "distance fields. The default is 2048."),
+                                         QCoreApplication::translate("main", "size"),
+                                         QStringLiteral("2048"));
+    parser.addOption(textureSizeOption);
+
+    parser.process(*app);
+
+    if (batchMode) {
+        return generateFontFile(parser, outputOption, glyphsOption, unicodeRangesOption,
+                                charactersOption, textureSizeOption);
+    }
 
     MainWindow mainWindow;
     if (!parser.positionalArguments().isEmpty())
         mainWindow.open(parser.positionalArguments().constFirst());
     mainWindow.show();
 
-    return app.exec();
+    return app->exec();
 }
@@ -56,6 +56,8 @@ PhraseView::PhraseView(MultiDataModel *model, QList<QHash<QString, QList<Phrase
 
     connect(this, &QAbstractItemView::activated,
             this, &PhraseView::selectPhrase);
+    connect(m_dataModel, &MultiDataModel::allModelsDeleted,
+            this, [this]() { m_similarTextIndex.clear(); });
 }
 
 PhraseView::~PhraseView()
@@ -173,50 +175,28 @@ void PhraseView::resetNumGuesses()
 }
 
 static CandidateList similarTextHeuristicCandidates(MultiDataModel *model, int mi,
-    const char *text, int maxCandidates)
+    const char *text, int maxCandidates, SimilarTextIndex *index)
 {
-    QList<int> scores;
-    CandidateList candidates;
-
-    StringSimilarityMatcher stringmatcher(QString::fromLatin1(text));
+    SimilarTextCandidates candidates(QString::fromLatin1(text), maxCandidates);
 
     for (MultiDataModelIterator it(model, mi); it.isValid(); ++it) {
         MessageItem *m = it.current();
         if (!m)
             continue;
 
-        TranslatorMessage mtm = m->message();
+        const TranslatorMessage &mtm = m->message();
         if (mtm.type() == TranslatorMessage::Unfinished
             || mtm.translation().isEmpty())
             continue;
 
         QString s = m->text();
 
-        int score = stringmatcher.getSimilarityScore(s);
-
-        if (candidates.size() == maxCandidates && score > scores[maxCandidates - 1])
-            candidates.removeLast();
-        if (candidates.size() < maxCandidates && score >= textSimilarityThreshold ) {
-            Candidate cand(mtm.context(), s, mtm.comment(), mtm.translation());
-
-            int i;
-            for (i = 0; i < candidates.size(); ++i) {
-                if (score >= scores.at(i)) {
-                    if (score == scores.at(i)) {
-                        if (candidates.at(i) == cand)
-                            goto continue_outer_loop;
-                    } else {
-                        break;
-                    }
-                }
-            }
-            scores.insert(i, score);
-            candidates.insert(i, cand);
-        }
-        continue_outer_loop:
-        ;
+        const TextSignature &signature = index->signature(s);
+        if (!candidates.accepts(signature))
+            continue;
+        candidates.add(signature, Candidate(mtm.context(), s, mtm.comment(), mtm.translation()));
     }
-    return candidates;
+    return candidates.candidates();
 }
 
 
@@ -236,7 +216,7 @@ void PhraseView::setSourceText(int model, const QString &sourceText)
 
     if (!sourceText.isEmpty() && m_doGuesses) {
         const CandidateList cl = similarTextHeuristicCandidates(m_dataModel, model,
-            sourceText.toLatin1(), m_maxCandidates);
+            sourceText.toLatin1(), m_maxCandidates, &m_similarTextIndex);
         int n = 0;
         for (const Candidate &candidate : cl) {
             QString def;
@@ -64,6 +64,7 @@ private:
     int m_modelIndex;
     bool m_doGuesses;
     int m_maxCandidates = DefaultMaxCandidates;
+    SimilarTextIndex m_similarTextIndex;
 };
 
 QT_END_NAMESPACE
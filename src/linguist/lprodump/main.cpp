@@ -15,14 +15,18 @@
 #include <QtCore/QFileInfo>
 #include <QtCore/QLibraryInfo>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QSemaphore>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
+#include <QtCore/QThreadPool>
 
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
 
+#include <atomic>
 #include <iostream>
+#include <vector>
 
 using namespace Qt::StringLiterals;
 
@@ -66,7 +70,13 @@ from qmake projects to a .json file. This file can be passed to
 lupdate/lrelease using the -project option.
 
 Options:
+    -cache-dir <directory>
+           Keep the parsed qmake feature files, mkspecs and included
+           project files in <directory>, and only parse them again if
+           they changed since the last run.
     -help  Display this information and exit.
+    -jobs <n>
+           Evaluate subprojects in up to <n> threads. Default: 1.
     -silent
            Do not explain what is being done.
     -pro <filename>
@@ -118,6 +128,7 @@ public:
 };
 
 static EvalHandler evalHandler;
+static int jobCount = 1;
 
 static QStringList getResources(const QString &resourceFile, QMakeVfs *vfs)
 {
@@ -240,14 +251,12 @@ static void excludeProjects(const ProFileEvaluator &visitor, QStringList *subPro
     }
 }
 
-static QJsonArray processProjects(bool topLevel, const QStringList &proFiles,
+static QJsonArray processSubProjects(const QStringList &proFiles,
         const QStringList &translationsVariables,
-        const QHash<QString, QString> &outDirMap,
-        ProFileGlobals *option, QMakeVfs *vfs, QMakeParser *parser,
-        bool *fail);
+        ProFileGlobals *option, ProFileCache *cache, QMakeVfs *vfs, QMakeParser *parser);
 
 static QJsonObject processProject(const QString &proFile, const QStringList &translationsVariables,
-                                  ProFileGlobals *option, QMakeVfs *vfs,
+                                  ProFileGlobals *option, ProFileCache *cache, QMakeVfs *vfs,
                                   QMakeParser *parser, ProFileEvaluator &visitor)
 {
     QJsonObject result;
@@ -275,9 +284,8 @@ static QJsonObject processProject(const QString &proFile, const QStringList &tra
                 subProFiles << subPro;
             }
         }
-        QJsonArray subResults = processProjects(false, subProFiles, translationsVariables,
-                                                QHash<QString, QString>(), option, vfs, parser,
-                                                nullptr);
+        QJsonArray subResults = processSubProjects(subProFiles, translationsVariables, option,
+                                                   cache, vfs, parser);
         if (!subResults.isEmpty())
             setValue(result, "subProjects", subResults);
     } else {
@@ -291,54 +299,113 @@ static QJsonObject processProject(const QString &proFile, const QStringList &tra
     return result;
 }
 
+static bool processProFile(bool topLevel, const QString &proFile,
+                           const QStringList &translationsVariables,
+                           ProFileGlobals *option, ProFileCache *cache, QMakeVfs *vfs,
+                           QMakeParser *parser, QJsonObject *prj)
+{
+    ProFile *pro;
+    if (!(pro = parser->parsedProFile(proFile, topLevel ? QMakeParser::ParseReportMissing
+                                                        : QMakeParser::ParseDefault))) {
+        return false;
+    }
+    ProFileEvaluator visitor(option, parser, vfs, &evalHandler);
+    visitor.setCumulative(true);
+    visitor.setOutputDir(option->shadowedPath(pro->directoryName()));
+    if (!visitor.accept(pro)) {
+        pro->deref();
+        return false;
+    }
+
+    *prj = processProject(proFile, translationsVariables, option, cache, vfs, parser, visitor);
+    setValue(*prj, "projectFile", proFile);
+    QStringList tsFiles;
+    for (const QString &varName : translationsVariables) {
+        if (!visitor.contains(varName))
+            continue;
+        QDir proDir(QFileInfo(proFile).path());
+        const QStringList translations = visitor.values(varName);
+        for (const QString &tsFile : translations)
+            tsFiles << proDir.filePath(tsFile);
+    }
+    if (!tsFiles.isEmpty())
+        setValue(*prj, "translations", tsFiles);
+    if (visitor.contains(QLatin1String("LUPDATE_COMPILE_COMMANDS_PATH"))) {
+        const QStringList thepathjson = visitor.values(
+            QLatin1String("LUPDATE_COMPILE_COMMANDS_PATH"));
+        setValue(*prj, "compileCommands", thepathjson.value(0));
+    }
+    pro->deref();
+    return true;
+}
+
 static QJsonArray processProjects(bool topLevel, const QStringList &proFiles,
         const QStringList &translationsVariables,
         const QHash<QString, QString> &outDirMap,
-        ProFileGlobals *option, QMakeVfs *vfs, QMakeParser *parser, bool *fail)
+        ProFileGlobals *option, ProFileCache *cache, QMakeVfs *vfs, QMakeParser *parser,
+        bool *fail)
 {
     QJsonArray result;
     for (const QString &proFile : proFiles) {
         if (!outDirMap.isEmpty())
             option->setDirectories(QFileInfo(proFile).path(), outDirMap[proFile]);
 
-        ProFile *pro;
-        if (!(pro = parser->parsedProFile(proFile, topLevel ? QMakeParser::ParseReportMissing
-                                                            : QMakeParser::ParseDefault))) {
-            if (topLevel)
-                *fail = true;
-            continue;
-        }
-        ProFileEvaluator visitor(option, parser, vfs, &evalHandler);
-        visitor.setCumulative(true);
-        visitor.setOutputDir(option->shadowedPath(pro->directoryName()));
-        if (!visitor.accept(pro)) {
+        QJsonObject prj;
+        if (!processProFile(topLevel, proFile, translationsVariables, option, cache, vfs, parser,
+                            &prj)) {
             if (topLevel)
                 *fail = true;
-            pro->deref();
             continue;
         }
+        result.append(prj);
+    }
+    return result;
+}
 
-        QJsonObject prj = processProject(proFile, translationsVariables, option, vfs, parser,
-                                         visitor);
-        setValue(prj, "projectFile", proFile);
-        QStringList tsFiles;
-        for (const QString &varName : translationsVariables) {
-            if (!visitor.contains(varName))
-                continue;
-            QDir proDir(QFileInfo(proFile).path());
-            const QStringList translations = visitor.values(varName);
-            for (const QString &tsFile : translations)
-                tsFiles << proDir.filePath(tsFile);
-        }
-        if (!tsFiles.isEmpty())
-            setValue(prj, "translations", tsFiles);
-        if (visitor.contains(QLatin1String("LUPDATE_COMPILE_COMMANDS_PATH"))) {
-            const QStringList thepathjson = visitor.values(
-                QLatin1String("LUPDATE_COMPILE_COMMANDS_PATH"));
-            setValue(prj, "compileCommands", thepathjson.value(0));
+// Sibling subprojects do not depend on each other, so they are evaluated on
+// the global thread pool. The calling thread takes part in the work, and helpers
+// are only started while threads are idle, so nested SUBDIRS cannot starve the
+// pool. The results are collected by index to keep the order of SUBDIRS.
+// The parse cache is thread-safe, but a QMakeParser is not, so every helper
+// creates its own parser on top of the cache.
+static QJsonArray processSubProjects(const QStringList &proFiles,
+        const QStringList &translationsVariables,
+        ProFileGlobals *option, ProFileCache *cache, QMakeVfs *vfs, QMakeParser *parser)
+{
+    if (jobCount < 2 || proFiles.size() < 2) {
+        return processProjects(false, proFiles, translationsVariables,
+                               QHash<QString, QString>(), option, cache, vfs, parser, nullptr);
+    }
+
+    std::vector<QJsonObject> projects(proFiles.size());
+    std::vector<char> processed(proFiles.size(), false);
+    std::atomic<qsizetype> nextIndex = 0;
+    const auto processNext = [&](QMakeParser *threadParser) {
+        for (qsizetype i = nextIndex++; i < proFiles.size(); i = nextIndex++) {
+            processed[i] = processProFile(false, proFiles.at(i), translationsVariables,
+                                          option, cache, vfs, threadParser, &projects[i]);
         }
-        result.append(prj);
-        pro->deref();
+    };
+
+    QSemaphore finished;
+    int helperCount = 0;
+    QThreadPool *pool = QThreadPool::globalInstance();
+    while (helperCount < proFiles.size() - 1 && pool->tryStart([&] {
+               {
+                   QMakeParser helperParser(cache, vfs, &evalHandler);
+                   processNext(&helperParser);
+               }
+               finished.release();
+           })) {
+        ++helperCount;
+    }
+    processNext(parser);
+    finished.acquire(helperCount);
+
+    QJsonArray result;
+    for (size_t i = 0; i < projects.size(); ++i) {
+        if (processed[i])
+            result.append(projects[i]);
     }
     return result;
 }
@@ -352,6 +419,7 @@ int main(int argc, char **argv)
     QString outDir = QDir::currentPath();
     QHash<QString, QString> outDirMap;
     QString outputFilePath;
+    QString cacheDir;
     int proDebug = 0;
 
     for (int i = 1; i < args.size(); ++i) {
@@ -368,6 +436,22 @@ int main(int argc, char **argv)
                 return 1;
             }
             outputFilePath = args[i];
+        } else if (arg == QLatin1String("-cache-dir")) {
+            ++i;
+            if (i == argc) {
+                printErr(u"The option -cache-dir requires a parameter.\n"_s);
+                return 1;
+            }
+            cacheDir = QDir::cleanPath(QFileInfo(args[i]).absoluteFilePath());
+        } else if (arg == QLatin1String("-jobs")) {
+            ++i;
+            bool ok = false;
+            if (i < argc)
+                jobCount = args[i].toInt(&ok);
+            if (!ok || jobCount < 1) {
+                printErr(u"The option -jobs requires a positive number of jobs.\n"_s);
+                return 1;
+            }
         } else if (arg == QLatin1String("-silent")) {
             evalHandler.verbose = false;
         } else if (arg == QLatin1String("-pro-debug")) {
@@ -435,14 +519,35 @@ int main(int argc, char **argv)
     option.initProperties();
     option.setCommandLineArguments(QDir::currentPath(),
                                    QStringList() << QLatin1String("CONFIG+=lupdate_run"));
+    // The statics must be set up before any evaluation thread is started.
+    ProFileEvaluator::initialize();
+    QMakeParser::initialize();
+    if (jobCount > 1)
+        QThreadPool::globalInstance()->setMaxThreadCount(jobCount - 1);
+
+    // Files included by several subprojects, like .qmake.conf or common .pri
+    // files, are parsed only once.
+    ProFileCache cache;
+    if (!cacheDir.isEmpty()) {
+        if (!QDir().mkpath(cacheDir)) {
+            printErr(QStringLiteral("lprodump error: Cannot create %1.\n").arg(cacheDir));
+            return 1;
+        }
+        cache.setStorageFile(cacheDir + QLatin1String("/lprodump.cache"));
+    }
     QMakeVfs vfs;
-    QMakeParser parser(0, &vfs, &evalHandler);
+    QMakeParser parser(&cache, &vfs, &evalHandler);
 
     QJsonArray results = processProjects(true, proFiles, translationsVariables, outDirMap, &option,
-                                         &vfs, &parser, &fail);
+                                         &cache, &vfs, &parser, &fail);
     if (fail)
         return 1;
 
+    if (!cache.save()) {
+        printErr(QStringLiteral("lprodump warning: Cannot write the cache to %1.\n")
+                 .arg(cacheDir));
+    }
+
     const QByteArray output = QJsonDocument(results).toJson(QJsonDocument::Compact);
     if (outputFilePath.isEmpty()) {
         puts(output.constData());
@@ -37,6 +37,8 @@ passed to lrelease.
 
 Options:
     -help  Display this information and exit
+    -jobs <n>
+           Evaluate subprojects and release TS files in up to <n> threads
     -keep  Keep the temporary project dump around
     -silent
            Do not explain what is being done
@@ -70,6 +72,15 @@ int main(int argc, char **argv)
     for (int i = 1; i < argc; ++i) {
         if (!strcmp(argv[i], "-keep")) {
             keepProjectDescription = true;
+        } else if (!strcmp(argv[i], "-jobs")) {
+            if (++i == argc) {
+                printErr(u"The option -jobs requires a positive number of jobs.\n"_s);
+                return 1;
+            }
+            const QString arg = QString::fromLocal8Bit(argv[i - 1]);
+            const QString value = QString::fromLocal8Bit(argv[i]);
+            lprodumpOptions << arg << value;
+            lreleaseOptions << arg << value;
         } else if (!strcmp(argv[i], "-silent")) {
             const QString arg = QString::fromLocal8Bit(argv[i]);
             lprodumpOptions << arg;
@@ -3,6 +3,7 @@
 
 #include "translator.h"
 
+#include <orderedjobs.h>
 #include <profileutils.h>
 #include <projectdescriptionreader.h>
 #include <runqttool.h>
@@ -11,15 +12,21 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QTranslator>
 #endif
+#include <QtCore/QDateTime>
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QSaveFile>
 #include <QtCore/QString>
 #include <QtCore/QStringList>
 #include <QtCore/QTextStream>
 #include <QtCore/QLibraryInfo>
 
+#include <atomic>
+#include <sstream>
+#include <vector>
+
 QT_USE_NAMESPACE
 
 using namespace Qt::StringLiterals;
@@ -67,6 +74,11 @@ Options:
     -project <filename>
            Name of a file containing the project's description in JSON format.
            Such a file may be generated from a .pro file using the lprodump tool.
+    -jobs <n>
+           Release up to <n> TS files at the same time. Default: 1.
+    -incremental
+           Do not release a QM file that is newer than its TS files and that
+           was released with the same options before
     -silent
            Do not explain what is being done
     -version
@@ -74,37 +86,97 @@ Options:
 )"_s);
 }
 
-static bool loadTsFile(Translator &tor, const QString &tsFileName, bool /* verbose */)
+// Collects the messages printed while releasing one file, so that the
+// output of files released at the same time is not interleaved.
+struct ReleaseJob : BufferedOutput
+{
+    QString tsFileName;
+    bool fail = false;
+};
+
+static bool loadTsFile(Translator &tor, const QString &tsFileName, ReleaseJob *job)
 {
     ConversionData cd;
     bool ok = tor.load(tsFileName, cd, QLatin1String("auto"));
     if (!ok) {
-        printErr(QLatin1String("lrelease error: %1").arg(cd.error()));
+        job->err(QLatin1String("lrelease error: %1").arg(cd.error()));
     } else {
         if (!cd.errors().isEmpty())
-            printOut(cd.error());
+            job->out(cd.error());
     }
     cd.clearErrors();
     return ok;
 }
 
+// Everything besides the TS files that affects the contents of a QM file
+static QString optionsStamp(const ConversionData &cd, bool removeIdentical,
+                            const QStringList &tsFileNames)
+{
+    QStringList lines;
+    lines << u"lrelease %1"_s.arg(QLatin1String(QT_VERSION_STR))
+          << u"idbased %1"_s.arg(int(cd.m_idBased))
+          << u"savemode %1"_s.arg(int(cd.m_saveMode))
+          << u"nounfinished %1"_s.arg(int(cd.m_ignoreUnfinished))
+          << u"removeidentical %1"_s.arg(int(removeIdentical))
+          << u"markuntranslated %1"_s.arg(cd.m_unTrPrefix);
+    for (const QString &tsFileName : tsFileNames)
+        lines << u"input %1"_s.arg(QFileInfo(tsFileName).absoluteFilePath());
+    return lines.join(QLatin1Char('\n')) + QLatin1Char('\n');
+}
+
+static QString stampFileName(const QString &qmFileName)
+{
+    return qmFileName + QLatin1String(".options");
+}
+
+static bool isUpToDate(const QString &qmFileName, const QStringList &tsFileNames,
+                       const QString &stamp)
+{
+    const QFileInfo qmInfo(qmFileName);
+    if (!qmInfo.exists())
+        return false;
+    const QDateTime qmModified = qmInfo.lastModified();
+    for (const QString &tsFileName : tsFileNames) {
+        const QFileInfo tsInfo(tsFileName);
+        if (!tsInfo.exists() || tsInfo.lastModified() >= qmModified)
+            return false;
+    }
+
+    QFile stampFile(stampFileName(qmFileName));
+    if (!stampFile.open(QIODevice::ReadOnly))
+        return false;
+    return QString::fromUtf8(stampFile.readAll()) == stamp;
+}
+
+static void writeStamp(const QString &qmFileName, const QString &stamp)
+{
+    QSaveFile stampFile(stampFileName(qmFileName));
+    if (stampFile.open(QIODevice::WriteOnly)) {
+        stampFile.write(stamp.toUtf8());
+        stampFile.commit();
+    }
+}
+
 static bool releaseTranslator(Translator &tor, const QString &qmFileName,
-    ConversionData &cd, bool removeIdentical)
+    ConversionData &cd, bool removeIdentical, ReleaseJob *job)
 {
-    tor.reportDuplicates(tor.resolveDuplicates(), qmFileName, cd.isVerbose());
+    std::ostringstream duplicates;
+    tor.reportDuplicates(tor.resolveDuplicates(), qmFileName, cd.isVerbose(), duplicates);
+    if (!duplicates.str().empty())
+        job->err(QString::fromLocal8Bit(duplicates.str()));
 
     if (cd.isVerbose())
-        printOut(QLatin1String("Updating '%1'...\n").arg(qmFileName));
+        job->out(QLatin1String("Updating '%1'...\n").arg(qmFileName));
     if (removeIdentical) {
         if (cd.isVerbose())
-            printOut(QLatin1String("Removing translations equal to source text in '%1'...\n")
+            job->out(QLatin1String("Removing translations equal to source text in '%1'...\n")
                              .arg(qmFileName));
         tor.stripIdenticalSourceTranslations();
     }
 
     QFile file(qmFileName);
     if (!file.open(QIODevice::WriteOnly)) {
-        printErr(QLatin1String("lrelease error: cannot create '%1': %2\n")
+        job->err(QLatin1String("lrelease error: cannot create '%1': %2\n")
                          .arg(qmFileName, file.errorString()));
         return false;
     }
@@ -114,21 +186,16 @@ static bool releaseTranslator(Translator &tor, const QString &qmFileName,
     file.close();
 
     if (!ok) {
-        printErr(QLatin1String("lrelease error: cannot save '%1': %2").arg(qmFileName, cd.error()));
+        job->err(QLatin1String("lrelease error: cannot save '%1': %2").arg(qmFileName, cd.error()));
     } else if (!cd.errors().isEmpty()) {
-        printOut(cd.error());
+        job->out(cd.error());
     }
     cd.clearErrors();
     return ok;
 }
 
-static bool releaseTsFile(const QString& tsFileName,
-    ConversionData &cd, bool removeIdentical)
+static QString qmFileNameFor(const QString &tsFileName)
 {
-    Translator tor;
-    if (!loadTsFile(tor, tsFileName, cd.isVerbose()))
-        return false;
-
     QString qmFileName = tsFileName;
     for (const Translator::FileFormat &fmt : std::as_const(Translator::registeredFileFormats())) {
         if (qmFileName.endsWith(QLatin1Char('.') + fmt.extension)) {
@@ -137,8 +204,60 @@ static bool releaseTsFile(const QString& tsFileName,
         }
     }
     qmFileName += QLatin1String(".qm");
+    return qmFileName;
+}
+
+static void releaseTsFile(const ConversionData &options, bool removeIdentical, bool incremental,
+                          ReleaseJob *job)
+{
+    const QString qmFileName = qmFileNameFor(job->tsFileName);
+    QString stamp;
+    if (incremental) {
+        stamp = optionsStamp(options, removeIdentical, { job->tsFileName });
+        if (isUpToDate(qmFileName, { job->tsFileName }, stamp)) {
+            if (options.isVerbose())
+                job->out(QLatin1String("'%1' is up to date.\n").arg(qmFileName));
+            return;
+        }
+    }
+
+    Translator tor;
+    ConversionData cd = options;
+    if (!loadTsFile(tor, job->tsFileName, job)
+        || !releaseTranslator(tor, qmFileName, cd, removeIdentical, job)) {
+        job->fail = true;
+        return;
+    }
+    if (incremental)
+        writeStamp(qmFileName, stamp);
+}
 
-    return releaseTranslator(tor, qmFileName, cd, removeIdentical);
+static bool releaseTsFiles(const QStringList &tsFileNames, const ConversionData &cd,
+                           bool removeIdentical, bool incremental, int jobCount)
+{
+    std::vector<ReleaseJob> jobs(tsFileNames.size());
+    for (qsizetype i = 0; i < tsFileNames.size(); ++i)
+        jobs[i].tsFileName = tsFileNames.at(i);
+
+    // Each TS file is loaded, released and saved on its own. The output
+    // of every file is printed in the order of the files on the command
+    // line, and no more files are started once one of them has failed.
+    QStringList uniqueFileNames = tsFileNames;
+    uniqueFileNames.removeDuplicates();
+    std::atomic<bool> failed = false;
+    return runOrderedJobs(
+            jobs.size(), uniqueFileNames.size() == tsFileNames.size() ? jobCount : 1,
+            [&](size_t i) {
+                if (failed)
+                    return;
+                releaseTsFile(cd, removeIdentical, incremental, &jobs[i]);
+                if (jobs[i].fail)
+                    failed = true;
+            },
+            [&](size_t i) {
+                jobs[i].print(printOut, printErr);
+                return !jobs[i].fail;
+            });
 }
 
 static QStringList translationsFromProjects(const Projects &projects, bool topLevel);
@@ -172,6 +291,8 @@ int main(int argc, char **argv)
     ConversionData cd;
     cd.m_verbose = true; // the default is true starting with Qt 4.2
     bool removeIdentical = false;
+    bool incremental = false;
+    int jobCount = 1;
     Translator tor;
     QStringList inputFiles;
     QString outputFile;
@@ -209,6 +330,17 @@ int main(int argc, char **argv)
                 return 1;
             }
             projectDescriptionFile = QString::fromLocal8Bit(argv[++i]);
+        } else if (!strcmp(argv[i], "-jobs")) {
+            bool ok = false;
+            if (i < argc - 1)
+                jobCount = QString::fromLocal8Bit(argv[++i]).toInt(&ok);
+            if (!ok || jobCount < 1) {
+                printErr(QLatin1String("The option -jobs requires a positive number of jobs.\n"));
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-incremental")) {
+            incremental = true;
+            continue;
         } else if (!strcmp(argv[i], "-silent")) {
             cd.m_verbose = false;
             continue;
@@ -260,18 +392,33 @@ int main(int argc, char **argv)
         inputFiles = translationsFromProjects(projectDescription);
     }
 
-    for (const QString &inputFile : std::as_const(inputFiles)) {
-        if (outputFile.isEmpty()) {
-            if (!releaseTsFile(inputFile, cd, removeIdentical))
-                return 1;
-        } else {
-            if (!loadTsFile(tor, inputFile, cd.isVerbose()))
-                return 1;
+    if (outputFile.isEmpty())
+        return releaseTsFiles(inputFiles, cd, removeIdentical, incremental, jobCount) ? 0 : 1;
+
+    QString stamp;
+    if (incremental) {
+        stamp = optionsStamp(cd, removeIdentical, inputFiles);
+        if (isUpToDate(outputFile, inputFiles, stamp)) {
+            if (cd.isVerbose())
+                printOut(QLatin1String("'%1' is up to date.\n").arg(outputFile));
+            return 0;
         }
     }
 
-    if (!outputFile.isEmpty())
-        return releaseTranslator(tor, outputFile, cd, removeIdentical) ? 0 : 1;
+    for (const QString &inputFile : std::as_const(inputFiles)) {
+        ReleaseJob job;
+        bool ok = loadTsFile(tor, inputFile, &job);
+        job.print(printOut, printErr);
+        if (!ok)
+            return 1;
+    }
 
+    ReleaseJob job;
+    bool ok = releaseTranslator(tor, outputFile, cd, removeIdentical, &job);
+    job.print(printOut, printErr);
+    if (!ok)
+        return 1;
+    if (incremental)
+        writeStamp(outputFile, stamp);
     return 0;
 }
@@ -40,7 +40,14 @@ All command line options that are not consumed by lupdate-pro are
 passed to lupdate.
 
 Options:
+    -cache-dir <directory>
+           Keep parsed project files and the messages found in source
+           files in <directory>, and only process files again if they
+           changed since the last run.
     -help  Display this information and exit.
+    -jobs <n>
+           Evaluate subprojects and parse source files in up to <n> threads.
+           Default: 1.
     -silent
            Do not explain what is being done.
     -pro <filename>
@@ -92,6 +99,22 @@ int main(int argc, char **argv)
             lprodumpOptions << arg;
         } else if (arg == QLatin1String("-pro-debug")) {
             lprodumpOptions << arg;
+        } else if (arg == QLatin1String("-cache-dir")) {
+            ++i;
+            if (i == argc) {
+                printErr(u"The option -cache-dir requires a parameter.\n"_s);
+                return 1;
+            }
+            lupdateOptions << arg << args[i];
+            lprodumpOptions << arg << args[i];
+        } else if (arg == QLatin1String("-jobs")) {
+            ++i;
+            if (i == argc) {
+                printErr(u"The option -jobs requires a positive number of jobs.\n"_s);
+                return 1;
+            }
+            lupdateOptions << arg << args[i];
+            lprodumpOptions << arg << args[i];
         } else if (arg == QLatin1String("-version")) {
             printOut(QStringLiteral("lupdate-pro version %1\n").arg(QLatin1String(QT_VERSION_STR)));
             return 0;
@@ -2,13 +2,20 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include "cpp.h"
+#include "extractioncache.h"
 
+#include <orderedjobs.h>
 #include <translator.h>
 #include <QtCore/QBitArray>
 #include <QtCore/QStack>
 #include <QtCore/QTextStream>
+#include <QtCore/QThread>
 #include <QtCore/QRegularExpression>
 
+#include <atomic>
+#include <memory>
+#include <sstream>
+
 QT_BEGIN_NAMESPACE
 
 
@@ -40,7 +47,11 @@ size_t qHash(const HashStringList &list)
     return list.m_hash;
 }
 
-static int nextFileId;
+static std::atomic<int> nextFileId;
+
+// Guards the members of class definitions that the parsers of other files
+// update, as the definition may come from a header shared between threads.
+static QBasicMutex classDefMutex;
 
 class VisitRecorder {
 public:
@@ -50,6 +61,9 @@ public:
     }
     bool tryVisit(int fileId)
     {
+        // Headers parsed by other threads may have been recorded since
+        if (fileId >= m_ba.size())
+            m_ba.resize(nextFileId);
         if (m_ba.at(fileId))
             return false;
         m_ba[fileId] = true;
@@ -59,6 +73,42 @@ private:
     QBitArray m_ba;
 };
 
+// The messages printed while parsing one source file and the headers parsed
+// along with it. As the files are parsed concurrently, a class that lacks
+// Q_OBJECT is reported by every file using it, and print() keeps only the
+// report of the first file in the order of the files.
+struct ParserMessages
+{
+    struct MissingQObject
+    {
+        const Namespace *classDef;
+        std::streamoff begin;
+        std::streamoff end;
+    };
+
+    std::ostringstream stream;
+    std::vector<MissingQObject> missingQObject;
+
+    std::string print(QSet<const Namespace *> *reportedClasses) const;
+};
+
+std::string ParserMessages::print(QSet<const Namespace *> *reportedClasses) const
+{
+    const std::string text = stream.str();
+    std::string printed;
+    std::streamoff pos = 0;
+    for (const MissingQObject &report : missingQObject) {
+        if (!reportedClasses->contains(report.classDef)) {
+            reportedClasses->insert(report.classDef);
+            continue;
+        }
+        printed.append(text, pos, report.begin - pos);
+        pos = report.end;
+    }
+    printed.append(text, pos);
+    return printed;
+}
+
 struct CppParserState
 {
     NamespaceList namespaces;
@@ -75,9 +125,12 @@ public:
     void setInput(const QString &in);
     void setInput(QTextStream &ts, const QString &fileName);
     void setTranslator(Translator *_tor) { tor = _tor; }
+    void setMessages(ParserMessages *messages) { yyMessages = messages; }
+    const FileDependencies &fileDependencies() const { return dependencies; }
     void parse(ConversionData &cd, const QStringList &includeStack, QSet<QString> &inclusions);
     void parseInternal(ConversionData &cd, const QStringList &includeStack, QSet<QString> &inclusions);
     const ParseResults *recordResults(bool isHeader);
+    ParseResults *takeResults();
     void deleteResults() { delete results; }
 
 private:
@@ -108,6 +161,7 @@ private:
     };
 
     std::ostream &yyMsg(int line = 0);
+    void reportMissingQObject(const Namespace *classDef, const QString &className);
 
     int getChar();
     TokenType lookAheadToSemicolonOrLeftBrace();
@@ -170,6 +224,7 @@ private:
 
     // Tokenizer state
     QString yyFileName;
+    ParserMessages *yyMessages = nullptr;
     int yyCh;
     bool yyAtNewline;
     QString yyWord;
@@ -205,6 +260,7 @@ private:
     ParseResults *results;
     Translator *tor;
     bool directInclude;
+    FileDependencies dependencies;
 
     CppParserState savedState;
     int yyMinBraceDepth;
@@ -236,7 +292,24 @@ CppParser::CppParser(ParseResults *_results)
 
 std::ostream &CppParser::yyMsg(int line)
 {
-    return std::cerr << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
+    std::ostream &stream = yyMessages ? yyMessages->stream : std::cerr;
+    return stream << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
+}
+
+void CppParser::reportMissingQObject(const Namespace *classDef, const QString &className)
+{
+    const QString msg = QStringLiteral("Class '%1' lacks Q_OBJECT macro\n").arg(className);
+    if (!yyMessages) {
+        yyMsg() << qPrintable(msg);
+        return;
+    }
+    for (const ParserMessages::MissingQObject &report : yyMessages->missingQObject) {
+        if (report.classDef == classDef)
+            return;
+    }
+    const std::streamoff begin = yyMessages->stream.tellp();
+    yyMsg() << qPrintable(msg);
+    yyMessages->missingQObject.push_back({ classDef, begin, yyMessages->stream.tellp() });
 }
 
 void CppParser::setInput(const QString &in)
@@ -251,6 +324,7 @@ void CppParser::setInput(QTextStream &ts, const QString &fileName)
     yyInStr = ts.readAll();
     yyFileName = fileName;
     yySourceEncoding = ts.encoding();
+    dependencies.fileNames.insert(fileName);
 }
 
 /*
@@ -1152,8 +1226,26 @@ void CppParser::truncateNamespaces(NamespaceList *namespaces, int length)
 
 /*
   Functions for processing include files.
+
+  The results are shared between the parsers of all source files, which
+  may run in several threads. Each header that is processed stand-alone
+  is claimed by one thread at a time, so that it is parsed only once.
 */
 
+QMutex &CppFiles::mutex()
+{
+    static QMutex mutex;
+
+    return mutex;
+}
+
+QWaitCondition &CppFiles::fileReleased()
+{
+    static QWaitCondition released;
+
+    return released;
+}
+
 IncludeCycleHash &CppFiles::includeCycles()
 {
     static IncludeCycleHash cycles;
@@ -1175,8 +1267,37 @@ QSet<QString> &CppFiles::blacklistedFiles()
     return blacklisted;
 }
 
+DependencyHash &CppFiles::fileDependencies()
+{
+    static DependencyHash dependencies;
+
+    return dependencies;
+}
+
+QHash<QString, Qt::HANDLE> &CppFiles::parsingFiles()
+{
+    static QHash<QString, Qt::HANDLE> owners;
+
+    return owners;
+}
+
+QHash<Qt::HANDLE, QStringList> &CppFiles::parsingStacks()
+{
+    static QHash<Qt::HANDLE, QStringList> stacks;
+
+    return stacks;
+}
+
+QHash<Qt::HANDLE, QString> &CppFiles::waitingThreads()
+{
+    static QHash<Qt::HANDLE, QString> waiting;
+
+    return waiting;
+}
+
 QSet<const ParseResults *> CppFiles::getResults(const QString &cleanFile)
 {
+    QMutexLocker locker(&mutex());
     IncludeCycle * const cycle = includeCycles().value(cleanFile);
 
     if (cycle)
@@ -1187,6 +1308,7 @@ QSet<const ParseResults *> CppFiles::getResults(const QString &cleanFile)
 
 void CppFiles::setResults(const QString &cleanFile, const ParseResults *results)
 {
+    QMutexLocker locker(&mutex());
     IncludeCycle *cycle = includeCycles().value(cleanFile);
 
     if (!cycle) {
@@ -1200,25 +1322,47 @@ void CppFiles::setResults(const QString &cleanFile, const ParseResults *results)
 
 const Translator *CppFiles::getTranslator(const QString &cleanFile)
 {
+    QMutexLocker locker(&mutex());
     return translatedFiles().value(cleanFile);
 }
 
 void CppFiles::setTranslator(const QString &cleanFile, const Translator *tor)
 {
+    QMutexLocker locker(&mutex());
     translatedFiles().insert(cleanFile, tor);
 }
 
 bool CppFiles::isBlacklisted(const QString &cleanFile)
 {
+    QMutexLocker locker(&mutex());
     return blacklistedFiles().contains(cleanFile);
 }
 
 void CppFiles::setBlacklisted(const QString &cleanFile)
 {
+    QMutexLocker locker(&mutex());
     blacklistedFiles().insert(cleanFile);
 }
 
+FileDependencies CppFiles::getDependencies(const QString &cleanFile)
+{
+    QMutexLocker locker(&mutex());
+    return fileDependencies().value(cleanFile);
+}
+
+void CppFiles::setDependencies(const QString &cleanFile, const FileDependencies &dependencies)
+{
+    QMutexLocker locker(&mutex());
+    fileDependencies().insert(cleanFile, dependencies);
+}
+
 void CppFiles::addIncludeCycle(const QSet<QString> &fileNames)
+{
+    QMutexLocker locker(&mutex());
+    insertIncludeCycle(fileNames);
+}
+
+void CppFiles::insertIncludeCycle(const QSet<QString> &fileNames)
 {
     IncludeCycle * const cycle = new IncludeCycle;
     cycle->fileNames = fileNames;
@@ -1240,6 +1384,87 @@ void CppFiles::addIncludeCycle(const QSet<QString> &fileNames)
         includeCycles().insert(fileName, cycle);
 }
 
+/*
+  Claims the header cleanFile for being parsed stand-alone by the calling
+  thread, which must call releaseFile() once it has recorded the results.
+  If the header has been parsed already, or is being parsed by another
+  thread, stores its results in *results and returns FileParsed instead.
+*/
+CppFiles::ClaimResult CppFiles::claimFile(const QString &cleanFile,
+                                          QSet<const ParseResults *> *results)
+{
+    const Qt::HANDLE self = QThread::currentThreadId();
+    QMutexLocker locker(&mutex());
+
+    forever {
+        const Qt::HANDLE owner = parsingFiles().value(cleanFile);
+        if (!owner || owner == self) {
+            // Like a single parser, a thread may parse a header again while
+            // parsing it, if the header includes itself through another one.
+            const IncludeCycle *cycle = includeCycles().value(cleanFile);
+            if (cycle && !cycle->results.isEmpty()) {
+                *results = cycle->results;
+                return FileParsed;
+            }
+            parsingFiles().insert(cleanFile, self);
+            parsingStacks()[self].append(cleanFile);
+            return ParseFile;
+        }
+        if (closesIncludeCycle(cleanFile, self))
+            return FileInIncludeCycle;
+
+        waitingThreads().insert(self, cleanFile);
+        fileReleased().wait(&mutex());
+        waitingThreads().remove(self);
+    }
+}
+
+void CppFiles::releaseFile(const QString &cleanFile)
+{
+    const Qt::HANDLE self = QThread::currentThreadId();
+    QMutexLocker locker(&mutex());
+
+    QStringList &stack = parsingStacks()[self];
+    stack.removeAt(stack.lastIndexOf(cleanFile));
+    if (!stack.contains(cleanFile))
+        parsingFiles().remove(cleanFile);
+    if (stack.isEmpty())
+        parsingStacks().remove(self);
+    fileReleased().wakeAll();
+}
+
+/*
+  Returns true if waiting for another thread to finish parsing cleanFile
+  would make threads wait for each other, because the headers that they
+  parse include each other. This is recorded as an include cycle of all
+  these headers, just like the parser does when a header includes itself.
+*/
+bool CppFiles::closesIncludeCycle(const QString &cleanFile, Qt::HANDLE thread)
+{
+    QSet<QString> fileNames;
+    QString fileName = cleanFile;
+    forever {
+        // The file may have been released since the caller looked it up
+        const Qt::HANDLE owner = parsingFiles().value(fileName);
+        if (!owner)
+            return false;
+        const QStringList stack = parsingStacks().value(owner);
+        const qsizetype index = stack.indexOf(fileName);
+        if (index < 0)
+            return false;
+        fileNames.unite(QSet<QString>(stack.cbegin() + index, stack.cend()));
+        if (owner == thread)
+            break;
+
+        const auto waiting = waitingThreads().constFind(owner);
+        if (waiting == waitingThreads().cend())
+            return false;
+        fileName = *waiting;
+    }
+    insertIncludeCycle(fileNames);
+    return true;
+}
+
 static bool isHeader(const QString &name)
 {
     QString fileExt = QFileInfo(name).suffix();
@@ -1257,6 +1482,7 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
             return;
     }
 
+    dependencies.fileNames.insert(cleanFile);
     const int index = includeStack.indexOf(cleanFile);
     if (index != -1) {
         CppFiles::addIncludeCycle(QSet<QString>(includeStack.cbegin() + index, includeStack.cend()));
@@ -1273,10 +1499,16 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         && !CppFiles::isBlacklisted(cleanFile)
         && isHeader(cleanFile)) {
 
-        QSet<const ParseResults *> res = CppFiles::getResults(cleanFile);
-        if (!res.isEmpty()) {
+        QSet<const ParseResults *> res;
+        switch (CppFiles::claimFile(cleanFile, &res)) {
+        case CppFiles::FileParsed:
             results->includes.unite(res);
+            dependencies.unite(CppFiles::getDependencies(cleanFile));
             return;
+        case CppFiles::FileInIncludeCycle:
+            return;
+        case CppFiles::ParseFile:
+            break;
         }
 
         isIndirect = true;
@@ -1286,6 +1518,8 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
     if (!f.open(QIODevice::ReadOnly)) {
         yyMsg() << qPrintable(
             QStringLiteral("Cannot open %1: %2\n").arg(cleanFile, f.errorString()));
+        if (isIndirect)
+            CppFiles::releaseFile(cleanFile);
         return;
     }
 
@@ -1296,6 +1530,7 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
     inclusions.insert(cleanFile);
     if (isIndirect) {
         CppParser parser;
+        parser.yyMessages = yyMessages;
         for (const QString &projectRoot : std::as_const(cd.m_projectRoots))
             if (cleanFile.startsWith(projectRoot)) {
                 parser.setTranslator(new Translator);
@@ -1306,8 +1541,11 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         stack << cleanFile;
         parser.parse(cd, stack, inclusions);
         results->includes.insert(parser.recordResults(true));
+        CppFiles::releaseFile(cleanFile);
+        dependencies.unite(parser.dependencies);
     } else {
         CppParser parser(results);
+        parser.yyMessages = yyMessages;
         parser.namespaces = namespaces;
         parser.functionContext = functionContext;
         parser.functionContextUnresolved = functionContextUnresolved;
@@ -1318,6 +1556,8 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         parser.parseInternal(cd, stack, inclusions);
         // Avoid that messages obtained by direct scanning are used
         CppFiles::setBlacklisted(cleanFile);
+        dependencies.unite(parser.dependencies);
+        dependencies.blacklisted.insert(cleanFile);
     }
     inclusions.remove(cleanFile);
 
@@ -1481,16 +1721,13 @@ void CppParser::handleTr(QString &prefix, bool plural)
                     yyMsg() << "tr() cannot be called without context\n";
                     return;
                 }
+                QMutexLocker locker(&classDefMutex);
                 Namespace *fctx;
                 while (!(fctx = findNamespace(functionContext, idx)->classDef)->hasTrFunctions) {
                     if (idx == 1) {
                         context = stringifyNamespace(functionContext);
                         fctx = findNamespace(functionContext)->classDef;
-                        if (!fctx->complained) {
-                            yyMsg() << qPrintable(
-                                QStringLiteral("Class '%1' lacks Q_OBJECT macro\n").arg(context));
-                            fctx->complained = true;
-                        }
+                        reportMissingQObject(fctx, context);
                         goto gotctx;
                     }
                     --idx;
@@ -1523,6 +1760,7 @@ void CppParser::handleTr(QString &prefix, bool plural)
             NamespaceList nsl;
             NamespaceList unresolved;
             if (fullyQualify(functionContext, prefix, false, &nsl, &unresolved)) {
+                QMutexLocker locker(&classDefMutex);
                 Namespace *fctx = findNamespace(nsl)->classDef;
                 if (fctx->trQualification.isEmpty()) {
                     context = stringifyNamespace(nsl);
@@ -1530,11 +1768,8 @@ void CppParser::handleTr(QString &prefix, bool plural)
                 } else {
                     context = fctx->trQualification;
                 }
-                if (!fctx->hasTrFunctions && !fctx->complained) {
-                    yyMsg() << qPrintable(QStringLiteral("Class '%1' lacks Q_OBJECT macro\n")
-                                          .arg(context));
-                    fctx->complained = true;
-                }
+                if (!fctx->hasTrFunctions)
+                    reportMissingQObject(fctx, context);
             } else {
                 context = joinNamespaces(stringifyNamespace(nsl), stringifyNamespace(0, unresolved));
             }
@@ -2222,6 +2457,15 @@ void CppParser::processComment()
     }
 }
 
+// Hands the classes of a source file over to the caller, instead of having
+// recordResults() delete them, so that they stay alive as long as needed.
+ParseResults *CppParser::takeResults()
+{
+    ParseResults *taken = results;
+    results = nullptr;
+    return taken;
+}
+
 const ParseResults *CppParser::recordResults(bool isHeader)
 {
     if (tor) {
@@ -2245,6 +2489,7 @@ const ParseResults *CppParser::recordResults(bool isHeader)
             results->fileId = nextFileId++;
             pr = results;
         }
+        CppFiles::setDependencies(yyFileName, dependencies);
         CppFiles::setResults(yyFileName, pr);
         return pr;
     } else {
@@ -2253,39 +2498,121 @@ const ParseResults *CppParser::recordResults(bool isHeader)
     }
 }
 
-void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd)
+struct CppSourceFile
+{
+    QString fileName;
+    QString error;
+    ParserMessages messages;
+    bool parsed = false;
+    FileDependencies dependencies;
+    // The classes of a source file, which its messages may refer to
+    std::unique_ptr<ParseResults> results;
+    bool cached = false;
+    ExtractionCache::Entry cacheEntry;
+};
+
+static void parseCppFile(CppSourceFile *source, ConversionData &cd, QStringConverter::Encoding e)
+{
+    const QString &filename = source->fileName;
+    if (!CppFiles::getResults(filename).isEmpty() || CppFiles::isBlacklisted(filename))
+        return;
+
+    // A header may be parsed by another thread already, as an include
+    const bool header = isHeader(filename);
+    QSet<const ParseResults *> res;
+    if (header && CppFiles::claimFile(filename, &res) != CppFiles::ParseFile)
+        return;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        source->error = QStringLiteral("Cannot open %1: %2").arg(filename, file.errorString());
+        if (header)
+            CppFiles::releaseFile(filename);
+        return;
+    }
+
+    CppParser parser;
+    QTextStream ts(&file);
+    ts.setEncoding(e);
+    ts.setAutoDetectUnicode(true);
+    parser.setInput(ts, filename);
+    parser.setMessages(&source->messages);
+    Translator *tor = new Translator;
+    parser.setTranslator(tor);
+    QSet<QString> inclusions;
+    parser.parse(cd, QStringList(), inclusions);
+    if (!header)
+        source->results.reset(parser.takeResults());
+    parser.recordResults(header);
+    if (header)
+        CppFiles::releaseFile(filename);
+    source->parsed = true;
+    source->dependencies = parser.fileDependencies();
+}
+
+void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd,
+             int jobCount)
 {
     QStringConverter::Encoding e = cd.m_sourceIsUtf16 ? QStringConverter::Utf16 : QStringConverter::Utf8;
+    const QByteArray fingerprint =
+            extractionCache.isEnabled() ? extractionCache.fingerprint(cd) : QByteArray();
+
+    std::vector<CppSourceFile> sources(filenames.size());
+    std::vector<CppSourceFile *> queue;
+    for (qsizetype i = 0; i < filenames.size(); ++i) {
+        CppSourceFile &source = sources[i];
+        source.fileName = filenames.at(i);
+        source.cached = extractionCache.find(source.fileName, fingerprint, &source.cacheEntry);
+        if (!source.cached)
+            queue.push_back(&source);
+    }
 
-    for (const QString &filename : filenames) {
-        if (!CppFiles::getResults(filename).isEmpty() || CppFiles::isBlacklisted(filename))
-            continue;
+    // Files taken from the cache still blacklist the files they include
+    // directly, and this must be known before the other files are parsed.
+    for (const CppSourceFile &source : sources) {
+        for (const QString &blacklisted : source.cacheEntry.blacklisted)
+            CppFiles::setBlacklisted(blacklisted);
+    }
 
-        QFile file(filename);
-        if (!file.open(QIODevice::ReadOnly)) {
-            cd.appendError(QStringLiteral("Cannot open %1: %2").arg(filename,
-                                                                    file.errorString()));
-            continue;
+    // The parsers only read cd, and their messages are printed in the order
+    // of the files. The tr() function names must be hashed before the
+    // parsers look them up.
+    trFunctionAliasManager.nameToTrFunctionMap();
+    QSet<const Namespace *> reportedClasses;
+    runOrderedJobs(
+            queue.size(), jobCount,
+            [&](size_t i) { parseCppFile(queue[i], cd, e); },
+            [&](size_t i) {
+                const CppSourceFile *source = queue[i];
+                std::cerr << source->messages.print(&reportedClasses);
+                if (!source->error.isEmpty())
+                    cd.appendError(source->error);
+                return true;
+            });
+
+    for (const CppSourceFile &source : sources) {
+        const QString &filename = source.fileName;
+        QList<TranslatorMessage> messages;
+        if (source.cached) {
+            messages = source.cacheEntry.messages;
+        } else if (const Translator *tor = CppFiles::getTranslator(filename)) {
+            messages = tor->messages();
         }
 
-        CppParser parser;
-        QTextStream ts(&file);
-        ts.setEncoding(e);
-        ts.setAutoDetectUnicode(true);
-        parser.setInput(ts, filename);
-        Translator *tor = new Translator;
-        parser.setTranslator(tor);
-        QSet<QString> inclusions;
-        parser.parse(cd, QStringList(), inclusions);
-        parser.recordResults(isHeader(filename));
-    }
+        // Files whose parsing printed messages are parsed again next time,
+        // so that the messages are repeated.
+        if (source.parsed && source.messages.stream.str().empty()
+            && extractionCache.isEnabled()) {
+            ExtractionCache::Entry entry;
+            entry.dependencies = source.dependencies.fileNames.values();
+            entry.blacklisted = source.dependencies.blacklisted.values();
+            entry.messages = messages;
+            extractionCache.insert(filename, fingerprint, entry);
+        }
 
-    for (const QString &filename : filenames) {
         if (!CppFiles::isBlacklisted(filename)) {
-            if (const Translator *tor = CppFiles::getTranslator(filename)) {
-                for (const TranslatorMessage &msg : tor->messages())
-                    translator.extend(msg, cd);
-            }
+            for (const TranslatorMessage &msg : std::as_const(messages))
+                translator.extend(msg, cd);
         }
     }
 }
@@ -6,7 +6,9 @@
 
 #include "lupdate.h"
 
+#include <QtCore/QMutex>
 #include <QtCore/QSet>
+#include <QtCore/QWaitCondition>
 
 #include <iostream>
 
@@ -38,7 +40,7 @@ struct Namespace {
 
     Namespace() :
             classDef(this),
-            hasTrFunctions(false), complained(false)
+            hasTrFunctions(false)
     {}
     ~Namespace()
     {
@@ -65,7 +67,6 @@ struct Namespace {
     QString trQualification;
 
     bool hasTrFunctions;
-    bool complained; // ... that tr functions are missing.
 };
 
 struct ParseResults {
@@ -79,24 +80,52 @@ struct IncludeCycle {
     QSet<const ParseResults *> results;
 };
 
+// The files that went into parsing a file, for the extraction cache
+struct FileDependencies {
+    void unite(const FileDependencies &other)
+    {
+        fileNames.unite(other.fileNames);
+        blacklisted.unite(other.blacklisted);
+    }
+
+    QSet<QString> fileNames;
+    QSet<QString> blacklisted;
+};
+
 typedef QHash<QString, IncludeCycle *> IncludeCycleHash;
 typedef QHash<QString, const Translator *> TranslatorHash;
+typedef QHash<QString, FileDependencies> DependencyHash;
 
 class CppFiles {
 
 public:
+    enum ClaimResult { ParseFile, FileParsed, FileInIncludeCycle };
+
     static QSet<const ParseResults *> getResults(const QString &cleanFile);
     static void setResults(const QString &cleanFile, const ParseResults *results);
     static const Translator *getTranslator(const QString &cleanFile);
     static void setTranslator(const QString &cleanFile, const Translator *results);
     static bool isBlacklisted(const QString &cleanFile);
     static void setBlacklisted(const QString &cleanFile);
+    static FileDependencies getDependencies(const QString &cleanFile);
+    static void setDependencies(const QString &cleanFile, const FileDependencies &dependencies);
     static void addIncludeCycle(const QSet<QString> &fileNames);
+    static ClaimResult claimFile(const QString &cleanFile, QSet<const ParseResults *> *results);
+    static void releaseFile(const QString &cleanFile);
 
 private:
+    static void insertIncludeCycle(const QSet<QString> &fileNames);
+    static bool closesIncludeCycle(const QString &cleanFile, Qt::HANDLE thread);
+
+    static QMutex &mutex();
+    static QWaitCondition &fileReleased();
     static IncludeCycleHash &includeCycles();
     static TranslatorHash &translatedFiles();
     static QSet<QString> &blacklistedFiles();
+    static DependencyHash &fileDependencies();
+    static QHash<QString, Qt::HANDLE> &parsingFiles();
+    static QHash<Qt::HANDLE, QStringList> &parsingStacks();
+    static QHash<Qt::HANDLE, QString> &waitingThreads();
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,185 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "extractioncache.h"
+#include "lupdate.h"
+
+#include <translator.h>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+static const quint32 cacheMagic = 0x4c555843; // "LUXC"
+static const quint32 cacheVersion = 1;
+
+static void writeMessage(QDataStream &out, const TranslatorMessage &msg)
+{
+    out << msg.id() << msg.context() << msg.sourceText() << msg.oldSourceText()
+        << msg.comment() << msg.oldComment() << msg.userData() << msg.extras()
+        << msg.extraComment() << msg.translatorComment() << msg.warning()
+        << msg.translations() << msg.fileName() << qint32(msg.lineNumber())
+        << qint32(msg.type()) << msg.isPlural() << msg.warningOnly();
+    const TranslatorMessage::References refs = msg.extraReferences();
+    out << qint32(refs.size());
+    for (const TranslatorMessage::Reference &ref : refs)
+        out << ref.fileName() << qint32(ref.lineNumber());
+}
+
+static TranslatorMessage readMessage(QDataStream &in)
+{
+    QString id, context, sourceText, oldSourceText, comment, oldComment, userData;
+    TranslatorMessage::ExtraData extras;
+    QString extraComment, translatorComment, warning;
+    QStringList translations;
+    QString fileName;
+    qint32 lineNumber = -1, type = 0, refCount = 0;
+    bool plural = false, warningOnly = false;
+    in >> id >> context >> sourceText >> oldSourceText >> comment >> oldComment >> userData
+       >> extras >> extraComment >> translatorComment >> warning >> translations >> fileName
+       >> lineNumber >> type >> plural >> warningOnly >> refCount;
+
+    TranslatorMessage msg(context, sourceText, comment, userData, fileName, lineNumber,
+                          translations, TranslatorMessage::Type(type), plural);
+    msg.setId(id);
+    msg.setOldSourceText(oldSourceText);
+    msg.setOldComment(oldComment);
+    msg.setExtras(extras);
+    msg.setExtraComment(extraComment);
+    msg.setTranslatorComment(translatorComment);
+    msg.setWarning(warning);
+    msg.setWarningOnly(warningOnly);
+    for (qint32 i = 0; i < refCount && in.status() == QDataStream::Ok; ++i) {
+        QString refFileName;
+        qint32 refLineNumber = -1;
+        in >> refFileName >> refLineNumber;
+        msg.addReference(refFileName, refLineNumber);
+    }
+    return msg;
+}
+
+// Everything besides the contents of the files that affects what is extracted
+QByteArray ExtractionCache::fingerprint(const ConversionData &cd) const
+{
+    QStringList projectRoots(cd.m_projectRoots.cbegin(), cd.m_projectRoots.cend());
+    projectRoots.sort();
+    QList<std::pair<QString, QString>> cSources;
+    for (auto it = cd.m_allCSources.cbegin(); it != cd.m_allCSources.cend(); ++it)
+        cSources.append({ it.key(), it.value() });
+    std::sort(cSources.begin(), cSources.end());
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << QByteArray(QT_VERSION_STR) << cd.m_sourceIsUtf16 << cd.m_noUiLines
+        << cd.m_includePath << cd.m_excludes << projectRoots << cSources
+        << trFunctionAliasManager.listAliases();
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+QString ExtractionCache::entryPath(const QString &fileName, const QByteArray &fingerprint) const
+{
+    const QByteArray key = QCryptographicHash::hash(fingerprint + fileName.toUtf8(),
+                                                    QCryptographicHash::Sha1);
+    return m_cacheDir + QLatin1Char('/') + QString::fromLatin1(key.toHex());
+}
+
+// The hash of each file is computed once per run
+QByteArray ExtractionCache::fileHash(const QString &fileName)
+{
+    auto it = m_fileHashes.constFind(fileName);
+    if (it != m_fileHashes.cend())
+        return *it;
+
+    QByteArray hash;
+    QFile file(fileName);
+    if (file.open(QIODevice::ReadOnly))
+        hash = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+    m_fileHashes.insert(fileName, hash);
+    return hash;
+}
+
+bool ExtractionCache::find(const QString &fileName, const QByteArray &fingerprint, Entry *entry)
+{
+    if (!isEnabled())
+        return false;
+
+    QFile file(entryPath(fileName, fingerprint));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != cacheMagic || version != cacheVersion)
+        return false;
+
+    QByteArray recordedFingerprint;
+    QString recordedFileName;
+    QList<std::pair<QString, QByteArray>> hashes;
+    in >> recordedFingerprint >> recordedFileName >> hashes;
+    if (recordedFingerprint != fingerprint || recordedFileName != fileName)
+        return false;
+    for (const auto &[path, hash] : std::as_const(hashes)) {
+        if (hash.isEmpty() || fileHash(path) != hash)
+            return false;
+    }
+
+    Entry result;
+    qint32 count = 0;
+    in >> result.blacklisted >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+        result.messages.append(readMessage(in));
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    for (const auto &hash : std::as_const(hashes)) {
+        if (hash.first != fileName)
+            result.dependencies.append(hash.first);
+    }
+    *entry = result;
+    return true;
+}
+
+void ExtractionCache::insert(const QString &fileName, const QByteArray &fingerprint,
+                             const Entry &entry)
+{
+    if (!isEnabled())
+        return;
+
+    QList<std::pair<QString, QByteArray>> hashes;
+    hashes.append({ fileName, fileHash(fileName) });
+    for (const QString &path : entry.dependencies) {
+        if (path != fileName)
+            hashes.append({ path, fileHash(path) });
+    }
+    for (const auto &hash : std::as_const(hashes)) {
+        if (hash.second.isEmpty())
+            return;
+    }
+
+    if (!QDir().mkpath(m_cacheDir))
+        return;
+    QSaveFile file(entryPath(fileName, fingerprint));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << cacheMagic << cacheVersion << fingerprint << fileName << hashes << entry.blacklisted
+        << qint32(entry.messages.size());
+    for (const TranslatorMessage &msg : entry.messages)
+        writeMessage(out, msg);
+    if (out.status() == QDataStream::Ok)
+        file.commit();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,50 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef EXTRACTIONCACHE_H
+#define EXTRACTIONCACHE_H
+
+#include <translatormessage.h>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+
+QT_BEGIN_NAMESPACE
+
+class ConversionData;
+
+// Stores the messages extracted from each source file between lupdate runs,
+// keyed by the contents of the file and of the files it includes.
+class ExtractionCache
+{
+public:
+    struct Entry
+    {
+        QStringList dependencies;   // Files read besides the source file itself
+        QStringList blacklisted;    // C++ headers that the source file includes directly
+        QList<TranslatorMessage> messages;
+    };
+
+    void setCacheDir(const QString &cacheDir) { m_cacheDir = cacheDir; }
+    bool isEnabled() const { return !m_cacheDir.isEmpty(); }
+
+    QByteArray fingerprint(const ConversionData &cd) const;
+    bool find(const QString &fileName, const QByteArray &fingerprint, Entry *entry);
+    void insert(const QString &fileName, const QByteArray &fingerprint, const Entry &entry);
+
+private:
+    QString entryPath(const QString &fileName, const QByteArray &fingerprint) const;
+    QByteArray fileHash(const QString &fileName);
+
+    QString m_cacheDir;
+    QHash<QString, QByteArray> m_fileHashes;
+};
+
+QT_END_NAMESPACE
+
+extern QT_PREPEND_NAMESPACE(ExtractionCache) extractionCache;
+
+#endif // EXTRACTIONCACHE_H
@@ -41,7 +41,8 @@ Translator merge(
     const Translator &tor, const Translator &virginTor, const QList<Translator> &aliens,
     UpdateOptions options, QString &err);
 
-void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd);
+void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd,
+             int jobCount);
 bool loadJava(Translator &translator, const QString &filename, ConversionData &cd);
 bool loadPython(Translator &translator, const QString &fileName, ConversionData &cd);
 bool loadUI(Translator &translator, const QString &filename, ConversionData &cd);
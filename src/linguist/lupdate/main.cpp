@@ -6,7 +6,9 @@
 #if QT_CONFIG(clangcpp)
 #include "cpp_clang.h"
 #endif
+#include "extractioncache.h"
 
+#include <orderedjobs.h>
 #include <profileutils.h>
 #include <projectdescriptionreader.h>
 #include <qrcreader.h>
@@ -23,6 +25,8 @@
 #include <QtCore/QTranslator>
 
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 using namespace Qt::StringLiterals;
 
@@ -135,6 +139,7 @@ QStringList TrFunctionAliasManager::listAliases() const
 }
 
 TrFunctionAliasManager trFunctionAliasManager;
+ExtractionCache extractionCache;
 
 QString ParserTool::transcode(const QString &str)
 {
@@ -188,6 +193,7 @@ QString ParserTool::transcode(const QString &str)
 }
 
 static QString m_defaultExtensions;
+static int jobCount = 1;
 
 static void printOut(const QString & out)
 {
@@ -236,6 +242,12 @@ static void printUsage()
         "           Do not explain what is being done.\n"
         "    -no-sort\n"
         "           Do not sort contexts in TS files.\n"
+        "    -jobs <n>\n"
+        "           Parse C++ files and update TS files in up to <n> threads.\n"
+        "           Default: 1.\n"
+        "    -cache-dir <directory>\n"
+        "           Store the messages found in each source file in <directory>, and\n"
+        "           only look for messages in files that changed since the last run.\n"
         "    -no-recursive\n"
         "           Do not recursively scan directories.\n"
         "    -recursive\n"
@@ -334,6 +346,96 @@ static bool handleTrFunctionAliases(const QString &arg)
     return true;
 }
 
+struct TsFileUpdate : BufferedOutput
+{
+    QString fileName;
+    bool fail = false;
+};
+
+static void updateTsFile(const Translator &fetchedTor, const QList<Translator> &aliens,
+    const QString &sourceLanguage, const QString &targetLanguage,
+    UpdateOptions options, TsFileUpdate *update)
+{
+    const QString &fileName = update->fileName;
+    QString fn = QDir().relativeFilePath(fileName);
+    ConversionData cd;
+    Translator tor;
+    cd.m_sortContexts = !(options & NoSort);
+    if (QFile(fileName).exists()) {
+        if (!tor.load(fileName, cd, QLatin1String("auto"))) {
+            update->err(cd.error());
+            update->fail = true;
+            return;
+        }
+        tor.resolveDuplicates();
+        cd.clearErrors();
+        if (!targetLanguage.isEmpty() && targetLanguage != tor.languageCode())
+            update->err(QStringLiteral("lupdate warning: Specified target language '%1' disagrees with"
+                            " existing file's language '%2'. Ignoring.\n")
+                     .arg(targetLanguage, tor.languageCode()));
+        if (!sourceLanguage.isEmpty() && sourceLanguage != tor.sourceLanguageCode())
+            update->err(QStringLiteral("lupdate warning: Specified source language '%1' disagrees with"
+                            " existing file's language '%2'. Ignoring.\n")
+                     .arg(sourceLanguage, tor.sourceLanguageCode()));
+        // If there is translation in the file, the language should be recognized
+        // (when the language is not recognized, plural translations are lost)
+        if (tor.translationsExist()) {
+            QLocale::Language l;
+            QLocale::Territory c;
+            tor.languageAndTerritory(tor.languageCode(), &l, &c);
+            QStringList forms;
+            if (!getNumerusInfo(l, c, 0, &forms, 0)) {
+                update->err(QStringLiteral("File %1 won't be updated: it contains translation but the"
+                " target language is not recognized\n").arg(fileName));
+                return;
+            }
+        }
+    } else {
+        if (!targetLanguage.isEmpty())
+            tor.setLanguageCode(targetLanguage);
+        else
+            tor.setLanguageCode(Translator::guessLanguageCodeFromFileName(fileName));
+        if (!sourceLanguage.isEmpty())
+            tor.setSourceLanguageCode(sourceLanguage);
+    }
+    tor.makeFileNamesAbsolute(QFileInfo(fileName).absoluteDir());
+    if (options & NoLocations)
+        tor.setLocationsType(Translator::NoLocations);
+    else if (options & RelativeLocations)
+        tor.setLocationsType(Translator::RelativeLocations);
+    else if (options & AbsoluteLocations)
+        tor.setLocationsType(Translator::AbsoluteLocations);
+    if (options & Verbose)
+        update->out(QStringLiteral("Updating '%1'...\n").arg(fn));
+
+    UpdateOptions theseOptions = options;
+    if (tor.locationsType() == Translator::NoLocations) // Could be set from file
+        theseOptions |= NoLocations;
+    QString err;
+    Translator out = merge(tor, fetchedTor, aliens, theseOptions, err);
+
+    if ((options & Verbose) && !err.isEmpty())
+        update->out(err);
+    if (options & PluralOnly) {
+        if (options & Verbose)
+            update->out(QStringLiteral("Stripping non plural forms in '%1'...\n").arg(fn));
+        out.stripNonPluralForms();
+    }
+    if (options & NoObsolete)
+        out.stripObsoleteMessages();
+    out.stripEmptyContexts();
+
+    out.normalizeTranslations(cd);
+    if (!cd.errors().isEmpty()) {
+        update->err(cd.error());
+        cd.clearErrors();
+    }
+    if (!out.save(fileName, cd, QLatin1String("auto"))) {
+        update->err(cd.error());
+        update->fail = true;
+    }
+}
+
 static void updateTsFiles(const Translator &fetchedTor, const QStringList &tsFileNames,
     const QStringList &alienFiles,
     const QString &sourceLanguage, const QString &targetLanguage,
@@ -359,88 +461,31 @@ static void updateTsFiles(const Translator &fetchedTor, const QStringList &tsFil
         aliens << tor;
     }
 
-    QDir dir;
-    QString err;
-    for (const QString &fileName : tsFileNames) {
-        QString fn = dir.relativeFilePath(fileName);
-        ConversionData cd;
-        Translator tor;
-        cd.m_sortContexts = !(options & NoSort);
-        if (QFile(fileName).exists()) {
-            if (!tor.load(fileName, cd, QLatin1String("auto"))) {
-                printErr(cd.error());
-                *fail = true;
-                continue;
-            }
-            tor.resolveDuplicates();
-            cd.clearErrors();
-            if (!targetLanguage.isEmpty() && targetLanguage != tor.languageCode())
-                printErr(QStringLiteral("lupdate warning: Specified target language '%1' disagrees with"
-                                " existing file's language '%2'. Ignoring.\n")
-                         .arg(targetLanguage, tor.languageCode()));
-            if (!sourceLanguage.isEmpty() && sourceLanguage != tor.sourceLanguageCode())
-                printErr(QStringLiteral("lupdate warning: Specified source language '%1' disagrees with"
-                                " existing file's language '%2'. Ignoring.\n")
-                         .arg(sourceLanguage, tor.sourceLanguageCode()));
-            // If there is translation in the file, the language should be recognized
-            // (when the language is not recognized, plural translations are lost)
-            if (tor.translationsExist()) {
-                QLocale::Language l;
-                QLocale::Territory c;
-                tor.languageAndTerritory(tor.languageCode(), &l, &c);
-                QStringList forms;
-                if (!getNumerusInfo(l, c, 0, &forms, 0)) {
-                    printErr(QStringLiteral("File %1 won't be updated: it contains translation but the"
-                    " target language is not recognized\n").arg(fileName));
-                    continue;
-                }
-            }
-        } else {
-            if (!targetLanguage.isEmpty())
-                tor.setLanguageCode(targetLanguage);
-            else
-                tor.setLanguageCode(Translator::guessLanguageCodeFromFileName(fileName));
-            if (!sourceLanguage.isEmpty())
-                tor.setSourceLanguageCode(sourceLanguage);
-        }
-        tor.makeFileNamesAbsolute(QFileInfo(fileName).absoluteDir());
-        if (options & NoLocations)
-            tor.setLocationsType(Translator::NoLocations);
-        else if (options & RelativeLocations)
-            tor.setLocationsType(Translator::RelativeLocations);
-        else if (options & AbsoluteLocations)
-            tor.setLocationsType(Translator::AbsoluteLocations);
-        if (options & Verbose)
-            printOut(QStringLiteral("Updating '%1'...\n").arg(fn));
-
-        UpdateOptions theseOptions = options;
-        if (tor.locationsType() == Translator::NoLocations) // Could be set from file
-            theseOptions |= NoLocations;
-        Translator out = merge(tor, fetchedTor, aliens, theseOptions, err);
-
-        if ((options & Verbose) && !err.isEmpty()) {
-            printOut(err);
-            err.clear();
-        }
-        if (options & PluralOnly) {
-            if (options & Verbose)
-                printOut(QStringLiteral("Stripping non plural forms in '%1'...\n").arg(fn));
-            out.stripNonPluralForms();
-        }
-        if (options & NoObsolete)
-            out.stripObsoleteMessages();
-        out.stripEmptyContexts();
-
-        out.normalizeTranslations(cd);
-        if (!cd.errors().isEmpty()) {
-            printErr(cd.error());
-            cd.clearErrors();
-        }
-        if (!out.save(fileName, cd, QLatin1String("auto"))) {
-            printErr(cd.error());
-            *fail = true;
-        }
-    }
+    std::vector<TsFileUpdate> updates(tsFileNames.size());
+    for (qsizetype i = 0; i < tsFileNames.size(); ++i)
+        updates[i].fileName = tsFileNames.at(i);
+
+    // Each TS file is loaded, merged and saved on its own. The jobs only
+    // read fetchedTor and the aliens, and the output of every file is
+    // printed in the order of the files on the command line. A TS file
+    // that is listed twice makes them be updated one at a time.
+    QStringList uniqueFileNames = tsFileNames;
+    uniqueFileNames.removeDuplicates();
+    const int updateJobCount = uniqueFileNames.size() == tsFileNames.size() ? jobCount : 1;
+    if (updateJobCount > 1)
+        fetchedTor.buildIndexes();
+    runOrderedJobs(
+            updates.size(), updateJobCount,
+            [&](size_t i) {
+                updateTsFile(fetchedTor, aliens, sourceLanguage, targetLanguage, options,
+                             &updates[i]);
+            },
+            [&](size_t i) {
+                updates[i].print(printOut, printErr);
+                if (updates[i].fail)
+                    *fail = true;
+                return true;
+            });
 }
 
 static bool readFileContent(const QString &filePath, QByteArray *content, QString *errorString)
@@ -525,25 +570,57 @@ static bool processTs(Translator &fetchedTor, const QString &file, ConversionDat
     return false;
 }
 
+typedef bool (*SourceLoader)(Translator &, const QString &, ConversionData &);
+
+// Files whose loading printed or reported anything are loaded again by the
+// next run, so that the messages are repeated.
+static void loadSource(SourceLoader load, Translator &fetchedTor, const QString &sourceFile,
+                       ConversionData &cd, const QByteArray &fingerprint)
+{
+    if (!extractionCache.isEnabled()) {
+        load(fetchedTor, sourceFile, cd);
+        return;
+    }
+
+    ExtractionCache::Entry entry;
+    if (!extractionCache.find(sourceFile, fingerprint, &entry)) {
+        Translator tor;
+        const qsizetype errorCount = cd.errors().size();
+        std::ostringstream messages;
+        std::streambuf *cerrBuffer = std::cerr.rdbuf(messages.rdbuf());
+        load(tor, sourceFile, cd);
+        std::cerr.rdbuf(cerrBuffer);
+        std::cerr << messages.str();
+
+        entry.messages = tor.messages();
+        if (messages.str().empty() && cd.errors().size() == errorCount)
+            extractionCache.insert(sourceFile, fingerprint, entry);
+    }
+    for (const TranslatorMessage &msg : std::as_const(entry.messages))
+        fetchedTor.extend(msg, cd);
+}
+
 static void processSources(Translator &fetchedTor,
                            const QStringList &sourceFiles, ConversionData &cd, bool *fail)
 {
 #ifdef QT_NO_QML
     bool requireQmlSupport = false;
 #endif
+    const QByteArray fingerprint =
+            extractionCache.isEnabled() ? extractionCache.fingerprint(cd) : QByteArray();
     QStringList sourceFilesCpp;
     for (const auto &sourceFile : sourceFiles) {
         if (sourceFile.endsWith(QLatin1String(".java"), Qt::CaseInsensitive))
-            loadJava(fetchedTor, sourceFile, cd);
+            loadSource(loadJava, fetchedTor, sourceFile, cd, fingerprint);
         else if (sourceFile.endsWith(QLatin1String(".ui"), Qt::CaseInsensitive)
                  || sourceFile.endsWith(QLatin1String(".jui"), Qt::CaseInsensitive))
-            loadUI(fetchedTor, sourceFile, cd);
+            loadSource(loadUI, fetchedTor, sourceFile, cd, fingerprint);
 #ifndef QT_NO_QML
         else if (sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
                  || sourceFile.endsWith(QLatin1String(".qs"), Qt::CaseInsensitive))
-            loadQScript(fetchedTor, sourceFile, cd);
+            loadSource(loadQScript, fetchedTor, sourceFile, cd, fingerprint);
         else if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive))
-            loadQml(fetchedTor, sourceFile, cd);
+            loadSource(loadQml, fetchedTor, sourceFile, cd, fingerprint);
 #else
         else if (sourceFile.endsWith(QLatin1String(".qml"), Qt::CaseInsensitive)
                  || sourceFile.endsWith(QLatin1String(".js"), Qt::CaseInsensitive)
@@ -551,7 +628,7 @@ static void processSources(Translator &fetchedTor,
             requireQmlSupport = true;
 #endif // QT_NO_QML
         else if (sourceFile.endsWith(u".py", Qt::CaseInsensitive))
-            loadPython(fetchedTor, sourceFile, cd);
+            loadSource(loadPython, fetchedTor, sourceFile, cd, fingerprint);
         else if (!processTs(fetchedTor, sourceFile, cd))
             sourceFilesCpp << sourceFile;
     }
@@ -570,7 +647,7 @@ static void processSources(Translator &fetchedTor,
 #endif
     }
     else
-        loadCPP(fetchedTor, sourceFilesCpp, cd);
+        loadCPP(fetchedTor, sourceFilesCpp, cd, jobCount);
 
     if (!cd.error().isEmpty())
         printErr(cd.error());
@@ -837,6 +914,24 @@ int main(int argc, char **argv)
                    || arg == QLatin1String("-nosort")) {
             options |= NoSort;
             continue;
+        } else if (arg == QLatin1String("-jobs")) {
+            ++i;
+            bool ok = false;
+            if (i < argc)
+                jobCount = args[i].toInt(&ok);
+            if (!ok || jobCount < 1) {
+                printErr(u"The option -jobs requires a positive number of jobs.\n"_s);
+                return 1;
+            }
+            continue;
+        } else if (arg == QLatin1String("-cache-dir")) {
+            ++i;
+            if (i == argc) {
+                printErr(u"The option -cache-dir requires a parameter.\n"_s);
+                return 1;
+            }
+            extractionCache.setCacheDir(args[i]);
+            continue;
         } else if (arg == QLatin1String("-version")) {
             printOut(QStringLiteral("lupdate version %1\n").arg(QLatin1String(QT_VERSION_STR)));
             return 0;
@@ -14,6 +14,7 @@
 #include <cerrno>
 #include <cstdio>
 #include <cstring>
+#include <iostream>
 
 QT_BEGIN_NAMESPACE
 
@@ -260,8 +261,7 @@ static Token parseString(StringType stringType = StringType::NoString)
     if (yyCh != quoteChar) {
         printf("%c\n", yyCh);
 
-        qWarning("%s:%d: Unterminated string",
-                 qPrintable(yyFileName), yyLineNo);
+        std::cerr << qPrintable(yyFileName) << ':' << yyLineNo << ": Unterminated string\n";
     }
 
     if (yyCh == EOF)
@@ -722,8 +722,7 @@ static void parse(Translator &tor, ConversionData &cd,
     }
 
     if (yyParenDepth != 0) {
-        qWarning("%s: Unbalanced parentheses in Python code",
-                 qPrintable(yyFileName));
+        std::cerr << qPrintable(yyFileName) << ": Unbalanced parentheses in Python code\n";
     }
 }
 
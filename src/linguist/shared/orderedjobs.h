@@ -0,0 +1,90 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef ORDEREDJOBS_H
+#define ORDEREDJOBS_H
+
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+// Collects the messages printed while working on one job, so that the
+// output of jobs running at the same time is not interleaved.
+class BufferedOutput
+{
+public:
+    void out(const QString &msg) { m_messages.append({ false, msg }); }
+    void err(const QString &msg) { m_messages.append({ true, msg }); }
+
+    template<typename PrintOut, typename PrintErr>
+    void print(PrintOut printOut, PrintErr printErr) const
+    {
+        for (const auto &[isError, msg] : m_messages) {
+            if (isError)
+                printErr(msg);
+            else
+                printOut(msg);
+        }
+    }
+
+private:
+    QList<std::pair<bool, QString>> m_messages; // true for errors
+};
+
+// Calls run(i) for every i in [0, count) on up to jobCount threads, and
+// finish(i) on the calling thread in increasing order of i, as soon as job i
+// is done. Once finish() returns false, no further jobs are started or
+// finished, and false is returned.
+template<typename Run, typename Finish>
+bool runOrderedJobs(size_t count, int jobCount, Run run, Finish finish)
+{
+    const size_t workerCount = std::min(count, size_t(std::max(1, jobCount)));
+    if (workerCount <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            run(i);
+            if (!finish(i))
+                return false;
+        }
+        return true;
+    }
+
+    std::vector<std::promise<void>> done(count);
+    std::atomic<size_t> next = 0;
+    std::atomic<bool> stopped = false;
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (size_t t = 0; t < workerCount; ++t) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < count; i = next++) {
+                if (!stopped)
+                    run(i);
+                done[i].set_value();
+            }
+        });
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < count; ++i) {
+        done[i].get_future().wait();
+        if (!finish(i)) {
+            stopped = true;
+            ok = false;
+            break;
+        }
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+    return ok;
+}
+
+QT_END_NAMESPACE
+
+#endif // ORDEREDJOBS_H
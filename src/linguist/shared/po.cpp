@@ -4,6 +4,7 @@
 #include "translator.h"
 
 #include <QtCore/QDebug>
+#include <QtCore/QFileDevice>
 #include <QtCore/QIODevice>
 #include <QtCore/QHash>
 #include <QtCore/QRegularExpression>
@@ -12,6 +13,7 @@
 #include <QtCore/QTextStream>
 
 #include <ctype.h>
+#include <string.h>
 
 // Uncomment if you wish to hard wrap long lines in .po files. Note that this
 // affects only msg strings, not comments.
@@ -180,22 +182,124 @@ public:
     QHash<QString, QString> extra;
 };
 
+// Reads the trimmed lines of a PO file one by one, with one line of
+// lookahead. Files are mapped into memory if possible, in which case
+// the lines refer to the mapped data instead of being copied.
+class PoLineReader
+{
+public:
+    explicit PoLineReader(QIODevice &dev);
+    ~PoLineReader();
+
+    const QByteArray &line() const { return m_line; }
+    int lineNumber() const { return m_lineNumber; }
+    // The line after the current one, or an empty line at the end
+    const QByteArray &peek() const { return m_next; }
+    bool advance();
+
+    // The lines read so far, as long as lines are kept
+    const QList<QByteArray> &keptLines() const { return m_keptLines; }
+    void stopKeepingLines() { m_keepLines = false; m_keptLines.clear(); }
+
+private:
+    bool readLine(QByteArray *line);
+
+    QIODevice &m_dev;
+    QFileDevice *m_file = nullptr;
+    uchar *m_map = nullptr;
+    qint64 m_mapSize = 0;
+    qint64 m_mapPos = 0;
+    QByteArray m_line;
+    QByteArray m_next;
+    bool m_hasNext = false;
+    int m_lineNumber = -1;
+    bool m_keepLines = true;
+    QList<QByteArray> m_keptLines;
+};
+
+PoLineReader::PoLineReader(QIODevice &dev) : m_dev(dev)
+{
+    m_file = qobject_cast<QFileDevice *>(&dev);
+    if (m_file && !m_file->isSequential()) {
+        m_mapPos = m_file->pos();
+        m_mapSize = m_file->size() - m_mapPos;
+        if (m_mapSize > 0)
+            m_map = m_file->map(m_mapPos, m_mapSize);
+        m_mapPos = 0;
+    }
+    m_hasNext = readLine(&m_next);
+}
+
+PoLineReader::~PoLineReader()
+{
+    if (m_map)
+        m_file->unmap(m_map);
+}
+
+bool PoLineReader::readLine(QByteArray *line)
+{
+    if (!m_map) {
+        if (m_dev.atEnd()) {
+            line->clear();
+            return false;
+        }
+        *line = m_dev.readLine().trimmed();
+        return true;
+    }
+
+    if (m_mapPos == m_mapSize) {
+        line->clear();
+        return false;
+    }
+    const char *begin = reinterpret_cast<const char *>(m_map) + m_mapPos;
+    const char *end = static_cast<const char *>(memchr(begin, '\n', m_mapSize - m_mapPos));
+    if (end) {
+        m_mapPos += end - begin + 1;
+    } else {
+        end = begin + (m_mapSize - m_mapPos);
+        m_mapPos = m_mapSize;
+    }
+    const QByteArrayView trimmed = QByteArrayView(begin, end).trimmed();
+    *line = QByteArray::fromRawData(trimmed.data(), trimmed.size());
+    return true;
+}
+
+bool PoLineReader::advance()
+{
+    if (!m_hasNext)
+        return false;
+    m_line = m_next;
+    ++m_lineNumber;
+    if (m_keepLines)
+        m_keptLines.append(m_line);
+    m_hasNext = readLine(&m_next);
+    return true;
+}
 
 static bool isTranslationLine(const QByteArray &line)
 {
     return line.startsWith("#~ msgstr") || line.startsWith("msgstr");
 }
 
-static QByteArray slurpEscapedString(const QList<QByteArray> &lines, int &l,
+// Returns whether the line continues a string that started on a line before
+static bool isContinuationLine(const QByteArray &line, const QByteArray &prefix)
+{
+    if (line.isEmpty() || !line.startsWith(prefix))
+        return false;
+    int offset = prefix.size();
+    while (isspace(line[offset])) // No length check, as string has no trailing spaces.
+        offset++;
+    return line[offset] == '"';
+}
+
+static QByteArray slurpEscapedString(PoLineReader &reader,
         int offset, const QByteArray &prefix, ConversionData &cd)
 {
     QByteArray msg;
     int stoff;
 
-    for (; l < lines.size(); ++l) {
-        const QByteArray &line = lines.at(l);
-        if (line.isEmpty() || !line.startsWith(prefix))
-            break;
+    forever {
+        const QByteArray &line = reader.line();
         while (isspace(line[offset])) // No length check, as string has no trailing spaces.
             offset++;
         if (line[offset] != '"')
@@ -213,7 +317,7 @@ static QByteArray slurpEscapedString(const QList<QByteArray> &lines, int &l,
                 if (line[offset++] != '"') {
                     cd.appendError(QString::fromLatin1(
                             "PO parsing error: extra characters on line %1.")
-                            .arg(l + 1));
+                            .arg(reader.lineNumber() + 1));
                     break;
                 }
                 continue;
@@ -274,7 +378,7 @@ static QByteArray slurpEscapedString(const QList<QByteArray> &lines, int &l,
                 default:
                     cd.appendError(QString::fromLatin1(
                             "PO parsing error: invalid escape '\\%1' (line %2).")
-                            .arg(QChar((uint)c)).arg(l + 1));
+                            .arg(QChar((uint)c)).arg(reader.lineNumber() + 1));
                     msg += '\\';
                     msg += c;
                     break;
@@ -283,40 +387,39 @@ static QByteArray slurpEscapedString(const QList<QByteArray> &lines, int &l,
                 msg += c;
             }
         }
+        if (!isContinuationLine(reader.peek(), prefix))
+            break;
+        reader.advance();
         offset = prefix.size();
     }
-    --l;
     return msg;
 
 premature_eol:
     cd.appendError(QString::fromLatin1(
-            "PO parsing error: premature end of line %1.").arg(l + 1));
+            "PO parsing error: premature end of line %1.").arg(reader.lineNumber() + 1));
     return QByteArray();
 }
 
-static void slurpComment(QByteArray &msg, const QList<QByteArray> &lines, int & l)
+static void slurpComment(QByteArray &msg, PoLineReader &reader)
 {
-    int firstLine = l;
-    QByteArray prefix = lines.at(l);
-    for (int i = 1; ; i++) {
-        if (prefix.at(i) != ' ') {
-            prefix.truncate(i);
-            break;
-        }
-    }
-    for (; l < lines.size(); ++l) {
-        const QByteArray &line = lines.at(l);
-        if (line.startsWith(prefix)) {
-            if (l > firstLine)
-                msg += '\n';
-            msg += line.mid(prefix.size());
-        } else if (line == "#") {
+    const QByteArray &line = reader.line();
+    int prefixSize = 1;
+    while (line.at(prefixSize) == ' ')
+        prefixSize++;
+    const QByteArray prefix = line.left(prefixSize);
+    msg.append(QByteArrayView(line).sliced(prefixSize));
+    forever {
+        const QByteArray &next = reader.peek();
+        if (next.startsWith(prefix)) {
+            msg += '\n';
+            msg.append(QByteArrayView(next).sliced(prefixSize));
+        } else if (next == "#") {
             msg += '\n';
         } else {
             break;
         }
+        reader.advance();
     }
-    --l;
 }
 
 static void splitContext(QByteArray *comment, QByteArray *context)
@@ -394,16 +497,13 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
     // ...
 
     // we need line based lookahead below.
-    QList<QByteArray> lines;
-    while (!dev.atEnd())
-        lines.append(dev.readLine().trimmed());
-    lines.append(QByteArray());
+    PoLineReader reader(dev);
 
-    int l = 0, lastCmtLine = -1;
+    int lastCmtLine = -1;
     bool qtContexts = false;
     PoItem item;
-    for (; l != lines.size(); ++l) {
-        QByteArray line = lines.at(l);
+    while (reader.advance()) {
+        QByteArray line = reader.line();
         if (line.isEmpty())
            continue;
         if (isTranslationLine(line)) {
@@ -411,12 +511,12 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
             const QByteArray prefix = isObsolete ? "#~ " : "";
             while (true) {
                 int idx = line.indexOf(' ', prefix.size());
-                QByteArray str = slurpEscapedString(lines, l, idx, prefix, cd);
+                QByteArray str = slurpEscapedString(reader, idx, prefix, cd);
                 item.msgStr.append(str);
-                if (l + 1 >= lines.size() || !isTranslationLine(lines.at(l + 1)))
+                if (!isTranslationLine(reader.peek()))
                     break;
-                ++l;
-                line = lines.at(l);
+                reader.advance();
+                line = reader.line();
             }
             if (item.msgId.isEmpty()) {
                 QHash<QString, QByteArray> extras;
@@ -507,21 +607,25 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
               doneho:
                 if (lastCmtLine != -1) {
                     extras[QLatin1String("po-header_comment")] =
-                            QByteArrayList_join(lines.mid(0, lastCmtLine + 1), '\n');
+                            QByteArrayList_join(reader.keptLines().mid(0, lastCmtLine + 1), '\n');
                 }
                 for (auto it = extras.cbegin(), end = extras.cend(); it != end; ++it)
                     translator.setExtra(it.key(), toUnicode(it.value()));
+                reader.stopKeepingLines();
                 item = PoItem();
                 continue;
             }
+            // Only the comment before the header is kept
+            reader.stopKeepingLines();
             // build translator message
             TranslatorMessage msg;
             msg.setContext(toUnicode(item.context));
             if (!item.references.isEmpty()) {
+                static const QRegularExpression whitespace(QLatin1String("\\s"));
                 QString xrefs;
                 for (const QString &ref :
                          QString(toUnicode(item.references)).split(
-                                 QRegularExpression(QLatin1String("\\s")), Qt::SkipEmptyParts)) {
+                                 whitespace, Qt::SkipEmptyParts)) {
                     int pos = ref.indexOf(QLatin1Char(':'));
                     int lpos = ref.lastIndexOf(QLatin1Char(':'));
                     if (pos != -1 && pos == lpos) {
@@ -578,9 +682,10 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
                     item.references += '\n';
                     break;
                 case ',': {
+                    static const QRegularExpression flagSeparators(QLatin1String("[, ]"));
                     QStringList flags =
                             QString::fromLatin1(line.mid(2)).split(
-                                    QRegularExpression(QLatin1String("[, ]")), Qt::SkipEmptyParts);
+                                    flagSeparators, Qt::SkipEmptyParts);
                     if (flags.removeOne(QLatin1String("fuzzy")))
                         item.isFuzzy = true;
                     flags.removeOne(QLatin1String("qt-format"));
@@ -595,7 +700,7 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
                     item.translatorComments += '\n';
                     break;
                 case ' ':
-                    slurpComment(item.translatorComments, lines, l);
+                    slurpComment(item.translatorComments, reader);
                     break;
                 case '.':
                     if (line.startsWith("#. ts-context ")) { // legacy
@@ -609,73 +714,73 @@ bool loadPO(Translator &translator, QIODevice &dev, ConversionData &cd)
                     break;
                 case '|':
                     if (line.startsWith("#| msgid ")) {
-                        item.oldMsgId = slurpEscapedString(lines, l, 9, "#| ", cd);
+                        item.oldMsgId = slurpEscapedString(reader, 9, "#| ", cd);
                     } else if (line.startsWith("#| msgid_plural ")) {
-                        QByteArray extra = slurpEscapedString(lines, l, 16, "#| ", cd);
+                        QByteArray extra = slurpEscapedString(reader, 16, "#| ", cd);
                         if (extra != item.oldMsgId)
                             item.extra[QLatin1String("po-old_msgid_plural")] =
                                     toUnicode(extra);
                     } else if (line.startsWith("#| msgctxt ")) {
-                        item.oldTscomment = slurpEscapedString(lines, l, 11, "#| ", cd);
+                        item.oldTscomment = slurpEscapedString(reader, 11, "#| ", cd);
                         if (qtContexts)
                             splitContext(&item.oldTscomment, &item.context);
                     } else {
                         cd.appendError(QString(QLatin1String("PO-format parse error in line %1: '%2'"))
-                            .arg(l + 1).arg(toUnicode(lines[l])));
+                            .arg(reader.lineNumber() + 1).arg(toUnicode(reader.line())));
                         error = true;
                     }
                     break;
                 case '~':
                     if (line.startsWith("#~ msgid ")) {
-                        item.msgId = slurpEscapedString(lines, l, 9, "#~ ", cd);
+                        item.msgId = slurpEscapedString(reader, 9, "#~ ", cd);
                     } else if (line.startsWith("#~ msgid_plural ")) {
-                        QByteArray extra = slurpEscapedString(lines, l, 16, "#~ ", cd);
+                        QByteArray extra = slurpEscapedString(reader, 16, "#~ ", cd);
                         if (extra != item.msgId)
                             item.extra[QLatin1String("po-msgid_plural")] =
                                     toUnicode(extra);
                         item.isPlural = true;
                     } else if (line.startsWith("#~ msgctxt ")) {
-                        item.tscomment = slurpEscapedString(lines, l, 11, "#~ ", cd);
+                        item.tscomment = slurpEscapedString(reader, 11, "#~ ", cd);
                         if (qtContexts)
                             splitContext(&item.tscomment, &item.context);
                     } else if (line.startsWith("#~| msgid ")) {
-                        item.oldMsgId = slurpEscapedString(lines, l, 10, "#~| ", cd);
+                        item.oldMsgId = slurpEscapedString(reader, 10, "#~| ", cd);
                     } else if (line.startsWith("#~| msgid_plural ")) {
-                        QByteArray extra = slurpEscapedString(lines, l, 17, "#~| ", cd);
+                        QByteArray extra = slurpEscapedString(reader, 17, "#~| ", cd);
                         if (extra != item.oldMsgId)
                             item.extra[QLatin1String("po-old_msgid_plural")] =
                                     toUnicode(extra);
                     } else if (line.startsWith("#~| msgctxt ")) {
-                        item.oldTscomment = slurpEscapedString(lines, l, 12, "#~| ", cd);
+                        item.oldTscomment = slurpEscapedString(reader, 12, "#~| ", cd);
                         if (qtContexts)
                             splitContext(&item.oldTscomment, &item.context);
                     } else {
                         cd.appendError(QString(QLatin1String("PO-format parse error in line %1: '%2'"))
-                            .arg(l + 1).arg(toUnicode(lines[l])));
+                            .arg(reader.lineNumber() + 1).arg(toUnicode(reader.line())));
                         error = true;
                     }
                     break;
                 default:
                     cd.appendError(QString(QLatin1String("PO-format parse error in line %1: '%2'"))
-                        .arg(l + 1).arg(toUnicode(lines[l])));
+                        .arg(reader.lineNumber() + 1).arg(toUnicode(reader.line())));
                     error = true;
                     break;
             }
-            lastCmtLine = l;
+            lastCmtLine = reader.lineNumber();
         } else if (line.startsWith("msgctxt ")) {
-            item.tscomment = slurpEscapedString(lines, l, 8, QByteArray(), cd);
+            item.tscomment = slurpEscapedString(reader, 8, QByteArray(), cd);
             if (qtContexts)
                 splitContext(&item.tscomment, &item.context);
         } else if (line.startsWith("msgid ")) {
-            item.msgId = slurpEscapedString(lines, l, 6, QByteArray(), cd);
+            item.msgId = slurpEscapedString(reader, 6, QByteArray(), cd);
         } else if (line.startsWith("msgid_plural ")) {
-            QByteArray extra = slurpEscapedString(lines, l, 13, QByteArray(), cd);
+            QByteArray extra = slurpEscapedString(reader, 13, QByteArray(), cd);
             if (extra != item.msgId)
                 item.extra[QLatin1String("po-msgid_plural")] = toUnicode(extra);
             item.isPlural = true;
         } else {
             cd.appendError(QString(QLatin1String("PO-format error in line %1: '%2'"))
-                .arg(l + 1).arg(toUnicode(lines[l])));
+                .arg(reader.lineNumber() + 1).arg(toUnicode(reader.line())));
             error = true;
         }
     }
@@ -11,10 +11,12 @@
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
-#include <QtCore/QMap>
+#include <QtCore/QSet>
 #include <QtCore/QString>
 #include <QtCore/QStringDecoder>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 // magic number for the file
@@ -49,19 +51,23 @@ enum Prefix {
 
 } // namespace anon
 
-static uint elfHash(const QByteArray &ba)
+// Hashes the concatenation of first and second, up to the first '\0'
+static uint elfHash(QByteArrayView first, QByteArrayView second = QByteArrayView())
 {
-    const uchar *k = (const uchar *)ba.data();
     uint h = 0;
     uint g;
 
-    if (k) {
-        while (*k) {
-            h = (h << 4) + *k++;
+    for (QByteArrayView part : { first, second }) {
+        const qsizetype length = qsizetype(qstrnlen(part.data(), size_t(part.size())));
+        const uchar *k = reinterpret_cast<const uchar *>(part.data());
+        for (qsizetype i = 0; i < length; ++i) {
+            h = (h << 4) + k[i];
             if ((g = (h & 0xf0000000)) != 0)
                 h ^= g >> 24;
             h &= ~g;
         }
+        if (length < part.size())
+            break;
     }
     if (!h)
         h = 1;
@@ -86,6 +92,11 @@ public:
     const QByteArray &comment() const { return m_comment; }
     const QStringList &translations() const { return m_translations; }
     bool operator<(const ByteTranslatorMessage& m) const;
+    bool operator==(const ByteTranslatorMessage &m) const
+    {
+        return m_context == m.m_context && m_sourcetext == m.m_sourcetext
+                && m_comment == m.m_comment;
+    }
 
 private:
     QByteArray m_context;
@@ -147,7 +158,8 @@ private:
     // on turn should be the same as passed to the actual tr(...) calls
     QByteArray originalBytes(const QString &str) const;
 
-    static Prefix commonPrefix(const ByteTranslatorMessage &m1, const ByteTranslatorMessage &m2);
+    static Prefix commonPrefix(const ByteTranslatorMessage &m1, uint h1,
+                               const ByteTranslatorMessage &m2, uint h2);
 
     static uint msgHash(const ByteTranslatorMessage &msg);
 
@@ -159,7 +171,10 @@ private:
     QByteArray m_messageArray;
     QByteArray m_offsetArray;
     QByteArray m_contextArray;
-    QMap<ByteTranslatorMessage, void *> m_messages;
+    // The messages in the order of insertion until squeeze() sorts them
+    QList<ByteTranslatorMessage> m_messages;
+    // The contexts and source texts of the messages without comment
+    QSet<std::pair<QByteArray, QByteArray>> m_uncommented;
     QByteArray m_numerusRules;
     QStringList m_dependencies;
     QByteArray m_dependencyArray;
@@ -177,12 +192,13 @@ QByteArray Releaser::originalBytes(const QString &str) const
 
 uint Releaser::msgHash(const ByteTranslatorMessage &msg)
 {
-    return elfHash(msg.sourceText() + msg.comment());
+    return elfHash(msg.sourceText(), msg.comment());
 }
 
-Prefix Releaser::commonPrefix(const ByteTranslatorMessage &m1, const ByteTranslatorMessage &m2)
+Prefix Releaser::commonPrefix(const ByteTranslatorMessage &m1, uint h1,
+                              const ByteTranslatorMessage &m2, uint h2)
 {
-    if (msgHash(m1) != msgHash(m2))
+    if (h1 != h2)
         return NoPrefix;
     if (m1.context() != m2.context())
         return Hash;
@@ -269,53 +285,68 @@ void Releaser::squeeze(TranslatorSaveMode mode)
     if (m_messages.isEmpty() && mode == SaveEverything)
         return;
 
-    const auto messages = m_messages;
+    // Of equal messages, the one inserted first is kept
+    QList<ByteTranslatorMessage> messages = std::move(m_messages);
+    std::stable_sort(messages.begin(), messages.end());
+    messages.erase(std::unique(messages.begin(), messages.end()), messages.end());
 
     // re-build contents
     m_messageArray.clear();
     m_offsetArray.clear();
     m_contextArray.clear();
     m_messages.clear();
+    m_uncommented.clear();
+
+    QList<uint> hashes;
+    hashes.reserve(messages.size());
+    for (const ByteTranslatorMessage &msg : std::as_const(messages))
+        hashes.append(msgHash(msg));
 
-    QMap<Offset, void *> offsets;
+    QList<Offset> offsets;
+    offsets.reserve(messages.size());
 
     QDataStream ms(&m_messageArray, QIODevice::WriteOnly);
     int cpPrev = 0, cpNext = 0;
-    for (auto it = messages.cbegin(), end = messages.cend(); it != end; ++it) {
+    for (qsizetype i = 0; i < messages.size(); ++i) {
         cpPrev = cpNext;
-        const auto next = std::next(it);
-        if (next == end)
+        if (i + 1 == messages.size())
             cpNext = 0;
         else
-            cpNext = commonPrefix(it.key(), next.key());
-        offsets.insert(Offset(msgHash(it.key()), ms.device()->pos()), (void *)0);
-        writeMessage(it.key(), ms, mode, Prefix(qMax(cpPrev, cpNext + 1)));
+            cpNext = commonPrefix(messages.at(i), hashes.at(i), messages.at(i + 1), hashes.at(i + 1));
+        offsets.append(Offset(hashes.at(i), ms.device()->pos()));
+        writeMessage(messages.at(i), ms, mode, Prefix(qMax(cpPrev, cpNext + 1)));
     }
 
-    auto offset = offsets.cbegin();
+    std::sort(offsets.begin(), offsets.end());
     QDataStream ds(&m_offsetArray, QIODevice::WriteOnly);
-    while (offset != offsets.cend()) {
-        Offset k = offset.key();
-        ++offset;
+    for (const Offset &k : std::as_const(offsets))
         ds << quint32(k.h) << quint32(k.o);
-    }
 
     if (mode == SaveStripped) {
-        QMap<QByteArray, int> contextSet;
-        for (auto it = messages.cbegin(), end = messages.cend(); it != end; ++it)
-            ++contextSet[it.key().context()];
+        // The messages are sorted by context
+        QList<QByteArray> contexts;
+        for (const ByteTranslatorMessage &msg : std::as_const(messages)) {
+            if (contexts.isEmpty() || contexts.constLast() != msg.context())
+                contexts.append(msg.context());
+        }
 
         quint16 hTableSize;
-        if (contextSet.size() < 200)
-            hTableSize = (contextSet.size() < 60) ? 151 : 503;
-        else if (contextSet.size() < 2500)
-            hTableSize = (contextSet.size() < 750) ? 1511 : 5003;
+        if (contexts.size() < 200)
+            hTableSize = (contexts.size() < 60) ? 151 : 503;
+        else if (contexts.size() < 2500)
+            hTableSize = (contexts.size() < 750) ? 1511 : 5003;
         else
-            hTableSize = (contextSet.size() < 10000) ? 15013 : 3 * contextSet.size() / 2;
-
-        QMultiMap<int, QByteArray> hashMap;
-        for (auto c = contextSet.cbegin(), end = contextSet.cend(); c != end; ++c)
-            hashMap.insert(elfHash(c.key()) % hTableSize, c.key());
+            hTableSize = (contexts.size() < 10000) ? 15013 : 3 * contexts.size() / 2;
+
+        // The contexts that share an entry of the table are stored in
+        // descending order
+        QList<std::pair<int, QByteArray>> hashMap;
+        hashMap.reserve(contexts.size());
+        for (const QByteArray &context : std::as_const(contexts))
+            hashMap.append({ int(elfHash(context) % hTableSize), context });
+        std::sort(hashMap.begin(), hashMap.end(), [](const auto &e1, const auto &e2) {
+            return e1.first != e2.first ? e1.first < e2.first : e2.second < e1.second;
+        });
 
         /*
           The contexts found in this translator are stored in a hash
@@ -350,20 +381,20 @@ void Releaser::squeeze(TranslatorSaveMode mode)
         t << quint16(0); // the entry at offset 0 cannot be used
         uint upto = 2;
 
-        auto entry = hashMap.constBegin();
-        while (entry != hashMap.constEnd()) {
-            int i = entry.key();
+        auto entry = hashMap.cbegin();
+        while (entry != hashMap.cend()) {
+            int i = entry->first;
             hTable[i] = quint16(upto >> 1);
 
             do {
-                const char *con = entry.value().constData();
-                uint len = uint(entry.value().size());
+                const char *con = entry->second.constData();
+                uint len = uint(entry->second.size());
                 len = qMin(len, 255u);
                 t << quint8(len);
                 t.writeRawData(con, len);
                 upto += 1 + len;
                 ++entry;
-            } while (entry != hashMap.constEnd() && entry.key() == i);
+            } while (entry != hashMap.cend() && entry->first == i);
             if (upto & 0x1) {
                 // offsets have to be even
                 t << quint8(0); // empty string
@@ -388,21 +419,24 @@ void Releaser::insert(const TranslatorMessage &message, const QStringList &tlns,
                                originalBytes(message.sourceText()),
                                originalBytes(message.comment()),
                                tlns);
+    const std::pair<QByteArray, QByteArray> key(bmsg.context(), bmsg.sourceText());
     if (!forceComment) {
-        ByteTranslatorMessage bmsg2(
-                bmsg.context(), bmsg.sourceText(), QByteArray(""), bmsg.translations());
-        if (!m_messages.contains(bmsg2)) {
-            m_messages.insert(bmsg2, 0);
+        if (!m_uncommented.contains(key)) {
+            m_uncommented.insert(key);
+            m_messages.append(ByteTranslatorMessage(
+                    bmsg.context(), bmsg.sourceText(), QByteArray(""), bmsg.translations()));
             return;
         }
     }
-    m_messages.insert(bmsg, 0);
+    if (bmsg.comment().isEmpty())
+        m_uncommented.insert(key);
+    m_messages.append(bmsg);
 }
 
 void Releaser::insertIdBased(const TranslatorMessage &message, const QStringList &tlns)
 {
     ByteTranslatorMessage bmsg("", originalBytes(message.id()), "", tlns);
-    m_messages.insert(bmsg, 0);
+    m_messages.append(bmsg);
 }
 
 void Releaser::setNumerusRules(const QByteArray &rules)
@@ -606,16 +640,6 @@ bool loadQM(Translator &translator, QIODevice &dev, ConversionData &cd)
 
 
 
-static bool containsStripped(const Translator &translator, const TranslatorMessage &msg)
-{
-    for (const TranslatorMessage &tmsg : translator.messages())
-        if (tmsg.sourceText() == msg.sourceText()
-            && tmsg.context() == msg.context()
-            && tmsg.comment().isEmpty())
-        return true;
-    return false;
-}
-
 bool saveQM(const Translator &translator, QIODevice &dev, ConversionData &cd)
 {
     Releaser releaser(translator.languageCode());
@@ -632,6 +656,15 @@ bool saveQM(const Translator &translator, QIODevice &dev, ConversionData &cd)
     int missingIds = 0;
     int droppedData = 0;
 
+    // The contexts and source texts of the messages without comment
+    QSet<std::pair<QString, QString>> uncommented;
+    if (!cd.m_idBased) {
+        for (const TranslatorMessage &msg : translator.messages()) {
+            if (msg.comment().isEmpty())
+                uncommented.insert({ msg.context(), msg.sourceText() });
+        }
+    }
+
     for (int i = 0; i != translator.messageCount(); ++i) {
         const TranslatorMessage &msg = translator.message(i);
         TranslatorMessage::Type typ = msg.type();
@@ -671,7 +704,7 @@ bool saveQM(const Translator &translator, QIODevice &dev, ConversionData &cd)
                 bool forceComment =
                         msg.comment().isEmpty()
                         || msg.context().isEmpty()
-                        || containsStripped(translator, msg);
+                        || uncommented.contains({ msg.context(), msg.sourceText() });
                 releaser.insert(msg, tlns, forceComment);
             }
         }
@@ -7,7 +7,11 @@
 #include "ioutils.h"
 using namespace QMakeInternal;
 
+#include <qdatastream.h>
+#include <qdatetime.h>
 #include <qfile.h>
+#include <qfileinfo.h>
+#include <qsavefile.h>
 #ifdef PROPARSER_THREAD_SAFE
 # include <qthreadpool.h>
 #endif
@@ -99,6 +103,124 @@ void ProFileCache::discardFiles(const QString &prefix, QMakeVfs *vfs)
     }
 }
 
+static const quint32 storageMagic = 0x51505243; // "QPRC"
+// Bump this whenever the token stream format changes
+static const quint32 storageVersion = 1;
+
+void ProFileCache::setStorageFile(const QString &fileName)
+{
+    storage_file = fileName;
+    stored_files.clear();
+    stored_files_changed = false;
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray qtVersion;
+    in >> magic >> version >> qtVersion;
+    if (magic != storageMagic || version != storageVersion || qtVersion != QT_VERSION_STR)
+        return;
+
+    qint32 count = 0;
+    in >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString name;
+        StoredFile stored;
+        in >> name >> stored.stamp.size >> stored.stamp.lastModified >> stored.hostBuild
+           >> stored.items;
+        stored_files.insert(name, stored);
+    }
+    if (in.status() != QDataStream::Ok)
+        stored_files.clear();
+}
+
+bool ProFileCache::save()
+{
+    if (storage_file.isEmpty())
+        return true;
+
+    // Files which were not needed in this run are dropped, so that the
+    // storage does not grow forever
+    qint32 count = 0;
+    for (const StoredFile &stored : std::as_const(stored_files)) {
+        if (stored.used)
+            ++count;
+    }
+    if (!stored_files_changed && count == stored_files.size())
+        return true;
+
+    QSaveFile file(storage_file);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << storageMagic << storageVersion << QByteArray(QT_VERSION_STR) << count;
+    for (auto it = stored_files.cbegin(), end = stored_files.cend(); it != end; ++it) {
+        if (it->used) {
+            out << it.key() << it->stamp.size << it->stamp.lastModified << it->hostBuild
+                << it->items;
+        }
+    }
+    if (out.status() != QDataStream::Ok || !file.commit())
+        return false;
+    stored_files_changed = false;
+    return true;
+}
+
+// Returns the file from the storage if it did not change on disk since it was
+// parsed. Otherwise, the current stamp of the file is returned for storeFile().
+ProFile *ProFileCache::restoreFile(int id, const QString &fileName, FileStamp *stamp)
+{
+    if (storage_file.isEmpty())
+        return nullptr;
+
+    // Built-in and virtual files are cheap to parse
+    const QFileInfo info(fileName);
+    if (!info.isNativePath() || !info.isFile())
+        return nullptr;
+    stamp->size = info.size();
+    stamp->lastModified = info.lastModified().toMSecsSinceEpoch();
+
+#ifdef PROPARSER_THREAD_SAFE
+    QMutexLocker lck(&mutex);
+#endif
+    auto it = stored_files.find(fileName);
+    if (it == stored_files.end() || it->stamp.size != stamp->size
+            || it->stamp.lastModified != stamp->lastModified) {
+        return nullptr;
+    }
+    it->used = true;
+
+    ProFile *pro = new ProFile(id, fileName);
+    *pro->itemsRef() = it->items;
+    pro->setHostBuild(it->hostBuild);
+    return pro;
+}
+
+void ProFileCache::storeFile(const ProFile *pro, const FileStamp &stamp)
+{
+    // Files with syntax errors are parsed again, so the errors are reported
+    if (stamp.size < 0 || !pro->isOk())
+        return;
+
+#ifdef PROPARSER_THREAD_SAFE
+    QMutexLocker lck(&mutex);
+#endif
+    StoredFile &stored = stored_files[pro->fileName()];
+    stored.stamp = stamp;
+    stored.items = pro->items();
+    stored.hostBuild = pro->isHostBuild();
+    stored.used = true;
+    stored_files_changed = true;
+}
+
 ////////// Parser ///////////
 
 #define fL1S(s) QString::fromLatin1(s)
@@ -190,13 +312,19 @@ ProFile *QMakeParser::parsedProFile(const QString &fileName, ParseFlags flags)
             ent->locker = new ProFileCache::Entry::Locker;
             locker.unlock();
 #endif
-            QString contents;
-            if (readFile(id, flags, &contents)) {
-                pro = parsedProBlock(QStringView(contents), id, fileName, 1, FullGrammar);
-                pro->itemsRef()->squeeze();
+            ProFileCache::FileStamp stamp;
+            if ((pro = m_cache->restoreFile(id, fileName, &stamp))) {
                 pro->ref();
             } else {
-                pro = nullptr;
+                QString contents;
+                if (readFile(id, flags, &contents)) {
+                    pro = parsedProBlock(QStringView(contents), id, fileName, 1, FullGrammar);
+                    pro->itemsRef()->squeeze();
+                    pro->ref();
+                    m_cache->storeFile(pro, stamp);
+                } else {
+                    pro = nullptr;
+                }
             }
             ent->pro = pro;
 #ifdef PROPARSER_THREAD_SAFE
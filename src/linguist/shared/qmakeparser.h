@@ -182,7 +182,27 @@ public:
     void discardFile(const QString &fileName, QMakeVfs *vfs);
     void discardFiles(const QString &prefix, QMakeVfs *vfs);
 
+    // Keeps the parsed files in fileName across runs. Call these
+    // from a concurrency-free context.
+    void setStorageFile(const QString &fileName);
+    bool save();
+
 private:
+    struct FileStamp {
+        qint64 size = -1;
+        qint64 lastModified = 0;
+    };
+
+    struct StoredFile {
+        FileStamp stamp;
+        QString items;
+        bool hostBuild = false;
+        bool used = false;
+    };
+
+    ProFile *restoreFile(int id, const QString &fileName, FileStamp *stamp);
+    void storeFile(const ProFile *pro, const FileStamp &stamp);
+
     struct Entry {
         ProFile *pro;
 #ifdef PROPARSER_THREAD_SAFE
@@ -197,6 +217,9 @@ private:
     };
 
     QHash<int, Entry> parsed_files;
+    QHash<QString, StoredFile> stored_files;
+    QString storage_file;
+    bool stored_files_changed = false;
 #ifdef PROPARSER_THREAD_SAFE
     QMutex mutex;
 #endif
@@ -143,60 +143,111 @@ static inline CoMatrix intersection(const CoMatrix &m, const CoMatrix &n)
     return p;
 }
 
+TextSignature::TextSignature(const QString &str)
+    : cm(str), length(str.size()), cmWorth(worth(cm))
+{
+}
+
 StringSimilarityMatcher::StringSimilarityMatcher(const QString &stringToMatch)
-    : m_cm(stringToMatch)
+    : m_signature(stringToMatch)
 {
-    m_length = stringToMatch.size();
 }
 
 int StringSimilarityMatcher::getSimilarityScore(const QString &strCandidate)
 {
-    CoMatrix cmTarget(strCandidate);
-    int delta = qAbs(m_length - strCandidate.size());
-    int score = ( (worth(intersection(m_cm, cmTarget)) + 1) << 10 ) /
-        ( worth(reunion(m_cm, cmTarget)) + (delta << 1) + 1 );
+    return getSimilarityScore(TextSignature(strCandidate));
+}
+
+int StringSimilarityMatcher::getSimilarityScore(const TextSignature &candidate) const
+{
+    int common = worth(intersection(m_signature.cm, candidate.cm));
+    int all = m_signature.cmWorth + candidate.cmWorth - common;
+    int delta = qAbs(m_signature.length - candidate.length);
+    int score = ( (common + 1) << 10 ) /
+        ( all + (delta << 1) + 1 );
     return score;
 }
 
-CandidateList similarTextHeuristicCandidates(const Translator *tor,
-    const QString &text, int maxCandidates)
+/*
+  Returns an upper bound of the score of the candidate, computed from
+  the number of entries of both matrices alone: they cannot have more
+  entries in common than the smaller one has, nor fewer entries in
+  their union than the larger one.
+*/
+int StringSimilarityMatcher::maximumSimilarityScore(const TextSignature &candidate) const
 {
-    QList<int> scores;
-    CandidateList candidates;
-    StringSimilarityMatcher matcher(text);
+    int common = qMin(m_signature.cmWorth, candidate.cmWorth);
+    int all = qMax(m_signature.cmWorth, candidate.cmWorth);
+    int delta = qAbs(m_signature.length - candidate.length);
+    return ( (common + 1) << 10 ) / ( all + (delta << 1) + 1 );
+}
 
-    for (const TranslatorMessage &mtm : tor->messages()) {
-        if (mtm.type() == TranslatorMessage::Unfinished
-            || mtm.translation().isEmpty())
-            continue;
+const TextSignature &SimilarTextIndex::signature(const QString &str)
+{
+    auto it = m_signatures.find(str);
+    if (it == m_signatures.end())
+        it = m_signatures.insert(str, TextSignature(str));
+    return *it;
+}
 
-        QString s = mtm.sourceText();
-        int score = matcher.getSimilarityScore(s);
+SimilarTextCandidates::SimilarTextCandidates(const QString &text, int maxCandidates)
+    : m_matcher(text), m_maxCandidates(maxCandidates)
+{
+}
 
-        if (candidates.size() == maxCandidates && score > scores[maxCandidates - 1] )
-            candidates.removeLast();
+bool SimilarTextCandidates::accepts(const TextSignature &signature) const
+{
+    if (m_maxCandidates <= 0)
+        return false;
+    int bound = m_matcher.maximumSimilarityScore(signature);
+    if (bound < textSimilarityThreshold)
+        return false;
+    return m_candidates.size() < m_maxCandidates || bound > m_scores.last();
+}
 
-        if (candidates.size() < maxCandidates && score >= textSimilarityThreshold) {
-            Candidate cand(mtm.context(), s, mtm.comment(), mtm.translation());
+void SimilarTextCandidates::add(const TextSignature &signature, const Candidate &cand)
+{
+    int score = m_matcher.getSimilarityScore(signature);
+
+    if (m_candidates.size() == m_maxCandidates && score > m_scores[m_maxCandidates - 1]) {
+        m_candidates.removeLast();
+        m_scores.removeLast();
+    }
 
-            int i;
-            for (i = 0; i < candidates.size(); i++) {
-                if (score >= scores.at(i)) {
-                    if (score == scores.at(i)) {
-                        if (candidates.at(i) == cand)
-                            goto continue_outer_loop;
-                    } else {
-                        break;
-                    }
+    if (m_candidates.size() < m_maxCandidates && score >= textSimilarityThreshold) {
+        int i;
+        for (i = 0; i < m_candidates.size(); i++) {
+            if (score >= m_scores.at(i)) {
+                if (score == m_scores.at(i)) {
+                    if (m_candidates.at(i) == cand)
+                        return;
+                } else {
+                    break;
                 }
             }
-            scores.insert(i, score);
-            candidates.insert(i, cand);
         }
-        continue_outer_loop:
-        ;
+        m_scores.insert(i, score);
+        m_candidates.insert(i, cand);
+    }
+}
+
+CandidateList similarTextHeuristicCandidates(const Translator *tor,
+    const QString &text, int maxCandidates, SimilarTextIndex *index)
+{
+    SimilarTextCandidates candidates(text, maxCandidates);
+
+    for (const TranslatorMessage &mtm : tor->messages()) {
+        if (mtm.type() == TranslatorMessage::Unfinished
+            || mtm.translation().isEmpty())
+            continue;
+
+        const QString &s = mtm.sourceText();
+        const TextSignature signature = index ? index->signature(s) : TextSignature(s);
+        if (!candidates.accepts(signature))
+            continue;
+        candidates.add(signature, Candidate(mtm.context(), s, mtm.comment(), mtm.translation()));
     }
-    return candidates;
+    return candidates.candidates();
 }
 
 QT_END_NAMESPACE
@@ -8,6 +8,7 @@ const int textSimilarityThreshold = 190;
 
 #include <QString>
 #include <QList>
+#include <QHash>
 
 QT_BEGIN_NAMESPACE
 
@@ -51,6 +52,20 @@ struct CoMatrix
     };
 };
 
+/**
+ * The co-occurrence matrix of a string, together with the values
+ * needed to score it against other strings.
+ */
+struct TextSignature
+{
+    TextSignature() {}
+    TextSignature(const QString &str);
+
+    CoMatrix cm;
+    int length = 0;
+    int cmWorth = 0;
+};
+
 /**
  * This class is more efficient for searching through a large array of candidate strings, since we only
  * have to construct the CoMatrix for the \a stringToMatch once,
@@ -61,10 +76,44 @@ class StringSimilarityMatcher {
 public:
     StringSimilarityMatcher(const QString &stringToMatch);
     int getSimilarityScore(const QString &strCandidate);
+    int getSimilarityScore(const TextSignature &candidate) const;
+    int maximumSimilarityScore(const TextSignature &candidate) const;
+
+private:
+    TextSignature m_signature;
+};
+
+/**
+ * Caches the signatures of candidate strings, so that searching the
+ * same messages for similar texts again does not rebuild them.
+ * Entries are keyed by the string itself, and never become stale.
+ */
+class SimilarTextIndex {
+public:
+    const TextSignature &signature(const QString &str);
+    void clear() { m_signatures.clear(); }
+
+private:
+    QHash<QString, TextSignature> m_signatures;
+};
+
+/**
+ * Keeps the best \a maxCandidates candidates offered to it, by
+ * descending score. Candidates whose signature cannot beat the
+ * current ones are rejected by accepts() without being scored.
+ */
+class SimilarTextCandidates {
+public:
+    SimilarTextCandidates(const QString &text, int maxCandidates);
+    bool accepts(const TextSignature &signature) const;
+    void add(const TextSignature &signature, const Candidate &candidate);
+    const CandidateList &candidates() const { return m_candidates; }
 
 private:
-    CoMatrix m_cm;
-    int m_length;
+    StringSimilarityMatcher m_matcher;
+    int m_maxCandidates;
+    QList<int> m_scores;
+    CandidateList m_candidates;
 };
 
 /**
@@ -81,7 +130,8 @@ static inline int getSimilarityScore(const QString &str1, const QString &str2)
 
 CandidateList similarTextHeuristicCandidates( const Translator *tor,
                                               const QString &text,
-                                              int maxCandidates );
+                                              int maxCandidates,
+                                              SimilarTextIndex *index = nullptr );
 
 QT_END_NAMESPACE
 
@@ -28,7 +28,8 @@ QT_BEGIN_NAMESPACE
 
 Translator::Translator() :
     m_locationsType(AbsoluteLocations),
-    m_indexOk(true)
+    m_indexOk(true),
+    m_refIndexOk(false)
 {
 }
 
@@ -52,6 +53,7 @@ QList<Translator::FileFormat> &Translator::registeredFileFormats()
 
 void Translator::addIndex(int idx, const TranslatorMessage &msg) const
 {
+    m_refIndexOk = false;
     if (msg.sourceText().isEmpty() && msg.id().isEmpty()) {
         m_ctxCmtIdx[msg.context()] = idx;
     } else {
@@ -63,6 +65,7 @@ void Translator::addIndex(int idx, const TranslatorMessage &msg) const
 
 void Translator::delIndex(int idx) const
 {
+    m_refIndexOk = false;
     const TranslatorMessage &msg = m_messages.at(idx);
     if (msg.sourceText().isEmpty() && msg.id().isEmpty()) {
         m_ctxCmtIdx.remove(msg.context());
@@ -80,20 +83,90 @@ void Translator::ensureIndexed() const
         m_ctxCmtIdx.clear();
         m_idMsgIdx.clear();
         m_msgIdx.clear();
+        m_msgIdx.reserve(m_messages.size());
         for (int i = 0; i < m_messages.size(); i++)
             addIndex(i, m_messages.at(i));
     }
 }
 
+void Translator::ensureRefIndexed() const
+{
+    ensureIndexed();
+    if (!m_refIndexOk) {
+        m_refIndexOk = true;
+        m_refIdx.clear();
+        // Backwards, so that the first of several matching messages wins
+        for (int i = m_messages.size() - 1; i >= 0; i--) {
+            const TranslatorMessage &msg = m_messages.at(i);
+            for (const auto &ref : msg.allReferences())
+                m_refIdx.insert(TMMRefKey(msg.context(), msg.comment(), ref), i);
+        }
+    }
+}
+
+QString Translator::internedString(const QString &str)
+{
+    if (str.isEmpty())
+        return str;
+    const auto it = m_strings.constFind(str);
+    if (it != m_strings.cend())
+        return *it;
+    m_strings.insert(str);
+    return str;
+}
+
+// The order of the entries of a QHash is arbitrary, so combine them commutatively
+static size_t extrasHash(const TranslatorMessage::ExtraData &extras)
+{
+    size_t hash = 0;
+    for (auto it = extras.cbegin(); it != extras.cend(); ++it)
+        hash += qHashMulti(0, it.key(), it.value());
+    return hash;
+}
+
+TranslatorMessage::ExtraData Translator::internedExtras(const TranslatorMessage::ExtraData &extras)
+{
+    if (extras.isEmpty())
+        return extras;
+    const size_t hash = extrasHash(extras);
+    for (auto it = m_messageExtras.constFind(hash); it != m_messageExtras.cend() && it.key() == hash;
+         ++it) {
+        if (*it == extras)
+            return *it;
+    }
+    m_messageExtras.insert(hash, extras);
+    return extras;
+}
+
+// The same contexts, file names and extras are repeated by many messages.
+// Let the messages share one copy of each of them.
+void Translator::internStrings(TranslatorMessage *msg)
+{
+    msg->setContext(internedString(msg->context()));
+    msg->setFileName(internedString(msg->fileName()));
+    const TranslatorMessage::References refs = msg->extraReferences();
+    if (!refs.isEmpty()) {
+        TranslatorMessage::References internedRefs;
+        internedRefs.reserve(refs.size());
+        for (const auto &ref : refs)
+            internedRefs.append({ internedString(ref.fileName()), ref.lineNumber() });
+        msg->setExtraReferences(internedRefs);
+    }
+    if (!msg->extras().isEmpty())
+        msg->setExtras(internedExtras(msg->extras()));
+}
+
 void Translator::replaceSorted(const TranslatorMessage &msg)
 {
     int index = find(msg);
     if (index == -1) {
         appendSorted(msg);
     } else {
+        TranslatorMessage interned = msg;
+        internStrings(&interned);
         delIndex(index);
-        m_messages[index] = msg;
-        addIndex(index, msg);
+        m_messages[index] = interned;
+        addIndex(index, interned);
     }
 }
 
@@ -127,7 +200,7 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
             return;
         }
         if (emsg.extras().isEmpty()) {
-            emsg.setExtras(msg.extras());
+            emsg.setExtras(internedExtras(msg.extras()));
         } else if (!msg.extras().isEmpty() && emsg.extras() != msg.extras()) {
             cd.appendError(QString::fromLatin1("Contradicting meta data for for %1.")
                            .arg(!emsg.id().isEmpty()
@@ -135,7 +208,8 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
                                 : QString::fromLatin1("message '%1'").arg(makeMsgId(msg))));
             return;
         }
-        emsg.addReferenceUniq(msg.fileName(), msg.lineNumber());
+        emsg.addReferenceUniq(internedString(msg.fileName()), msg.lineNumber());
+        m_refIndexOk = false;
         if (!msg.extraComment().isEmpty()) {
             QString cmt = emsg.extraComment();
             if (!cmt.isEmpty()) {
@@ -154,13 +228,15 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
 
 void Translator::insert(int idx, const TranslatorMessage &msg)
 {
+    TranslatorMessage interned = msg;
+    internStrings(&interned);
     if (m_indexOk) {
         if (idx == m_messages.size())
-            addIndex(idx, msg);
+            addIndex(idx, interned);
         else
-            m_indexOk = false;
+            invalidateIndexes();
     }
-    m_messages.insert(idx, msg);
+    m_messages.insert(idx, std::move(interned));
 }
 
 void Translator::append(const TranslatorMessage &msg)
@@ -370,19 +446,16 @@ int Translator::find(const TranslatorMessage &msg) const
 int Translator::find(const QString &context,
     const QString &comment, const TranslatorMessage::References &refs) const
 {
+    int idx = -1;
     if (!refs.isEmpty()) {
-        for (auto it = m_messages.cbegin(), end = m_messages.cend(); it != end; ++it) {
-            if (it->context() == context && it->comment() == comment) {
-                for (const auto &itref : it->allReferences()) {
-                    for (const auto &ref : refs) {
-                        if (itref == ref)
-                            return it - m_messages.cbegin();
-                    }
-                }
-            }
+        ensureRefIndexed();
+        for (const auto &ref : refs) {
+            const auto it = m_refIdx.constFind(TMMRefKey(context, comment, ref));
+            if (it != m_refIdx.cend() && (idx < 0 || *it < idx))
+                idx = *it;
         }
     }
-    return -1;
+    return idx;
 }
 
 int Translator::find(const QString &context) const
@@ -398,7 +471,7 @@ void Translator::stripObsoleteMessages()
             it = m_messages.erase(it);
         else
             ++it;
-    m_indexOk = false;
+    invalidateIndexes();
 }
 
 void Translator::stripFinishedMessages()
@@ -408,7 +481,7 @@ void Translator::stripFinishedMessages()
             it = m_messages.erase(it);
         else
             ++it;
-    m_indexOk = false;
+    invalidateIndexes();
 }
 
 void Translator::stripUntranslatedMessages()
@@ -418,7 +491,7 @@ void Translator::stripUntranslatedMessages()
             it = m_messages.erase(it);
         else
             ++it;
-    m_indexOk = false;
+    invalidateIndexes();
 }
 
 bool Translator::translationsExist() const
@@ -437,7 +510,7 @@ void Translator::stripEmptyContexts()
             it = m_messages.erase(it);
         else
             ++it;
-    m_indexOk = false;
+    invalidateIndexes();
 }
 
 void Translator::stripNonPluralForms()
@@ -447,7 +520,7 @@ void Translator::stripNonPluralForms()
             it = m_messages.erase(it);
         else
             ++it;
-    m_indexOk = false;
+    invalidateIndexes();
 }
 
 void Translator::stripIdenticalSourceTranslations()
@@ -459,7 +532,7 @@ void Translator::stripIdenticalSourceTranslations()
         else
             ++it;
     }
-    m_indexOk = false;
+    invalidateIndexes();
 }
 
 void Translator::dropTranslations()
@@ -469,6 +542,7 @@ void Translator::dropTranslations()
             message.setType(TranslatorMessage::Unfinished);
         message.setTranslation(QString());
     }
+    invalidateIndexes();
 }
 
 void Translator::dropUiLines()
@@ -489,6 +563,7 @@ void Translator::dropUiLines()
         }
         message.setReferences(refs);
     }
+    invalidateIndexes();
 }
 
 class TranslatorMessagePtrBase
@@ -597,7 +672,7 @@ Translator::Duplicates Translator::resolveDuplicates()
         pDup->insert(oi);
         if (!omsg->isTranslated() && msg.isTranslated())
             omsg->setTranslations(msg.translations());
-        m_indexOk = false;
+        invalidateIndexes();
         m_messages.removeAt(i);
     }
     return dups;
@@ -605,26 +680,32 @@ Translator::Duplicates Translator::resolveDuplicates()
 
 void Translator::reportDuplicates(const Duplicates &dupes,
                                   const QString &fileName, bool verbose)
+{
+    reportDuplicates(dupes, fileName, verbose, std::cerr);
+}
+
+void Translator::reportDuplicates(const Duplicates &dupes,
+                                  const QString &fileName, bool verbose, std::ostream &out)
 {
     if (!dupes.byId.isEmpty() || !dupes.byContents.isEmpty()) {
-        std::cerr << "Warning: dropping duplicate messages in '" << qPrintable(fileName);
+        out << "Warning: dropping duplicate messages in '" << qPrintable(fileName);
         if (!verbose) {
-            std::cerr << "'\n(try -verbose for more info).\n";
+            out << "'\n(try -verbose for more info).\n";
         } else {
-            std::cerr << "':\n";
+            out << "':\n";
             for (int i : dupes.byId)
-                std::cerr << "\n* ID: " << qPrintable(message(i).id()) << std::endl;
+                out << "\n* ID: " << qPrintable(message(i).id()) << std::endl;
             for (int j : dupes.byContents) {
                 const TranslatorMessage &msg = message(j);
-                std::cerr << "\n* Context: " << qPrintable(msg.context())
-                          << "\n* Source: " << qPrintable(msg.sourceText()) << std::endl;
+                out << "\n* Context: " << qPrintable(msg.context())
+                    << "\n* Source: " << qPrintable(msg.sourceText()) << std::endl;
                 if (!msg.comment().isEmpty())
-                    std::cerr << "* Comment: " << qPrintable(msg.comment()) << std::endl;
+                    out << "* Comment: " << qPrintable(msg.comment()) << std::endl;
                 const int tsLine = msg.tsLineNumber();
                 if (tsLine >= 0)
-                    std::cerr << "* Line in .ts File: " << msg.tsLineNumber() << std::endl;
+                    out << "* Line in .ts File: " << msg.tsLineNumber() << std::endl;
             }
-            std::cerr << std::endl;
+            out << std::endl;
         }
     }
 }
@@ -643,6 +724,7 @@ void Translator::makeFileNamesAbsolute(const QDir &originalPath)
             msg.addReference(fileName, ref.lineNumber());
         }
     }
+    invalidateIndexes();
 }
 
 const QList<TranslatorMessage> &Translator::messages() const
@@ -693,6 +775,7 @@ void Translator::normalizeTranslations(ConversionData &cd)
             m_messages[i].setTranslations(tlns);
         }
     }
+    invalidateIndexes();
     if (truncated)
         cd.appendError(QLatin1String(
             "Removed plural forms as the target language has less "
@@ -709,7 +792,7 @@ QString Translator::guessLanguageCodeFromFileName(const QString &filename)
             break;
         }
     }
-    static QRegularExpression re(QLatin1String("[\\._]"));
+    static const QRegularExpression re(QLatin1String("[\\._]"));
     while (true) {
         QLocale locale(str);
         //qDebug() << "LANGUAGE FROM " << str << "LANG: " << locale.language();
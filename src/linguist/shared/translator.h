@@ -15,6 +15,8 @@
 #include <QString>
 #include <QSet>
 
+#include <iosfwd>
+
 
 QT_BEGIN_NAMESPACE
 
@@ -81,7 +83,23 @@ public:
 Q_DECLARE_TYPEINFO(TMMKey, Q_RELOCATABLE_TYPE);
 inline size_t qHash(const TMMKey &key)
 {
-    return qHash(key.context) ^ qHash(key.source) ^ qHash(key.comment);
+    return qHashMulti(0, key.context, key.source, key.comment);
+}
+
+class TMMRefKey {
+public:
+    TMMRefKey(const QString &ctx, const QString &cmt, const TranslatorMessage::Reference &ref)
+        : context(ctx), comment(cmt), fileName(ref.fileName()), lineNumber(ref.lineNumber()) {}
+    bool operator==(const TMMRefKey &o) const
+        { return lineNumber == o.lineNumber && fileName == o.fileName
+                 && context == o.context && comment == o.comment; }
+    QString context, comment, fileName;
+    int lineNumber;
+};
+Q_DECLARE_TYPEINFO(TMMRefKey, Q_RELOCATABLE_TYPE);
+inline size_t qHash(const TMMRefKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.context, key.comment, key.fileName, key.lineNumber);
 }
 
 class Translator
@@ -97,6 +115,9 @@ public:
         const QString &comment, const TranslatorMessage::References &refs) const;
 
     int find(const QString &context) const;
+    // Builds the indexes used by find(), so that it can be called from
+    // several threads as long as the messages are not modified.
+    void buildIndexes() const { ensureRefIndexed(); }
 
     void replaceSorted(const TranslatorMessage &msg);
     void extend(const TranslatorMessage &msg, ConversionData &cd); // Only for single-location messages
@@ -117,6 +138,8 @@ public:
     struct Duplicates { QSet<int> byId, byContents; };
     Duplicates resolveDuplicates();
     void reportDuplicates(const Duplicates &dupes, const QString &fileName, bool verbose);
+    void reportDuplicates(const Duplicates &dupes, const QString &fileName, bool verbose,
+                          std::ostream &out);
 
     QString languageCode() const { return m_language; }
     QString sourceLanguageCode() const { return m_sourceLanguage; }
@@ -182,6 +205,12 @@ private:
     void addIndex(int idx, const TranslatorMessage &msg) const;
     void delIndex(int idx) const;
     void ensureIndexed() const;
+    void ensureRefIndexed() const;
+    // To be called by everything that adds, removes or modifies messages
+    void invalidateIndexes() { m_indexOk = false; m_refIndexOk = false; }
+    QString internedString(const QString &str);
+    ExtraData internedExtras(const ExtraData &extras);
+    void internStrings(TranslatorMessage *msg);
 
     typedef QList<TranslatorMessage> TMM;       // int stores the sequence position.
 
@@ -206,6 +235,13 @@ private:
     mutable QHash<QString, int> m_ctxCmtIdx;
     mutable QHash<QString, int> m_idMsgIdx;
     mutable QHash<TMMKey, int> m_msgIdx;
+    // First message for each context, comment and reference
+    mutable bool m_refIndexOk;
+    mutable QHash<TMMRefKey, int> m_refIdx;
+
+    // The contexts, file names and extras that messages share, see internStrings()
+    QSet<QString> m_strings;
+    QMultiHash<size_t, ExtraData> m_messageExtras;
 };
 
 bool getNumerusInfo(QLocale::Language language, QLocale::Territory territory, QByteArray *rules,
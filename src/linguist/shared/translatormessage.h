@@ -81,6 +81,7 @@ public:
     void addReference(const Reference &ref) { addReference(ref.fileName(), ref.lineNumber()); }
     void addReferenceUniq(const QString &fileName, int lineNumber);
     References extraReferences() const { return m_extraRefs; }
+    void setExtraReferences(const References &refs) { m_extraRefs = refs; }
     References allReferences() const;
     QString userData() const { return m_userData; }
     void setUserData(const QString &userData) { m_userData = userData; }
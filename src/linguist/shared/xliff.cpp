@@ -650,9 +650,11 @@ bool XLIFFHandler::characters(QStringView ch)
                 accum.append(chr);
         }
     } else {
-        QString t = ch.toString();
-        t.replace(QLatin1String("\r"), QLatin1String(""));
-        accum.append(t);
+        // Append the text in runs between carriage returns, which are dropped
+        qsizetype from = 0;
+        for (qsizetype cr; (cr = ch.indexOf(QLatin1Char('\r'), from)) != -1; from = cr + 1)
+            accum.append(ch.sliced(from, cr - from));
+        accum.append(ch.sliced(from));
     }
     return true;
 }
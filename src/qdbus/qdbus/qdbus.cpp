@@ -4,9 +4,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <functional>
+
 #include <QtCore/QCoreApplication>
+#include <QtCore/QEventLoop>
 #include <QtCore/QRegularExpression>
 #include <QtCore/QStringList>
+#include <QtCore/QXmlStreamReader>
 #include <QtCore/qmetaobject.h>
 #include <QtXml/QDomDocument>
 #include <QtXml/QDomElement>
@@ -16,6 +20,8 @@
 #include <QtDBus/QDBusVariant>
 #include <QtDBus/QDBusArgument>
 #include <QtDBus/QDBusMessage>
+#include <QtDBus/QDBusPendingCallWatcher>
+#include <QtDBus/QDBusPendingReply>
 #include <QtDBus/QDBusReply>
 #include <private/qdbusutil_p.h>
 
@@ -83,45 +89,95 @@ static void printArg(const QVariant &v)
     }
 }
 
-static void listObjects(const QString &service, const QString &path)
+// Only the names of the child nodes are needed, so the reply is read with a
+// streaming reader instead of building a DOM
+static QStringList childNodes(const QString &xml)
 {
-    // make a low-level call, to avoid introspecting the Introspectable interface
-    QDBusMessage call = QDBusMessage::createMethodCall(service, path.isEmpty() ? QLatin1String("/") : path,
-                                                       QLatin1String("org.freedesktop.DBus.Introspectable"),
-                                                       QLatin1String("Introspect"));
-    QDBusReply<QString> xml = connection.call(call);
-
-    if (path.isEmpty()) {
-        // top-level
-        if (xml.isValid()) {
-            printf("/\n");
-        } else {
-            QDBusError err = xml.error();
-            if (err.type() == QDBusError::ServiceUnknown)
-                fprintf(stderr, "Service '%s' does not exist.\n", qPrintable(service));
-            else
-                printf("Error: %s\n%s\n", qPrintable(err.name()), qPrintable(err.message()));
-            exit(2);
+    QStringList children;
+    QXmlStreamReader reader(xml);
+    int depth = 0;
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement:
+            if (++depth == 2 && reader.name() == QLatin1String("node"))
+                children << reader.attributes().value(QLatin1String("name")).toString();
+            break;
+        case QXmlStreamReader::EndElement:
+            --depth;
+            break;
+        default:
+            break;
         }
-    } else if (!xml.isValid()) {
-        // this is not the first object, just fail silently
-        return;
     }
+    return children;
+}
 
-    QDomDocument doc;
-    doc.setContent(xml.value());
-    QDomElement node = doc.documentElement();
-    QDomElement child = node.firstChildElement();
-    while (!child.isNull()) {
-        if (child.tagName() == QLatin1String("node")) {
-            QString sub = path + QLatin1Char('/') + child.attribute(QLatin1String("name"));
-            printf("%s\n", qPrintable(sub));
-            listObjects(service, sub);
-        }
-        child = child.nextSiblingElement();
+static void printObjects(const QHash<QString, QStringList> &children, const QString &path)
+{
+    for (const QString &sub : children.value(path)) {
+        printf("%s\n", qPrintable(sub));
+        printObjects(children, sub);
     }
 }
 
+static void listObjects(const QString &service)
+{
+    // Services with many objects take long to introspect one call after
+    // another, so several calls are kept in flight
+    const int maxPendingCalls = 32;
+
+    QHash<QString, QStringList> children;
+    QStringList queue(QString{});
+    int pendingCalls = 0;
+    QEventLoop loop;
+
+    std::function<void()> startCalls = [&] {
+        while (pendingCalls < maxPendingCalls && !queue.isEmpty()) {
+            const QString path = queue.takeLast();
+            // make a low-level call, to avoid introspecting the Introspectable interface
+            QDBusMessage call = QDBusMessage::createMethodCall(service, path.isEmpty() ? QLatin1String("/") : path,
+                                                               QLatin1String("org.freedesktop.DBus.Introspectable"),
+                                                               QLatin1String("Introspect"));
+            auto watcher = new QDBusPendingCallWatcher(connection.asyncCall(call));
+            ++pendingCalls;
+            QObject::connect(watcher, &QDBusPendingCallWatcher::finished,
+                             [&, path](QDBusPendingCallWatcher *reply) {
+                reply->deleteLater();
+                --pendingCalls;
+
+                QDBusPendingReply<QString> xml = *reply;
+                if (xml.isError()) {
+                    if (path.isEmpty()) {
+                        // top-level
+                        QDBusError err = xml.error();
+                        if (err.type() == QDBusError::ServiceUnknown)
+                            fprintf(stderr, "Service '%s' does not exist.\n", qPrintable(service));
+                        else
+                            printf("Error: %s\n%s\n", qPrintable(err.name()), qPrintable(err.message()));
+                        exit(2);
+                    }
+                    // this is not the first object, just fail silently
+                } else {
+                    QStringList &subs = children[path];
+                    for (const QString &name : childNodes(xml.value()))
+                        subs << path + QLatin1Char('/') + name;
+                    queue += subs;
+                }
+
+                startCalls();
+                if (!pendingCalls)
+                    loop.quit();
+            });
+        }
+    };
+
+    startCalls();
+    loop.exec();
+
+    printf("/\n");
+    printObjects(children, QString());
+}
+
 static void listInterface(const QString &service, const QString &path, const QString &interface)
 {
     QDBusInterface iface(service, path, interface, connection);
@@ -473,7 +529,7 @@ int main(int argc, char **argv)
     }
 
     if (args.isEmpty()) {
-        listObjects(service, QString());
+        listObjects(service);
         return 0;
     }
 
@@ -0,0 +1,211 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "qdbusintrospector.h"
+
+#include <QtCore/QXmlStreamReader>
+
+#include <QtDBus/QDBusMessage>
+#include <QtDBus/QDBusPendingCallWatcher>
+
+// Services like NetworkManager or systemd expose thousands of objects, so
+// several calls are kept in flight instead of waiting for each reply
+static const int maxPendingCalls = 16;
+
+static QDBusIntrospectedObject parseIntrospection(const QString &xml)
+{
+    QDBusIntrospectedObject object;
+    QXmlStreamReader reader(xml);
+    int depth = 0;
+    bool inInterface = false;
+    bool inMethod = false;
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            ++depth;
+            const QStringView tag = reader.name();
+            const QXmlStreamAttributes attributes = reader.attributes();
+            const QString name = attributes.value(QLatin1String("name")).toString();
+            if (depth == 2) {
+                inInterface = tag == QLatin1String("interface");
+                if (inInterface)
+                    object.append({ QDBusModel::InterfaceItem, name, {} });
+                else if (tag == QLatin1String("node"))
+                    object.append({ QDBusModel::PathItem, name + QLatin1Char('/'), {} });
+            } else if (depth == 3 && inInterface) {
+                QList<QDBusIntrospectedMember> &members = object.last().members;
+                inMethod = tag == QLatin1String("method");
+                if (inMethod)
+                    members.append({ QDBusModel::MethodItem, name, QString() });
+                else if (tag == QLatin1String("signal"))
+                    members.append({ QDBusModel::SignalItem, name, QString() });
+                else if (tag == QLatin1String("property"))
+                    members.append({ QDBusModel::PropertyItem, name, QString() });
+            } else if (depth == 4 && inInterface && inMethod && tag == QLatin1String("arg")) {
+                //get "type" from <arg> where "direction" is "in"
+                if (attributes.value(QLatin1String("direction")) == QLatin1String("in")) {
+                    object.last().members.last().typeSignature
+                            += attributes.value(QLatin1String("type"));
+                }
+            }
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            if (depth == 3)
+                inMethod = false;
+            else if (depth == 2)
+                inInterface = false;
+            --depth;
+            break;
+        default:
+            break;
+        }
+    }
+    return object;
+}
+
+QDBusIntrospector::QDBusIntrospector(const QDBusConnection &connection, QObject *parent)
+    : QObject(parent), c(connection)
+{
+}
+
+QDBusIntrospector::~QDBusIntrospector()
+{
+    // The parsers post their results to this object
+    parserPool.waitForDone();
+}
+
+bool QDBusIntrospector::cachedObject(const QString &service, const QString &path,
+                                     QDBusIntrospectedObject *object) const
+{
+    auto it = cache.constFind(Key(service, path));
+    if (it == cache.cend())
+        return false;
+    *object = *it;
+    return true;
+}
+
+void QDBusIntrospector::introspect(const QString &service, const QString &path)
+{
+    const Key key(service, path);
+    if (cache.contains(key) || requested.contains(key))
+        return;
+    requested.insert(key);
+    queue.append(key);
+    startCalls();
+}
+
+void QDBusIntrospector::invalidate(const QString &service)
+{
+    for (const Key &key : std::as_const(requested)) {
+        if (key.first == service)
+            ++generations[key];
+    }
+    for (auto it = cache.begin(); it != cache.end(); ) {
+        if (it.key().first == service)
+            it = cache.erase(it);
+        else
+            ++it;
+    }
+}
+
+// Drops the objects at path and below it. Children are introspected ahead of
+// being expanded, so refreshing a path has to drop them too.
+void QDBusIntrospector::invalidatePrefix(const QString &service, const QString &path)
+{
+    const QString prefix = path.endsWith(QLatin1Char('/')) ? path : path + QLatin1Char('/');
+    const auto isBelowPath = [&](const Key &key) {
+        return key.first == service && (key.second == path || key.second.startsWith(prefix));
+    };
+
+    // Replies in flight may predate the change, so they are asked for again.
+    // The ones for other paths of the service, like prefetched siblings, are kept.
+    for (const Key &key : std::as_const(requested)) {
+        if (isBelowPath(key))
+            ++generations[key];
+    }
+    for (auto it = cache.begin(); it != cache.end(); ) {
+        if (isBelowPath(it.key())) {
+            it = cache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void QDBusIntrospector::startCalls()
+{
+    while (pendingCalls < maxPendingCalls && !queue.isEmpty()) {
+        const Key key = queue.takeFirst();
+        const int generation = generations.value(key);
+
+        // make a low-level call, to avoid introspecting the Introspectable interface
+        QDBusMessage call = QDBusMessage::createMethodCall(
+                key.first, key.second, QLatin1String("org.freedesktop.DBus.Introspectable"),
+                QLatin1String("Introspect"));
+        auto watcher = new QDBusPendingCallWatcher(c.asyncCall(call), this);
+        ++pendingCalls;
+        connect(watcher, &QDBusPendingCallWatcher::finished, this,
+                [this, key, generation](QDBusPendingCallWatcher *pending) {
+            pending->deleteLater();
+            --pendingCalls;
+            callFinished(key, generation, pending->reply());
+            startCalls();
+        });
+    }
+}
+
+void QDBusIntrospector::finishRequest(const Key &key)
+{
+    requested.remove(key);
+    generations.remove(key);
+}
+
+void QDBusIntrospector::callFinished(const Key &key, int generation, const QDBusMessage &reply)
+{
+    if (generation != generations.value(key)) {
+        // The service changed its owner or the path was refreshed meanwhile, ask again
+        finishRequest(key);
+        introspect(key.first, key.second);
+        return;
+    }
+
+    if (reply.type() == QDBusMessage::ErrorMessage) {
+        finishRequest(key);
+        emit introspectionFailed(key.first, key.second,
+                                 QString::fromLatin1("Call to object %1 at %2:\n  %3 (%4) failed\n")
+                                 .arg(key.second, key.first, reply.errorName(),
+                                      reply.errorMessage()));
+        return;
+    }
+
+    if (reply.signature() != QLatin1String("s")) {
+        finishRequest(key);
+        emit introspectionFailed(key.first, key.second,
+                                 QString::fromLatin1("Invalid XML received from object %1 at %2\n")
+                                 .arg(key.second, key.first));
+        return;
+    }
+
+    // Parsing large replies would stall the user interface
+    const QString xml = reply.arguments().constFirst().toString();
+    parserPool.start([this, key, generation, xml] {
+        const QDBusIntrospectedObject object = parseIntrospection(xml);
+        QMetaObject::invokeMethod(this, [this, key, generation, object] {
+            parsed(key, generation, object);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void QDBusIntrospector::parsed(const Key &key, int generation, const QDBusIntrospectedObject &object)
+{
+    const bool outdated = generation != generations.value(key);
+    finishRequest(key);
+    if (outdated) {
+        introspect(key.first, key.second);
+        return;
+    }
+
+    cache.insert(key, object);
+    emit introspected(key.first, key.second, object);
+}
@@ -0,0 +1,76 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef QDBUSINTROSPECTOR_H
+#define QDBUSINTROSPECTOR_H
+
+#include "qdbusmodel.h"
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
+#include <QtCore/QThreadPool>
+#include <QtDBus/QDBusConnection>
+
+QT_FORWARD_DECLARE_CLASS(QDBusMessage)
+
+struct QDBusIntrospectedMember
+{
+    QDBusModel::Type type;
+    QString name;
+    QString typeSignature;
+};
+
+// A child object (PathItem) or an interface (InterfaceItem) of an object
+struct QDBusIntrospectedItem
+{
+    QDBusModel::Type type;
+    QString name;
+    QList<QDBusIntrospectedMember> members;
+};
+
+using QDBusIntrospectedObject = QList<QDBusIntrospectedItem>;
+
+class QDBusIntrospector : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QDBusIntrospector(const QDBusConnection &connection, QObject *parent = nullptr);
+    ~QDBusIntrospector();
+
+    bool cachedObject(const QString &service, const QString &path,
+                      QDBusIntrospectedObject *object) const;
+    void introspect(const QString &service, const QString &path);
+
+    void invalidate(const QString &service);
+    void invalidatePrefix(const QString &service, const QString &path);
+
+Q_SIGNALS:
+    void introspected(const QString &service, const QString &path,
+                      const QDBusIntrospectedObject &object);
+    void introspectionFailed(const QString &service, const QString &path, const QString &text);
+
+private:
+    using Key = QPair<QString, QString>;
+
+    void startCalls();
+    void finishRequest(const Key &key);
+    void callFinished(const Key &key, int generation, const QDBusMessage &reply);
+    void parsed(const Key &key, int generation, const QDBusIntrospectedObject &object);
+
+    QDBusConnection c;
+    QHash<Key, QDBusIntrospectedObject> cache;
+    QList<Key> queue;
+    // Queued, in flight or being parsed
+    QSet<Key> requested;
+    // Bumped for the requested objects whose service changes its owner or whose
+    // path is refreshed, to drop replies that may be out of date
+    QHash<Key, int> generations;
+    int pendingCalls = 0;
+    QThreadPool parserPool;
+};
+
+#endif
@@ -2,20 +2,17 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include "qdbusmodel.h"
+#include "qdbusintrospector.h"
 
-#include <QtCore/QDebug>
 #include <QtCore/QList>
 
 #include <QtDBus/QDBusObjectPath>
-#include <QtDBus/QDBusInterface>
-#include <QtDBus/QDBusReply>
-
-#include <QtXml/QDomDocument>
 
 struct QDBusItem
 {
     inline QDBusItem(QDBusModel::Type aType, const QString &aName, QDBusItem *aParent = 0)
-        : type(aType), parent(aParent), isPrefetched(type != QDBusModel::PathItem), name(aName)
+        : type(aType), parent(aParent), isPrefetched(type != QDBusModel::PathItem),
+          isFetching(false), name(aName)
         {}
     inline ~QDBusItem()
     {
@@ -41,112 +38,125 @@ struct QDBusItem
     QDBusItem *parent;
     QList<QDBusItem *> children;
     bool isPrefetched;
+    bool isFetching;
     QString name;
     QString caption;
     QString typeSignature;
 };
 
-QDomDocument QDBusModel::introspect(const QString &path)
+void QDBusModel::addPath(QDBusItem *parent, const QDBusIntrospectedObject &object)
 {
-    QDomDocument doc;
-
-    QDBusInterface iface(service, path, QLatin1String("org.freedesktop.DBus.Introspectable"), c);
-    if (!iface.isValid()) {
-        QDBusError err(iface.lastError());
-        emit busError(QString::fromLatin1("Cannot introspect object %1 at %2:\n  %3 (%4)\n").arg(path).arg(
-                      service).arg(err.name()).arg(err.message()));
-        return doc;
-    }
+    Q_ASSERT(parent);
 
-    QDBusReply<QString> xml = iface.call(QLatin1String("Introspect"));
+    for (const QDBusIntrospectedItem &child : object) {
+        QDBusItem *item = new QDBusItem(child.type, child.name, parent);
+        parent->children.append(item);
 
-    if (!xml.isValid()) {
-        QDBusError err(xml.error());
-        if (err.isValid()) {
-            emit busError(QString::fromLatin1("Call to object %1 at %2:\n  %3 (%4) failed\n").arg(
-                        path).arg(service).arg(err.name()).arg(err.message()));
-        } else {
-            emit busError(QString::fromLatin1("Invalid XML received from object %1 at %2\n").arg(
-                    path).arg(service));
+        for (const QDBusIntrospectedMember &member : child.members) {
+            QDBusItem *memberItem = new QDBusItem(member.type, member.name, item);
+            switch (member.type) {
+            case MethodItem:
+                memberItem->caption = QLatin1String("Method: ") + member.name;
+                memberItem->typeSignature = member.typeSignature;
+                break;
+            case SignalItem:
+                memberItem->caption = QLatin1String("Signal: ") + member.name;
+                break;
+            case PropertyItem:
+                memberItem->caption = QLatin1String("Property: ") + member.name;
+                break;
+            default:
+                break;
+            }
+            item->children.append(memberItem);
         }
-        return doc;
     }
 
-    doc.setContent(xml.value());
-    return doc;
+    parent->isPrefetched = true;
+    parent->isFetching = false;
 }
 
-void QDBusModel::addMethods(QDBusItem *parent, const QDomElement &iface)
+QDBusItem *QDBusModel::pathItem(const QString &path) const
 {
-    Q_ASSERT(parent);
-
-    QDomElement child = iface.firstChildElement();
-    while (!child.isNull()) {
-        QDBusItem *item = nullptr;
-        if (child.tagName() == QLatin1String("method")) {
-            item = new QDBusItem(QDBusModel::MethodItem,
-                    child.attribute(QLatin1String("name")), parent);
-            item->caption = QLatin1String("Method: ") + item->name;
-            //get "type" from <arg> where "direction" is "in"
-            QDomElement n = child.firstChildElement();
-            while (!n.isNull()) {
-                if (n.attribute(QLatin1String("direction")) == QLatin1String("in"))
-                    item->typeSignature += n.attribute(QLatin1String("type"));
-                n = n.nextSiblingElement();
+    QDBusItem *item = root;
+    const QStringList branches = path.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+    for (const QString &branch : branches) {
+        const QString name = branch + QLatin1Char('/');
+        QDBusItem *next = nullptr;
+        for (QDBusItem *child : std::as_const(item->children)) {
+            if (child->type == PathItem && child->name == name) {
+                next = child;
+                break;
             }
-        } else if (child.tagName() == QLatin1String("signal")) {
-            item = new QDBusItem(QDBusModel::SignalItem,
-                    child.attribute(QLatin1String("name")), parent);
-            item->caption = QLatin1String("Signal: ") + item->name;
-        } else if (child.tagName() == QLatin1String("property")) {
-            item = new QDBusItem(QDBusModel::PropertyItem,
-                    child.attribute(QLatin1String("name")), parent);
-            item->caption = QLatin1String("Property: ") + item->name;
-        } else {
-            qDebug() << "addMethods: unknown tag:" << child.tagName();
         }
-        if (item)
-            parent->children.append(item);
-
-        child = child.nextSiblingElement();
+        if (!next)
+            return nullptr;
+        item = next;
     }
+    return item;
 }
 
-void QDBusModel::addPath(QDBusItem *parent)
+QModelIndex QDBusModel::indexForItem(QDBusItem *item) const
 {
-    Q_ASSERT(parent);
+    if (!item || !item->parent)
+        return QModelIndex();
+    return createIndex(item->parent->children.indexOf(item), 0, item);
+}
 
-    QString path = parent->path();
+void QDBusModel::introspected(const QString &aService, const QString &path,
+                              const QDBusIntrospectedObject &object)
+{
+    if (aService != service)
+        return;
 
-    QDomDocument doc = introspect(path);
-    QDomElement node = doc.documentElement();
-    QDomElement child = node.firstChildElement();
-    while (!child.isNull()) {
-        if (child.tagName() == QLatin1String("node")) {
-            QDBusItem *item = new QDBusItem(QDBusModel::PathItem,
-                        child.attribute(QLatin1String("name")) + QLatin1Char('/'), parent);
-            parent->children.append(item);
+    QDBusItem *item = pathItem(path);
+    if (!item || !item->isFetching)
+        return;
 
-            addMethods(item, child);
-        } else if (child.tagName() == QLatin1String("interface")) {
-            QDBusItem *item = new QDBusItem(QDBusModel::InterfaceItem,
-                        child.attribute(QLatin1String("name")), parent);
-            parent->children.append(item);
+    if (!object.isEmpty()) {
+        beginInsertRows(indexForItem(item), 0, object.size() - 1);
+        addPath(item, object);
+        endInsertRows();
+    } else {
+        addPath(item, object);
+    }
 
-            addMethods(item, child);
-        } else {
-            qDebug() << "addPath: Unknown tag name:" << child.tagName();
-        }
-        child = child.nextSiblingElement();
+    // Expanding one of the children should not have to wait for the bus
+    for (const QDBusItem *child : std::as_const(item->children)) {
+        if (child->type == PathItem)
+            introspector->introspect(service, child->path());
     }
 
-    parent->isPrefetched = true;
+    findPendingObject();
 }
 
-QDBusModel::QDBusModel(const QString &aService, const QDBusConnection &connection)
-    : service(aService), c(connection), root(0)
+void QDBusModel::introspectionFailed(const QString &aService, const QString &path,
+                                     const QString &text)
+{
+    if (aService != service)
+        return;
+
+    QDBusItem *item = pathItem(path);
+    if (!item || !item->isFetching)
+        return;
+
+    emit busError(text);
+    item->isPrefetched = true;
+    item->isFetching = false;
+
+    findPendingObject();
+}
+
+QDBusModel::QDBusModel(const QString &aService, const QDBusConnection &connection,
+                       QDBusIntrospector *anIntrospector)
+    : service(aService), c(connection), introspector(anIntrospector), root(0)
 {
     root = new QDBusItem(QDBusModel::PathItem, QLatin1String("/"));
+
+    connect(introspector, &QDBusIntrospector::introspected, this, &QDBusModel::introspected);
+    connect(introspector, &QDBusIntrospector::introspectionFailed,
+            this, &QDBusModel::introspectionFailed);
+    fetchMore(QModelIndex());
 }
 
 QDBusModel::~QDBusModel()
@@ -180,8 +190,6 @@ int QDBusModel::rowCount(const QModelIndex &parent) const
     QDBusItem *item = static_cast<QDBusItem *>(parent.internalPointer());
     if (!item)
         item = root;
-    if (!item->isPrefetched)
-        const_cast<QDBusModel *>(this)->addPath(item);
 
     return item->children.size();
 }
@@ -191,6 +199,50 @@ int QDBusModel::columnCount(const QModelIndex &) const
     return 1;
 }
 
+bool QDBusModel::hasChildren(const QModelIndex &parent) const
+{
+    const QDBusItem *item = static_cast<QDBusItem *>(parent.internalPointer());
+    if (!item)
+        item = root;
+
+    // Objects are only introspected when they are expanded
+    return !item->isPrefetched || !item->children.isEmpty();
+}
+
+bool QDBusModel::canFetchMore(const QModelIndex &parent) const
+{
+    const QDBusItem *item = static_cast<QDBusItem *>(parent.internalPointer());
+    if (!item)
+        item = root;
+
+    return !item->isPrefetched && !item->isFetching;
+}
+
+void QDBusModel::fetchMore(const QModelIndex &parent)
+{
+    QDBusItem *item = static_cast<QDBusItem *>(parent.internalPointer());
+    if (!item)
+        item = root;
+    if (item->isPrefetched || item->isFetching)
+        return;
+
+    const QString path = item->path();
+    QDBusIntrospectedObject object;
+    if (introspector->cachedObject(service, path, &object)) {
+        if (!object.isEmpty()) {
+            beginInsertRows(parent, 0, object.size() - 1);
+            addPath(item, object);
+            endInsertRows();
+        } else {
+            addPath(item, object);
+        }
+        return;
+    }
+
+    item->isFetching = true;
+    introspector->introspect(service, path);
+}
+
 QVariant QDBusModel::data(const QModelIndex &index, int role) const
 {
     const QDBusItem *item = static_cast<QDBusItem *>(index.internalPointer());
@@ -235,11 +287,10 @@ void QDBusModel::refresh(const QModelIndex &aIndex)
         endRemoveRows();
     }
 
-    addPath(item);
-    if (!item->children.isEmpty()) {
-        beginInsertRows(index, 0, item->children.size() - 1);
-        endInsertRows();
-    }
+    item->isPrefetched = false;
+    item->isFetching = false;
+    introspector->invalidatePrefix(service, item->path());
+    fetchMore(index);
 }
 
 QString QDBusModel::dBusPath(const QModelIndex &aIndex) const
@@ -280,39 +331,44 @@ QString QDBusModel::dBusTypeSignature(const QModelIndex &index) const
     return item ? item->typeSignature : QString();
 }
 
-QModelIndex QDBusModel::findObject(const QDBusObjectPath &objectPath)
+void QDBusModel::findObject(const QDBusObjectPath &objectPath)
+{
+    pendingObject = objectPath.path();
+    findPendingObject();
+}
+
+void QDBusModel::findPendingObject()
 {
-    QStringList path = objectPath.path().split(QLatin1Char('/'), Qt::SkipEmptyParts);
+    if (pendingObject.isEmpty())
+        return;
+
+    QStringList path = pendingObject.split(QLatin1Char('/'), Qt::SkipEmptyParts);
 
     QDBusItem *item = root;
-    int childIdx = -1;
     while (item && !path.isEmpty()) {
+        // fetch the branch, and continue once it is introspected
+        if (!item->isPrefetched) {
+            fetchMore(indexForItem(item));
+            if (!item->isPrefetched)
+                return;
+        }
+
         const QString branch = path.takeFirst() + QLatin1Char('/');
-        childIdx = -1;
+        QDBusItem *next = nullptr;
 
         // do a linear search over all the children
-        for (int i = 0; i < item->children.size(); ++i) {
-            QDBusItem *child = item->children.at(i);
+        for (QDBusItem *child : std::as_const(item->children)) {
             if (child->type == PathItem && child->name == branch) {
-                item = child;
-                childIdx = i;
-
-                // prefetch the found branch
-                if (!item->isPrefetched)
-                    addPath(item);
+                next = child;
                 break;
             }
         }
-
-        // branch not found - bail out
-        if (childIdx == -1)
-            return QModelIndex();
+        item = next;
     }
 
-    // found the right item
-    if (childIdx != -1 && item && path.isEmpty())
-        return createIndex(childIdx, 0, item);
+    pendingObject.clear();
 
-    return QModelIndex();
+    // found the right item
+    if (item && item != root)
+        emit objectFound(indexForItem(item));
 }
-
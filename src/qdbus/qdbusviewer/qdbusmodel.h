@@ -8,9 +8,9 @@
 #include <QtDBus/QDBusConnection>
 
 struct QDBusItem;
+struct QDBusIntrospectedItem;
+class QDBusIntrospector;
 
-QT_FORWARD_DECLARE_CLASS(QDomDocument);
-QT_FORWARD_DECLARE_CLASS(QDomElement);
 QT_FORWARD_DECLARE_CLASS(QDBusObjectPath)
 
 
@@ -21,7 +21,8 @@ class QDBusModel: public QAbstractItemModel
 public:
     enum Type { InterfaceItem, PathItem, MethodItem, SignalItem, PropertyItem };
 
-    QDBusModel(const QString &service, const QDBusConnection &connection);
+    QDBusModel(const QString &service, const QDBusConnection &connection,
+               QDBusIntrospector *introspector);
     ~QDBusModel();
 
 
@@ -29,6 +30,9 @@ public:
     QModelIndex parent(const QModelIndex &child) const override;
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
 
@@ -40,19 +44,27 @@ public:
 
     void refresh(const QModelIndex &index = QModelIndex());
 
-    QModelIndex findObject(const QDBusObjectPath &objectPath);
+    // Emits objectFound() once the path to the object is introspected
+    void findObject(const QDBusObjectPath &objectPath);
 
 Q_SIGNALS:
     void busError(const QString &text);
+    void objectFound(const QModelIndex &index);
 
 private:
-    QDomDocument introspect(const QString &path);
-    void addMethods(QDBusItem *parent, const QDomElement &iface);
-    void addPath(QDBusItem *parent);
+    QDBusItem *pathItem(const QString &path) const;
+    QModelIndex indexForItem(QDBusItem *item) const;
+    void addPath(QDBusItem *parent, const QList<QDBusIntrospectedItem> &object);
+    void introspected(const QString &aService, const QString &path,
+                      const QList<QDBusIntrospectedItem> &object);
+    void introspectionFailed(const QString &aService, const QString &path, const QString &text);
+    void findPendingObject();
 
     QString service;
     QDBusConnection c;
+    QDBusIntrospector *introspector;
     QDBusItem *root;
+    QString pendingObject;
 };
 
 #endif
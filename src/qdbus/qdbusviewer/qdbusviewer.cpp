@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include "qdbusviewer.h"
+#include "qdbusintrospector.h"
 #include "qdbusmodel.h"
 #include "servicesproxymodel.h"
 #include "propertydialog.h"
@@ -34,8 +35,9 @@
 class QDBusViewModel: public QDBusModel
 {
 public:
-    inline QDBusViewModel(const QString &service, const QDBusConnection &connection)
-        : QDBusModel(service, connection)
+    inline QDBusViewModel(const QString &service, const QDBusConnection &connection,
+                          QDBusIntrospector *introspector)
+        : QDBusModel(service, connection, introspector)
     {}
 
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
@@ -65,6 +67,7 @@ public:
 QDBusViewer::QDBusViewer(const QDBusConnection &connection, QWidget *parent)  :
     QWidget(parent),
     c(connection),
+    introspector(new QDBusIntrospector(connection, this)),
     objectPathRegExp(QLatin1String("\\[ObjectPath: (.*)\\]"))
 {
     serviceFilterLine = new QLineEdit(this);
@@ -478,9 +481,10 @@ void QDBusViewer::serviceChanged(const QModelIndex &index)
         return;
     currentService = index.data().toString();
 
-    QDBusViewModel *model = new QDBusViewModel(currentService, c);
+    QDBusViewModel *model = new QDBusViewModel(currentService, c, introspector);
     tree->setModel(model);
     connect(model, &QDBusModel::busError, this, &QDBusViewer::logError);
+    connect(model, &QDBusModel::objectFound, this, &QDBusViewer::objectFound);
 }
 
 void QDBusViewer::serviceRegistered(const QString &service)
@@ -503,6 +507,8 @@ static QModelIndex findItem(QStringListModel *servicesModel, const QString &name
 
 void QDBusViewer::serviceUnregistered(const QString &name)
 {
+    introspector->invalidate(name);
+
     QModelIndex hit = findItem(servicesModel, name);
     if (!hit.isValid())
         return;
@@ -512,6 +518,8 @@ void QDBusViewer::serviceUnregistered(const QString &name)
 void QDBusViewer::serviceOwnerChanged(const QString &name, const QString &oldOwner,
                                       const QString &newOwner)
 {
+    introspector->invalidate(name);
+
     QModelIndex hit = findItem(servicesModel, name);
 
     if (!hit.isValid() && oldOwner.isEmpty() && !newOwner.isEmpty())
@@ -554,10 +562,11 @@ void QDBusViewer::anchorClicked(const QUrl &url)
     if (!model)
         return;
 
-    QModelIndex idx = model->findObject(QDBusObjectPath(url.path()));
-    if (!idx.isValid())
-        return;
+    model->findObject(QDBusObjectPath(url.path()));
+}
 
-    tree->scrollTo(idx);
-    tree->setCurrentIndex(idx);
+void QDBusViewer::objectFound(const QModelIndex &index)
+{
+    tree->scrollTo(index);
+    tree->setCurrentIndex(index);
 }
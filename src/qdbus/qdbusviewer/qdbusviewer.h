@@ -8,6 +8,7 @@
 #include <QtDBus/QDBusConnection>
 #include <QtCore/QRegularExpression>
 
+class QDBusIntrospector;
 class ServicesProxyModel;
 
 QT_FORWARD_DECLARE_CLASS(QTableView)
@@ -59,6 +60,7 @@ private slots:
 
     void logError(const QString &msg);
     void anchorClicked(const QUrl &url);
+    void objectFound(const QModelIndex &index);
 
 private:
     void logMessage(const QString &msg);
@@ -66,6 +68,7 @@ private:
     bool eventFilter(QObject *obj, QEvent *event) override;
 
     QDBusConnection c;
+    QDBusIntrospector *introspector;
     QString currentService;
     QTreeView *tree;
     QAction *refreshAction;
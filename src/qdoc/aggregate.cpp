@@ -3,6 +3,7 @@
 
 #include "aggregate.h"
 
+#include "enumnode.h"
 #include "functionnode.h"
 #include "parameters.h"
 #include "typedefnode.h"
@@ -729,6 +730,32 @@ void Aggregate::findAllAttributions(NodeMultiMap &attributions)
     }
 }
 
+/*!
+  Inserts into \a names every name that a child of this node can be
+  found by, including the values of its enums. Call the function
+  recursively for each child that is an aggregate.
+
+  A search for a name that isn't in the set from any tree can't
+  succeed, so QDocDatabase uses it to skip such searches.
+ */
+void Aggregate::findAllChildNames(QSet<QString> &names) const
+{
+    for (auto it = m_nonfunctionMap.cbegin(); it != m_nonfunctionMap.cend(); ++it)
+        names.insert(it.key());
+    for (auto it = m_functionMap.cbegin(); it != m_functionMap.cend(); ++it)
+        names.insert(it.key());
+    for (const auto *node : m_enumChildren) {
+        for (const auto &item : static_cast<const EnumNode *>(node)->items())
+            names.insert(item.name());
+    }
+    for (const auto *node : m_children) {
+        names.insert(node->name());
+        // Adopted children are visited through their new parent
+        if (node->isAggregate() && node->parent() == this)
+            static_cast<const Aggregate *>(node)->findAllChildNames(names);
+    }
+}
+
 /*!
   Finds all the nodes in this node where a \e{since} command appeared
   in the qdoc comment and sorts them into maps according to the kind
@@ -9,6 +9,7 @@
 #include <optional>
 
 #include <QtCore/qglobal.h>
+#include <QtCore/qset.h>
 #include <QtCore/qstringlist.h>
 
 QT_BEGIN_NAMESPACE
@@ -57,6 +58,7 @@ public:
     void findAllFunctions(NodeMapMap &functionIndex);
     void findAllNamespaces(NodeMultiMap &namespaces);
     void findAllAttributions(NodeMultiMap &attributions);
+    void findAllChildNames(QSet<QString> &names) const;
     [[nodiscard]] bool hasObsoleteMembers() const;
     void findAllObsoleteThings();
     void findAllClasses();
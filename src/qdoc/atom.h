@@ -183,6 +183,7 @@ public:
     }
     const QString &error() override { return m_error; }
     void resolveSquareBracketParams() override;
+    [[nodiscard]] const QString &squareBracketParams() const { return m_squareBracketParams; }
 
 protected:
     bool m_resolved {};
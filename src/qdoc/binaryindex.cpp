@@ -0,0 +1,295 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "binaryindex.h"
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qsavefile.h>
+
+QT_BEGIN_NAMESPACE
+
+static const quint32 s_binaryIndexMagic = 0x51444958; // "QDIX"
+static const quint32 s_binaryIndexVersion = 1;
+
+enum HeaderWord {
+    Magic,
+    Version,
+    XmlSizeLow,
+    XmlSizeHigh,
+    XmlModifiedLow,
+    XmlModifiedHigh,
+    StringCount,
+    CharCount,
+    WordCount,
+    HeaderSize
+};
+
+/*!
+  \class BinaryIndexReader
+  \internal
+  \brief The BinaryIndexReader class reads the binary form of a
+  QDoc index file.
+
+  When QDoc writes an index file, it also writes a binary form of
+  it next to it, see write(). The binary form holds the same tree
+  of elements and attributes as the XML file, without any of the
+  XML syntax: all the strings are stored once, in UTF-16, and the
+  elements refer to them by number. The binary file is mapped into
+  memory, so that element names are not copied, and attributes are
+  only copied when asked for.
+
+  BinaryIndexReader provides the subset of the QXmlStreamReader API
+  that QDocIndexFiles uses for reading index files, and reports the
+  same sequence of start and end elements as QXmlStreamReader would
+  for the XML file, so that both can be read by the same code.
+
+  The binary form records the size and modification time of the XML
+  file it was made from. If the XML file has changed since, or if
+  the binary file is missing or damaged, isValid() returns \c false
+  and the XML file should be read instead.
+ */
+
+/*!
+  Opens and maps the binary form of the index file \a indexPath.
+ */
+BinaryIndexReader::BinaryIndexReader(const QString &indexPath) : m_file(binaryPath(indexPath))
+{
+    const QFileInfo xmlInfo(indexPath);
+    if (!xmlInfo.exists() || !m_file.open(QIODevice::ReadOnly))
+        return;
+
+    const qint64 size = m_file.size();
+    if (size < qint64(HeaderSize * sizeof(quint32)))
+        return;
+
+    const uchar *data = m_map = m_file.map(0, size);
+    if (!m_map) {
+        m_data = m_file.readAll();
+        data = reinterpret_cast<const uchar *>(m_data.constData());
+    }
+    const auto *header = reinterpret_cast<const quint32 *>(data);
+    const qint64 xmlSize = qint64(header[XmlSizeLow]) | (qint64(header[XmlSizeHigh]) << 32);
+    const qint64 xmlModified =
+            qint64(header[XmlModifiedLow]) | (qint64(header[XmlModifiedHigh]) << 32);
+    if (header[Magic] != s_binaryIndexMagic || header[Version] != s_binaryIndexVersion
+        || xmlSize != xmlInfo.size()
+        || xmlModified != xmlInfo.lastModified().toMSecsSinceEpoch()) {
+        return;
+    }
+
+    const qint64 expectedSize = qint64(HeaderSize + 2 * qint64(header[StringCount])
+                                       + header[WordCount]) * qint64(sizeof(quint32))
+            + qint64(header[CharCount]) * qint64(sizeof(char16_t));
+    if (expectedSize != size)
+        return;
+
+    m_stringCount = header[StringCount];
+    m_charCount = header[CharCount];
+    m_wordCount = header[WordCount];
+    m_stringTable = header + HeaderSize;
+    m_words = m_stringTable + 2 * m_stringCount;
+    m_chars = reinterpret_cast<const char16_t *>(m_words + m_wordCount);
+
+    // The document contains one root element
+    m_remainingChildren << 1;
+}
+
+BinaryIndexReader::~BinaryIndexReader()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+}
+
+/*!
+  Returns the path of the binary form of the index file \a indexPath.
+ */
+QString BinaryIndexReader::binaryPath(const QString &indexPath)
+{
+    return indexPath + QLatin1String(".bin");
+}
+
+/*!
+  Writes the binary form of the index file \a indexPath next to it.
+  Returns \c true on success.
+ */
+bool BinaryIndexReader::write(const QString &indexPath)
+{
+    QFile xmlFile(indexPath);
+    if (!xmlFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QHash<QString, quint32> ids;
+    QList<quint32> stringTable;
+    QString chars;
+    const auto stringId = [&](QStringView string) {
+        auto it = ids.constFind(string.toString());
+        if (it != ids.cend())
+            return *it;
+        const quint32 id = ids.size();
+        ids.insert(string.toString(), id);
+        stringTable << quint32(chars.size()) << quint32(string.size());
+        chars += string;
+        return id;
+    };
+
+    // Each element is stored as its name, its attributes, and its number
+    // of child elements, followed by its child elements.
+    QList<quint32> words;
+    QList<qsizetype> openElements;
+    QXmlStreamReader reader(&xmlFile);
+    reader.setNamespaceProcessing(false);
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            if (openElements.isEmpty() && !words.isEmpty())
+                return false; // More than one root element
+            if (!openElements.isEmpty())
+                ++words[openElements.last()];
+            words << stringId(reader.name());
+            const QXmlStreamAttributes attributes = reader.attributes();
+            words << quint32(attributes.size());
+            for (const auto &attribute : attributes)
+                words << stringId(attribute.qualifiedName()) << stringId(attribute.value());
+            openElements << words.size();
+            words << 0;
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            openElements.removeLast();
+            break;
+        default:
+            break;
+        }
+    }
+    if (reader.hasError() || words.isEmpty())
+        return false;
+
+    const QFileInfo xmlInfo(xmlFile);
+    const qint64 xmlModified = xmlInfo.lastModified().toMSecsSinceEpoch();
+    const quint32 header[HeaderSize] = {
+        s_binaryIndexMagic,
+        s_binaryIndexVersion,
+        quint32(xmlInfo.size()),
+        quint32(xmlInfo.size() >> 32),
+        quint32(xmlModified),
+        quint32(xmlModified >> 32),
+        quint32(ids.size()),
+        quint32(chars.size()),
+        quint32(words.size()),
+    };
+
+    QSaveFile file(binaryPath(indexPath));
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    file.write(reinterpret_cast<const char *>(header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(stringTable.constData()),
+               stringTable.size() * sizeof(quint32));
+    file.write(reinterpret_cast<const char *>(words.constData()), words.size() * sizeof(quint32));
+    file.write(reinterpret_cast<const char *>(chars.constData()), chars.size() * sizeof(char16_t));
+    return file.commit();
+}
+
+/*!
+  Returns the string with the number \a id, or an empty view if the
+  file is damaged.
+ */
+QStringView BinaryIndexReader::string(quint32 id) const
+{
+    if (id >= m_stringCount)
+        return {};
+    const quint32 offset = m_stringTable[2 * id];
+    const quint32 length = m_stringTable[2 * id + 1];
+    if (offset > m_charCount || length > m_charCount - offset)
+        return {};
+    return QStringView(m_chars + offset, length);
+}
+
+/*!
+  Reads the next start or end element, and returns its type. Returns
+  QXmlStreamReader::EndDocument after the end of the root element, and
+  QXmlStreamReader::Invalid if the file is damaged.
+ */
+QXmlStreamReader::TokenType BinaryIndexReader::readNext()
+{
+    if (m_token == QXmlStreamReader::EndDocument || m_token == QXmlStreamReader::Invalid)
+        return m_token;
+
+    if (m_token == QXmlStreamReader::StartElement)
+        m_remainingChildren << m_childCount;
+
+    if (m_remainingChildren.isEmpty())
+        return m_token = QXmlStreamReader::Invalid;
+
+    if (m_remainingChildren.last() == 0) {
+        m_remainingChildren.removeLast();
+        m_name = QStringView();
+        return m_token = m_remainingChildren.isEmpty() ? QXmlStreamReader::EndDocument
+                                                       : QXmlStreamReader::EndElement;
+    }
+
+    --m_remainingChildren.last();
+    if (m_wordCount - m_pos < 3)
+        return m_token = QXmlStreamReader::Invalid;
+    m_name = string(m_words[m_pos]);
+    m_attributeCount = m_words[m_pos + 1];
+    m_attributePos = m_pos + 2;
+    if (m_attributeCount > (m_wordCount - m_attributePos - 1) / 2)
+        return m_token = QXmlStreamReader::Invalid;
+    m_pos = m_attributePos + 2 * m_attributeCount;
+    m_childCount = m_words[m_pos++];
+    return m_token = QXmlStreamReader::StartElement;
+}
+
+/*!
+  Reads until the next start element within the current element.
+  Returns \c true if a start element was reached, and \c false if
+  the end of the current element was reached instead.
+
+  \sa QXmlStreamReader::readNextStartElement()
+ */
+bool BinaryIndexReader::readNextStartElement()
+{
+    while (readNext() != QXmlStreamReader::Invalid) {
+        if (m_token == QXmlStreamReader::EndElement || m_token == QXmlStreamReader::EndDocument)
+            return false;
+        if (m_token == QXmlStreamReader::StartElement)
+            return true;
+    }
+    return false;
+}
+
+/*!
+  Reads until the end of the current element, skipping its children.
+
+  \sa QXmlStreamReader::skipCurrentElement()
+ */
+void BinaryIndexReader::skipCurrentElement()
+{
+    int depth = 1;
+    while (depth && readNext() != QXmlStreamReader::Invalid) {
+        if (m_token == QXmlStreamReader::EndElement)
+            --depth;
+        else if (m_token == QXmlStreamReader::StartElement)
+            ++depth;
+    }
+}
+
+/*!
+  Returns the attributes of the current start element.
+ */
+QXmlStreamAttributes BinaryIndexReader::attributes() const
+{
+    QXmlStreamAttributes attributes;
+    if (m_token != QXmlStreamReader::StartElement)
+        return attributes;
+    attributes.reserve(m_attributeCount);
+    for (quint32 i = 0; i < m_attributeCount; ++i) {
+        const quint32 pos = m_attributePos + 2 * i;
+        attributes.append(string(m_words[pos]).toString(), string(m_words[pos + 1]).toString());
+    }
+    return attributes;
+}
+
+QT_END_NAMESPACE
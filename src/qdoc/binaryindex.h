@@ -0,0 +1,58 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef BINARYINDEX_H
+#define BINARYINDEX_H
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qxmlstream.h>
+
+QT_BEGIN_NAMESPACE
+
+class BinaryIndexReader
+{
+public:
+    explicit BinaryIndexReader(const QString &indexPath);
+    ~BinaryIndexReader();
+
+    static QString binaryPath(const QString &indexPath);
+    static bool write(const QString &indexPath);
+
+    [[nodiscard]] bool isValid() const { return m_words != nullptr; }
+
+    QXmlStreamReader::TokenType readNext();
+    bool readNextStartElement();
+    void skipCurrentElement();
+    [[nodiscard]] bool isEndElement() const { return m_token == QXmlStreamReader::EndElement; }
+    [[nodiscard]] QStringView name() const { return m_name; }
+    [[nodiscard]] QXmlStreamAttributes attributes() const;
+
+private:
+    [[nodiscard]] QStringView string(quint32 id) const;
+
+    QFile m_file;
+    uchar *m_map { nullptr };
+    QByteArray m_data {};
+
+    const quint32 *m_words { nullptr };
+    quint32 m_wordCount { 0 };
+    const quint32 *m_stringTable { nullptr };
+    quint32 m_stringCount { 0 };
+    const char16_t *m_chars { nullptr };
+    quint32 m_charCount { 0 };
+
+    QXmlStreamReader::TokenType m_token { QXmlStreamReader::StartDocument };
+    quint32 m_pos { 0 };
+    quint32 m_attributePos { 0 };
+    quint32 m_attributeCount { 0 };
+    quint32 m_childCount { 0 };
+    QStringView m_name {};
+    QList<quint32> m_remainingChildren {};
+};
+
+QT_END_NAMESPACE
+
+#endif // BINARYINDEX_H
@@ -7,6 +7,7 @@
 #include "classnode.h"
 #include "codechunk.h"
 #include "config.h"
+#include "doccache.h"
 #include "enumnode.h"
 #include "functionnode.h"
 #include "namespacenode.h"
@@ -16,17 +17,23 @@
 #include "utilities.h"
 #include "variablenode.h"
 
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdatetime.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qfile.h>
+#include <QtCore/qsavefile.h>
 #include <QtCore/qscopedvaluerollback.h>
 #include <QtCore/qtemporarydir.h>
+#include <QtCore/qtemporaryfile.h>
 #include <QtCore/qtextstream.h>
 #include <QtCore/qvarlengtharray.h>
 
 #include <clang-c/Index.h>
 
 #include <cstdio>
+#include <filesystem>
 
 QT_BEGIN_NAMESPACE
 
@@ -1242,6 +1249,7 @@ void ClangCodeParser::initializeParser()
  */
 void ClangCodeParser::terminateParser()
 {
+    discardPendingParses();
     CppCodeParser::terminateParser();
 }
 
@@ -1377,6 +1385,154 @@ void ClangCodeParser::getMoreArgs()
     }
 }
 
+/*
+  A file included by a cached PCH, identified the same way as
+  clang does when it checks whether a PCH is out of date.
+ */
+struct PCHDependency
+{
+    QString path {};
+    qint64 size { 0 };
+    qint64 modified { 0 };
+};
+
+static QDataStream &operator<<(QDataStream &out, const PCHDependency &dependency)
+{
+    return out << dependency.path << dependency.size << dependency.modified;
+}
+
+static QDataStream &operator>>(QDataStream &in, PCHDependency &dependency)
+{
+    return in >> dependency.path >> dependency.size >> dependency.modified;
+}
+
+/*!
+  Returns the directory where the PCH for a module header with the
+  contents \a headerContent, built with the command line arguments
+  \a args, is kept between runs. The directory name is a hash of
+  everything that affects the PCH, including the version of clang.
+
+  Returns an empty string if the \c cachedir configuration variable
+  is not set or the directory cannot be created.
+ */
+static QString pchCacheDir(const QByteArray &headerContent, const std::vector<const char *> &args)
+{
+    const QString cacheDir = Config::instance().getString(CONFIG_CACHEDIR);
+    if (cacheDir.isEmpty())
+        return QString();
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArrayView(QT_VERSION_STR));
+    hash.addData(fromCXString(clang_getClangVersion()).toUtf8());
+    hash.addData(QByteArray::number(static_cast<int>(flags_)));
+    for (const char *arg : args) {
+        hash.addData(QByteArrayView(arg));
+        hash.addData(QByteArrayView("\0", 1));
+    }
+    hash.addData(headerContent);
+
+    const QString dir = cacheDir + QLatin1String("/pch/") + QString::fromLatin1(hash.result().toHex());
+    if (!QDir().mkpath(dir)) {
+        qCWarning(lcQdoc) << "Cannot create PCH cache directory" << dir;
+        return QString();
+    }
+    return dir;
+}
+
+/*!
+  Returns \c true if the PCH file \a pchName exists, and none of the
+  files that were included when building it has changed since then.
+ */
+static bool isCachedPCHUpToDate(const QString &pchName)
+{
+    if (!QFile::exists(pchName))
+        return false;
+    QFile file(pchName + QLatin1String(".deps"));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    QList<PCHDependency> dependencies;
+    in >> dependencies;
+    if (in.status() != QDataStream::Ok || dependencies.isEmpty())
+        return false;
+
+    for (const auto &dependency : std::as_const(dependencies)) {
+        const QFileInfo fileInfo(dependency.path);
+        if (!fileInfo.exists() || fileInfo.size() != dependency.size
+            || fileInfo.lastModified().toMSecsSinceEpoch() != dependency.modified) {
+            qCDebug(lcQdoc) << "Cached PCH" << pchName << "is out of date:" << dependency.path
+                            << "changed";
+            return false;
+        }
+    }
+    return true;
+}
+
+/*!
+  Records the size and modification time of the files included by
+  the translation unit \a tu, from which the PCH file \a pchName has
+  been built, so that isCachedPCHUpToDate() can tell whether the PCH
+  can be reused.
+ */
+static void writeCachedPCHDependencies(CXTranslationUnit tu, const QString &pchName)
+{
+    QList<PCHDependency> dependencies;
+    clang_getInclusions(
+            tu,
+            [](CXFile file, CXSourceLocation *, unsigned, CXClientData data) {
+                auto *dependencies = static_cast<QList<PCHDependency> *>(data);
+                const QFileInfo fileInfo(fromCXString(clang_getFileName(file)));
+                dependencies->append(PCHDependency { fileInfo.absoluteFilePath(), fileInfo.size(),
+                                                     fileInfo.lastModified().toMSecsSinceEpoch() });
+            },
+            &dependencies);
+
+    QSaveFile file(pchName + QLatin1String(".deps"));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << dependencies;
+    if (out.status() == QDataStream::Ok)
+        file.commit();
+}
+
+/*!
+  Saves the translation unit \a tu as the PCH file \a pchName in the
+  PCH cache. The cache can be shared by qdoc runs at the same time, so
+  the PCH is written to a temporary file in the same directory and then
+  renamed, and other runs never see a partially written PCH.
+
+  Returns \c true if the PCH was saved.
+ */
+static bool saveCachedPCH(CXTranslationUnit tu, const QString &pchName)
+{
+    QTemporaryFile tmpFile(pchName + QLatin1String(".XXXXXX"));
+    if (!tmpFile.open())
+        return false;
+    const QString tmpName = tmpFile.fileName();
+    tmpFile.close();
+
+    if (clang_saveTranslationUnit(tu, QFile::encodeName(tmpName).constData(),
+                                  clang_defaultSaveOptions(tu))
+        != CXSaveError_None) {
+        return false;
+    }
+
+    // Unlike QFile::rename(), this replaces an existing PCH atomically
+    std::error_code error;
+    std::filesystem::rename(std::filesystem::path(tmpName.toStdWString()),
+                            std::filesystem::path(pchName.toStdWString()), error);
+    if (error) {
+        qCWarning(lcQdoc) << "Cannot move PCH file to" << pchName << ":"
+                          << QString::fromStdString(error.message());
+        return false;
+    }
+    return true;
+}
+
 /*!
   Building the PCH must be possible when there are no .cpp
   files, so it is moved here to its own member function, and
@@ -1451,27 +1607,58 @@ void ClangCodeParser::buildPCH()
             }
             m_args.push_back("-xc++");
             CXTranslationUnit tu;
-            QString tmpHeader = m_pchFileDir->path() + "/" + module;
-            if (QFile tmpHeaderFile(tmpHeader); tmpHeaderFile.open(QIODevice::Text | QIODevice::WriteOnly)) {
-                QTextStream out(&tmpHeaderFile);
-                if (header.isEmpty()) {
-                    for (auto it = m_allHeaders.constKeyValueBegin();
-                         it != m_allHeaders.constKeyValueEnd(); ++it) {
-                        if (!(*it).first.endsWith(QLatin1String("_p.h"))
-                            && !(*it).first.startsWith(QLatin1String("moc_"))) {
-                            QString line = QLatin1String("#include \"") + (*it).second
-                                    + QLatin1String("/") + (*it).first + QLatin1String("\"");
-                            out << line << "\n";
-                        }
-                    }
-                } else {
-                    QFileInfo headerFile(header);
-                    if (!headerFile.exists()) {
-                        qWarning() << "Could not find module header file" << header;
-                        return;
+            QString headerContent;
+            if (header.isEmpty()) {
+                for (auto it = m_allHeaders.constKeyValueBegin();
+                     it != m_allHeaders.constKeyValueEnd(); ++it) {
+                    if (!(*it).first.endsWith(QLatin1String("_p.h"))
+                        && !(*it).first.startsWith(QLatin1String("moc_"))) {
+                        QString line = QLatin1String("#include \"") + (*it).second
+                                + QLatin1String("/") + (*it).first + QLatin1String("\"");
+                        headerContent += line + QLatin1String("\n");
                     }
-                    out << QLatin1String("#include \"") + header + QLatin1String("\"");
                 }
+            } else {
+                QFileInfo headerFile(header);
+                if (!headerFile.exists()) {
+                    qWarning() << "Could not find module header file" << header;
+                    return;
+                }
+                headerContent = QLatin1String("#include \"") + QString::fromUtf8(header)
+                        + QLatin1String("\"");
+            }
+
+            // Reuse the PCH built by an earlier run, if its inputs are unchanged
+            QString pchDir = m_pchFileDir->path();
+            const QString cacheDir = pchCacheDir(headerContent.toUtf8(), m_args);
+            if (!cacheDir.isEmpty())
+                pchDir = cacheDir;
+            const QString pchName = pchDir + "/" + module + ".pch";
+            if (!cacheDir.isEmpty() && isCachedPCHUpToDate(pchName)) {
+                CXErrorCode err = clang_createTranslationUnit2(index_, pchName.toUtf8().constData(), &tu);
+                qCDebug(lcQdoc) << __FUNCTION__ << "clang_createTranslationUnit2(" << pchName
+                                << ") returns" << err;
+                if (!err && tu) {
+                    m_pchName = pchName.toUtf8();
+                    CXCursor cur = clang_getTranslationUnitCursor(tu);
+                    ClangVisitor visitor(m_qdb, m_allHeaders);
+                    visitor.visitChildren(cur);
+                    qCDebug(lcQdoc) << "Cached PCH visited for" << moduleHeader();
+                    clang_disposeTranslationUnit(tu);
+                    m_args.pop_back(); // remove the "-xc++";
+                    return;
+                }
+                clang_disposeTranslationUnit(tu);
+            }
+            QFile::remove(pchName + QLatin1String(".deps"));
+
+            QString tmpHeader = pchDir + "/" + module;
+            if (QSaveFile tmpHeaderFile(tmpHeader); tmpHeaderFile.open(QIODevice::Text | QIODevice::WriteOnly)) {
+                {
+                    QTextStream out(&tmpHeaderFile);
+                    out << headerContent;
+                }
+                tmpHeaderFile.commit();
             }
 
             CXErrorCode err =
@@ -1484,13 +1671,22 @@ void ClangCodeParser::buildPCH()
             printDiagnostics(tu);
 
             if (!err && tu) {
-                m_pchName = m_pchFileDir->path().toUtf8() + "/" + module + ".pch";
-                auto error = clang_saveTranslationUnit(tu, m_pchName.constData(),
-                                                       clang_defaultSaveOptions(tu));
-                if (error) {
+                m_pchName = pchName.toUtf8();
+                bool saved;
+                if (cacheDir.isEmpty()) {
+                    saved = clang_saveTranslationUnit(tu, m_pchName.constData(),
+                                                      clang_defaultSaveOptions(tu))
+                            == CXSaveError_None;
+                } else {
+                    saved = saveCachedPCH(tu, pchName);
+                }
+                if (!saved) {
                     qCCritical(lcQdoc) << "Could not save PCH file for" << moduleHeader();
                     m_pchName.clear();
                 } else {
+                    // Written last, so the PCH is only reused once it is complete
+                    if (!cacheDir.isEmpty())
+                        writeCachedPCHDependencies(tu, pchName);
                     // Visit the header now, as token from pre-compiled header won't be visited
                     // later
                     CXCursor cur = clang_getTranslationUnitCursor(tu);
@@ -1535,6 +1731,124 @@ static float getUnpatchedVersion(QString t)
     return t.toFloat();
 }
 
+/*!
+  Returns the command line arguments used for parsing the source
+  file \a filePath against the precompiled module header.
+ */
+QList<QByteArray> ClangCodeParser::sourceFileArgs(const QString &filePath)
+{
+    getDefaultArgs();
+    if (!m_pchName.isEmpty() && !filePath.endsWith(".mm")) {
+        m_args.push_back("-w");
+        m_args.push_back("-include-pch");
+        m_args.push_back(m_pchName.constData());
+    }
+    getMoreArgs();
+    for (const auto &p : std::as_const(m_moreArgs))
+        m_args.push_back(p.constData());
+    return QList<QByteArray>(m_args.cbegin(), m_args.cend());
+}
+
+/*!
+  Runs clang on the source file \a filePath with the command line
+  arguments \a args, and returns the resulting translation unit along
+  with the index that owns it.
+
+  This function touches no state shared with the rest of QDoc, so it
+  can run on a worker thread. Each call creates its own CXIndex, as
+  libclang does not allow an index to be used from several threads
+  at once.
+ */
+ClangCodeParser::TranslationUnit ClangCodeParser::parseTranslationUnit(const QString &filePath,
+                                                                       const QList<QByteArray> &args)
+{
+    const auto flags = static_cast<CXTranslationUnit_Flags>(CXTranslationUnit_Incomplete
+                                                            | CXTranslationUnit_SkipFunctionBodies
+                                                            | CXTranslationUnit_KeepGoing);
+    std::vector<const char *> argv;
+    argv.reserve(args.size());
+    for (const auto &arg : args)
+        argv.push_back(arg.constData());
+
+    TranslationUnit unit;
+    unit.args = args;
+    unit.index = clang_createIndex(1, kClangDontDisplayDiagnostics);
+    unit.error = clang_parseTranslationUnit2(unit.index, filePath.toLocal8Bit(), argv.data(),
+                                             static_cast<int>(argv.size()), nullptr, 0, flags,
+                                             &unit.tu);
+    return unit;
+}
+
+/*!
+  Registers \a filePaths as the source files that will be passed to
+  parseSourceFile(), in the order in which they will be passed.
+
+  If \a jobs is greater than one, up to \a jobs translation units are
+  parsed ahead of time on worker threads, against the shared PCH built
+  by buildPCH(). Visiting the parsed translation units and processing
+  their documentation comments still happens in parseSourceFile(), in
+  the order of the calls, so the resulting tree is the same as for a
+  serial run.
+
+  Must be called after precompileHeaders().
+ */
+void ClangCodeParser::setSourceFilesToParse(const QStringList &filePaths, int jobs)
+{
+    discardPendingParses();
+    m_jobs = jobs;
+    if (m_jobs > 1)
+        m_sourceFileQueue = filePaths;
+    startPendingParses();
+}
+
+/*!
+  Starts parsing queued source files on worker threads until
+  the number of parses in flight reaches the job count.
+ */
+void ClangCodeParser::startPendingParses()
+{
+    while (m_pendingParses.size() < static_cast<size_t>(m_jobs) && !m_sourceFileQueue.isEmpty()) {
+        const QString filePath = m_sourceFileQueue.takeFirst();
+        m_pendingParses.emplace(filePath,
+                                std::async(std::launch::async, &ClangCodeParser::parseTranslationUnit,
+                                           filePath, sourceFileArgs(filePath)));
+    }
+}
+
+/*!
+  Waits for all parses in flight to finish and disposes of their
+  translation units. Clears the queue of source files to parse.
+ */
+void ClangCodeParser::discardPendingParses()
+{
+    m_sourceFileQueue.clear();
+    for (auto &[filePath, future] : m_pendingParses) {
+        TranslationUnit unit = future.get();
+        clang_disposeTranslationUnit(unit.tu);
+        clang_disposeIndex(unit.index);
+    }
+    m_pendingParses.clear();
+}
+
+/*!
+  Returns the translation unit for the source file \a filePath.
+  If the file was parsed ahead of time, waits for that parse to
+  finish; otherwise, parses the file on the calling thread.
+ */
+ClangCodeParser::TranslationUnit ClangCodeParser::takeTranslationUnit(const QString &filePath)
+{
+    TranslationUnit unit;
+    if (auto it = m_pendingParses.find(filePath); it != m_pendingParses.end()) {
+        unit = it->second.get();
+        m_pendingParses.erase(it);
+    } else {
+        m_sourceFileQueue.removeOne(filePath);
+        unit = parseTranslationUnit(filePath, sourceFileArgs(filePath));
+    }
+    startPendingParses();
+    return unit;
+}
+
 /*!
   Get ready to parse the C++ cpp file identified by \a filePath
   and add its parsed contents to the database. \a location is
@@ -1550,34 +1864,18 @@ void ClangCodeParser::parseSourceFile(const Location & /*location*/, const QStri
      */
     m_qdb->clearOpenNamespaces();
     m_currentFile = filePath;
-    flags_ = static_cast<CXTranslationUnit_Flags>(CXTranslationUnit_Incomplete
-                                                  | CXTranslationUnit_SkipFunctionBodies
-                                                  | CXTranslationUnit_KeepGoing);
-
-    index_ = clang_createIndex(1, kClangDontDisplayDiagnostics);
-
-    getDefaultArgs();
-    if (!m_pchName.isEmpty() && !filePath.endsWith(".mm")) {
-        m_args.push_back("-w");
-        m_args.push_back("-include-pch");
-        m_args.push_back(m_pchName.constData());
-    }
-    getMoreArgs();
-    for (const auto &p : std::as_const(m_moreArgs))
-        m_args.push_back(p.constData());
 
-    CXTranslationUnit tu;
-    CXErrorCode err =
-            clang_parseTranslationUnit2(index_, filePath.toLocal8Bit(), m_args.data(),
-                                        static_cast<int>(m_args.size()), nullptr, 0, flags_, &tu);
-    qCDebug(lcQdoc) << __FUNCTION__ << "clang_parseTranslationUnit2(" << filePath << m_args
+    TranslationUnit unit = takeTranslationUnit(filePath);
+    CXTranslationUnit tu = unit.tu;
+    const auto err = static_cast<CXErrorCode>(unit.error);
+    qCDebug(lcQdoc) << __FUNCTION__ << "clang_parseTranslationUnit2(" << filePath << unit.args
                     << ") returns" << err;
     printDiagnostics(tu);
 
     if (err || !tu) {
         qWarning() << "(qdoc) Could not parse source file" << filePath << " error code:" << err;
         clang_disposeTranslationUnit(tu);
-        clang_disposeIndex(index_);
+        clang_disposeIndex(unit.index);
         return;
     }
 
@@ -1585,27 +1883,10 @@ void ClangCodeParser::parseSourceFile(const Location & /*location*/, const QStri
     ClangVisitor visitor(m_qdb, m_allHeaders);
     visitor.visitChildren(tuCur);
 
-    CXToken *tokens;
-    unsigned int numTokens = 0;
-    const QSet<QString> &commands = topicCommands() + metaCommands();
-    clang_tokenize(tu, clang_getCursorExtent(tuCur), &tokens, &numTokens);
-
-    for (unsigned int i = 0; i < numTokens; ++i) {
-        if (clang_getTokenKind(tokens[i]) != CXToken_Comment)
-            continue;
-        QString comment = fromCXString(clang_getTokenSpelling(tu, tokens[i]));
-        if (!comment.startsWith("/*!"))
-            continue;
-
-        auto commentLoc = clang_getTokenLocation(tu, tokens[i]);
-        auto loc = fromCXSourceLocation(commentLoc);
-        auto end_loc = fromCXSourceLocation(clang_getRangeEnd(clang_getTokenExtent(tu, tokens[i])));
-        Doc::trimCStyleComment(loc, comment);
-
-        // Doc constructor parses the comment.
-        Doc doc(loc, end_loc, comment, commands, topicCommands());
+    const auto processComment = [&](const Doc &doc, CXSourceLocation commentLoc,
+                                    const CXSourceLocation *nextCommentLoc) {
         if (hasTooManyTopics(doc))
-            continue;
+            return;
 
         DocList docs;
         QString topic;
@@ -1616,13 +1897,9 @@ void ClangCodeParser::parseSourceFile(const Location & /*location*/, const QStri
 
         if (topic.isEmpty()) {
             Node *n = nullptr;
-            if (i + 1 < numTokens) {
+            if (nextCommentLoc) {
                 // Try to find the next declaration.
-                CXSourceLocation nextCommentLoc = commentLoc;
-                while (i + 2 < numTokens && clang_getTokenKind(tokens[i + 1]) != CXToken_Comment)
-                    ++i; // already skip all the tokens that are not comments
-                nextCommentLoc = clang_getTokenLocation(tu, tokens[i + 1]);
-                n = visitor.nodeForCommentAtLocation(commentLoc, nextCommentLoc);
+                n = visitor.nodeForCommentAtLocation(commentLoc, *nextCommentLoc);
             }
 
             if (n) {
@@ -1660,11 +1937,86 @@ void ClangCodeParser::parseSourceFile(const Location & /*location*/, const QStri
             processTopicArgs(doc, topic, nodes, docs);
         }
         processMetaCommands(nodes, docs);
+    };
+
+    /*
+      If the comments of this file were cached by a previous run,
+      skip tokenizing the file and parsing its comments. The cache
+      holds the position of each comment and of the token that
+      follows it, which is all that is needed to tie the comments
+      to the declarations in the translation unit.
+     */
+    DocCache &cache = DocCache::instance();
+    QByteArray content;
+    if (cache.isEnabled()) {
+        QFile file(filePath);
+        if (file.open(QIODevice::ReadOnly))
+            content = file.readAll();
+    }
+
+    CachedCommentList cachedComments;
+    if (cache.find(filePath, content, cachedComments)) {
+        CXFile file = clang_getFile(tu, filePath.toLocal8Bit().constData());
+        for (const auto &comment : std::as_const(cachedComments)) {
+            CXSourceLocation commentLoc =
+                    clang_getLocation(tu, file, comment.m_lineNo, comment.m_columnNo);
+            CXSourceLocation nextCommentLoc =
+                    clang_getLocation(tu, file, comment.m_nextLineNo, comment.m_nextColumnNo);
+            processComment(comment.m_doc, commentLoc,
+                           comment.m_nextLineNo < 0 ? nullptr : &nextCommentLoc);
+        }
+    } else {
+        CXToken *tokens;
+        unsigned int numTokens = 0;
+        const QSet<QString> &commands = topicCommands() + metaCommands();
+        clang_tokenize(tu, clang_getCursorExtent(tuCur), &tokens, &numTokens);
+
+        cache.beginFile(filePath, content);
+        for (unsigned int i = 0; i < numTokens; ++i) {
+            if (clang_getTokenKind(tokens[i]) != CXToken_Comment)
+                continue;
+            QString comment = fromCXString(clang_getTokenSpelling(tu, tokens[i]));
+            if (!comment.startsWith("/*!"))
+                continue;
+
+            auto commentLoc = clang_getTokenLocation(tu, tokens[i]);
+            auto loc = fromCXSourceLocation(commentLoc);
+            auto end_loc = fromCXSourceLocation(clang_getRangeEnd(clang_getTokenExtent(tu, tokens[i])));
+            Doc::trimCStyleComment(loc, comment);
+
+            // Doc constructor parses the comment.
+            Doc doc(loc, end_loc, comment, commands, topicCommands());
+
+            // The next comment, or the last token, bounds the declaration
+            // that the comment may document.
+            CachedComment cachedComment { doc };
+            CXSourceLocation nextCommentLoc = commentLoc;
+            bool hasNext = i + 1 < numTokens;
+            if (hasNext) {
+                unsigned int next = i + 1;
+                while (next + 1 < numTokens && clang_getTokenKind(tokens[next]) != CXToken_Comment)
+                    ++next;
+                nextCommentLoc = clang_getTokenLocation(tu, tokens[next]);
+            }
+            unsigned int line, column;
+            clang_getFileLocation(commentLoc, nullptr, &line, &column, nullptr);
+            cachedComment.m_lineNo = static_cast<int>(line);
+            cachedComment.m_columnNo = static_cast<int>(column);
+            if (hasNext) {
+                clang_getFileLocation(nextCommentLoc, nullptr, &line, &column, nullptr);
+                cachedComment.m_nextLineNo = static_cast<int>(line);
+                cachedComment.m_nextColumnNo = static_cast<int>(column);
+            }
+            cache.addComment(cachedComment);
+
+            processComment(doc, commentLoc, hasNext ? &nextCommentLoc : nullptr);
+        }
+        cache.endFile();
+        clang_disposeTokens(tu, tokens, numTokens);
     }
 
-    clang_disposeTokens(tu, tokens, numTokens);
     clang_disposeTranslationUnit(tu);
-    clang_disposeIndex(index_);
+    clang_disposeIndex(unit.index);
     m_namespaceScope.clear();
     s_fn.clear();
 }
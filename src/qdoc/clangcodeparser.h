@@ -8,6 +8,10 @@
 
 #include <QtCore/qtemporarydir.h>
 
+#include <future>
+#include <map>
+
+typedef void *CXIndex;
 typedef struct CXTranslationUnitImpl *CXTranslationUnit;
 
 QT_BEGIN_NAMESPACE
@@ -26,9 +30,25 @@ public:
     void parseSourceFile(const Location &location, const QString &filePath) override;
     void precompileHeaders() override;
     Node *parseFnArg(const Location &location, const QString &fnSignature, const QString &idTag) override;
+    void setSourceFilesToParse(const QStringList &filePaths, int jobs);
     static const QByteArray &fn() { return s_fn; }
 
 private:
+    struct TranslationUnit
+    {
+        CXIndex index { nullptr };
+        CXTranslationUnit tu { nullptr };
+        int error { 0 };
+        QList<QByteArray> args {};
+    };
+
+    QList<QByteArray> sourceFileArgs(const QString &filePath);
+    TranslationUnit takeTranslationUnit(const QString &filePath);
+    void startPendingParses();
+    void discardPendingParses();
+    static TranslationUnit parseTranslationUnit(const QString &filePath,
+                                                const QList<QByteArray> &args);
+
     void getDefaultArgs(); // FIXME: Clean up API
     void getMoreArgs(); // FIXME: Clean up API
 
@@ -45,6 +65,9 @@ private:
     std::vector<const char *> m_args {};
     QList<QByteArray> m_moreArgs {};
     QStringList m_namespaceScope {};
+    QStringList m_sourceFileQueue {};
+    std::map<QString, std::future<TranslationUnit>> m_pendingParses {};
+    int m_jobs { 1 };
     static QByteArray s_fn;
 };
 
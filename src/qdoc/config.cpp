@@ -4,18 +4,23 @@
 #include "config.h"
 #include "utilities.h"
 
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdir.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qtemporaryfile.h>
 #include <QtCore/qtextstream.h>
+#include <QtCore/qthread.h>
 #include <QtCore/qvariant.h>
 #include <QtCore/qregularexpression.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 QString ConfigStrings::ALIAS = QStringLiteral("alias");
 QString ConfigStrings::AUTOLINKERRORS = QStringLiteral("autolinkerrors");
 QString ConfigStrings::BUILDVERSION = QStringLiteral("buildversion");
+QString ConfigStrings::CACHEDIR = QStringLiteral("cachedir");
 QString ConfigStrings::CLANGDEFINES = QStringLiteral("clangdefines");
 QString ConfigStrings::CODEINDENT = QStringLiteral("codeindent");
 QString ConfigStrings::CODEPREFIX = QStringLiteral("codeprefix");
@@ -50,6 +55,7 @@ QString ConfigStrings::IMAGES = QStringLiteral("images");
 QString ConfigStrings::INCLUDEPATHS = QStringLiteral("includepaths");
 QString ConfigStrings::INCLUSIVE = QStringLiteral("inclusive");
 QString ConfigStrings::INDEXES = QStringLiteral("indexes");
+QString ConfigStrings::JOBS = QStringLiteral("jobs");
 QString ConfigStrings::LANDINGPAGE = QStringLiteral("landingpage");
 QString ConfigStrings::LANDINGTITLE = QStringLiteral("landingtitle");
 QString ConfigStrings::LANGUAGE = QStringLiteral("language");
@@ -205,7 +211,7 @@ QString Config::installDir;
 QSet<QString> Config::overrideOutputFormats;
 QMap<QString, QString> Config::m_extractedDirs;
 QStack<QString> Config::m_workingDirs;
-QMap<QString, QStringList> Config::m_includeFilesMap;
+QMap<QString, QHash<QString, QStringList>> Config::m_includeFilesMap;
 
 /*!
   \class Config
@@ -293,6 +299,12 @@ void Config::reset()
     setListFlag(CONFIG_NOLINKERRORS,
                 m_parser.isSet(m_parser.noLinkErrorsOption)
                         || qEnvironmentVariableIsSet("QDOC_NOLINKERRORS"));
+    if (m_parser.isSet(m_parser.jobsOption))
+        setStringList(CONFIG_JOBS, QStringList(m_parser.value(m_parser.jobsOption)));
+    if (m_parser.isSet(m_parser.cacheDirOption))
+        setStringList(CONFIG_CACHEDIR,
+                      QStringList(QDir::current().absoluteFilePath(
+                              m_parser.value(m_parser.cacheDirOption))));
 
     // CONFIG_DEFINES and CONFIG_INCLUDEPATHS are set in load()
 }
@@ -473,6 +485,48 @@ int Config::getInt(const QString &var) const
     return sum;
 }
 
+/*!
+  Returns the number of threads QDoc may use for work that can run
+  concurrently, as set by the \c jobs configuration variable or the
+  \c -jobs command line option. A value of \c 0 selects one thread
+  per available core. Returns \c 1 if the variable is not set.
+ */
+int Config::jobCount() const
+{
+    const int jobs = getInt(CONFIG_JOBS);
+    if (jobs == 0)
+        return QThread::idealThreadCount();
+    return std::max(jobs, 1);
+}
+
+/*!
+  Returns a hash of all configuration variables and the current
+  QDoc pass. Two runs with the same fingerprint parse documentation
+  comments the same way.
+
+  The variables that only control how QDoc schedules or caches its
+  work, \c jobs and \c cachedir, are not part of the fingerprint.
+ */
+QByteArray Config::fingerprint() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (auto it = m_configVars.cbegin(); it != m_configVars.cend(); ++it) {
+        if (it.key() == CONFIG_JOBS || it.key() == CONFIG_CACHEDIR)
+            continue;
+        hash.addData(it.key().toUtf8());
+        hash.addData(QByteArrayView("\0", 1));
+        for (const auto &value : it->m_values) {
+            hash.addData(value.m_value.toUtf8());
+            hash.addData(QByteArrayView("\0", 1));
+            hash.addData(value.m_path.toUtf8());
+            hash.addData(QByteArrayView("\0", 1));
+        }
+    }
+    hash.addData(QByteArray::number(m_qdocPass));
+    hash.addData(QByteArray::number(m_showInternal));
+    return hash.result();
+}
+
 /*!
   Function to return the correct outputdir for the output \a format.
   If \a format is not specified, defaults to 'HTML'.
@@ -730,12 +784,19 @@ QString Config::getIncludeFilePath(const QString &fileName) const
         for (const auto &dir : dirs)
             result += getFilesHere(dir, "*." + ext, location());
         result.removeDuplicates();
-        m_includeFilesMap.insert(ext, result);
+
+        // Index the paths by file name, keeping their order, so that
+        // only the paths that can match are compared below.
+        QHash<QString, QStringList> pathsByName;
+        for (const auto &path : std::as_const(result))
+            pathsByName[path.mid(path.lastIndexOf(u'/') + 1)].append(path);
+        m_includeFilesMap.insert(ext, pathsByName);
     }
-    const QStringList &paths = (*m_includeFilesMap.find(ext));
     QString match = fileName;
     if (!match.startsWith('/'))
         match.prepend('/');
+    const QStringList paths =
+            m_includeFilesMap.value(ext).value(match.mid(match.lastIndexOf(u'/') + 1));
     for (const auto &path : paths) {
         if (path.endsWith(match))
             return path;
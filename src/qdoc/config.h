@@ -8,6 +8,7 @@
 #include "qdoccommandlineparser.h"
 #include "singleton.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qset.h>
 #include <QtCore/qstack.h>
@@ -127,6 +128,8 @@ public:
     [[nodiscard]] const Location &lastLocation() const { return m_lastLocation; }
     [[nodiscard]] bool getBool(const QString &var) const;
     [[nodiscard]] int getInt(const QString &var) const;
+    [[nodiscard]] int jobCount() const;
+    [[nodiscard]] QByteArray fingerprint() const;
 
     [[nodiscard]] QString getOutputDir(const QString &format = QString("HTML")) const;
     [[nodiscard]] QSet<QString> getOutputFormats() const;
@@ -226,7 +229,8 @@ private:
 
     static QMap<QString, QString> m_extractedDirs;
     static QStack<QString> m_workingDirs;
-    static QMap<QString, QStringList> m_includeFilesMap;
+    // File extension -> file name -> paths of the files with that name
+    static QMap<QString, QHash<QString, QStringList>> m_includeFilesMap;
     QDocCommandLineParser m_parser {};
 
     QDocPass m_qdocPass { Neither };
@@ -237,6 +241,7 @@ struct ConfigStrings
     static QString ALIAS;
     static QString AUTOLINKERRORS;
     static QString BUILDVERSION;
+    static QString CACHEDIR;
     static QString CLANGDEFINES;
     static QString CODEINDENT;
     static QString CODEPREFIX;
@@ -271,6 +276,7 @@ struct ConfigStrings
     static QString INCLUDEPATHS;
     static QString INCLUSIVE;
     static QString INDEXES;
+    static QString JOBS;
     static QString LANDINGPAGE;
     static QString LANDINGTITLE;
     static QString LANGUAGE;
@@ -317,6 +323,7 @@ struct ConfigStrings
 #define CONFIG_ALIAS ConfigStrings::ALIAS
 #define CONFIG_AUTOLINKERRORS ConfigStrings::AUTOLINKERRORS
 #define CONFIG_BUILDVERSION ConfigStrings::BUILDVERSION
+#define CONFIG_CACHEDIR ConfigStrings::CACHEDIR
 #define CONFIG_CLANGDEFINES ConfigStrings::CLANGDEFINES
 #define CONFIG_CODEINDENT ConfigStrings::CODEINDENT
 #define CONFIG_CODEPREFIX ConfigStrings::CODEPREFIX
@@ -351,6 +358,7 @@ struct ConfigStrings
 #define CONFIG_INCLUDEPATHS ConfigStrings::INCLUDEPATHS
 #define CONFIG_INCLUSIVE ConfigStrings::INCLUSIVE
 #define CONFIG_INDEXES ConfigStrings::INDEXES
+#define CONFIG_JOBS ConfigStrings::JOBS
 #define CONFIG_LANDINGPAGE ConfigStrings::LANDINGPAGE
 #define CONFIG_LANDINGTITLE ConfigStrings::LANDINGTITLE
 #define CONFIG_LANGUAGE ConfigStrings::LANGUAGE
@@ -6,6 +6,7 @@
 #include "atom.h"
 #include "config.h"
 #include "codemarker.h"
+#include "doccache.h"
 #include "docparser.h"
 #include "docprivate.h"
 #include "generator.h"
@@ -13,6 +14,8 @@
 #include "quoter.h"
 #include "text.h"
 
+#include <QtCore/qdatastream.h>
+
 QT_BEGIN_NAMESPACE
 
 using namespace Qt::StringLiterals;
@@ -415,15 +418,26 @@ CodeMarker *Doc::quoteFromFile(const Location &location, Quoter &quoter, Resolve
     // spread resposability should be removed, together with quoteFromFile.
     quoter.reset();
 
-    QString code;
-    {
-        QFile input_file{resolved_file.get_path()};
-        input_file.open(QFile::ReadOnly);
-        code = DocParser::untabifyEtc(QTextStream{&input_file}.readAll());
-    }
+    DocCache::instance().addDependency(resolved_file.get_path());
 
     CodeMarker *marker = CodeMarker::markerForFileName(resolved_file.get_path());
-    quoter.quoteFromFile(resolved_file.get_path(), code, marker->markedUpCode(code, nullptr, location));
+
+    // The same snippet files are quoted many times, so each is read,
+    // untabified and marked up only once.
+    static QHash<QPair<QString, const CodeMarker *>, std::shared_ptr<const QuotedFile>> s_quotedFiles;
+    auto &quoted_file = s_quotedFiles[qMakePair(resolved_file.get_path(), marker)];
+    if (!quoted_file) {
+        QString code;
+        {
+            QFile input_file{resolved_file.get_path()};
+            input_file.open(QFile::ReadOnly);
+            code = DocParser::untabifyEtc(QTextStream{&input_file}.readAll());
+        }
+        quoted_file = QuotedFile::create(resolved_file.get_path(), code,
+                                         marker->markedUpCode(code, nullptr, location));
+    }
+
+    quoter.quoteFromFile(resolved_file.get_path(), quoted_file);
     return marker;
 }
 
@@ -464,6 +478,196 @@ QString Doc::canonicalTitle(const QString &title)
     return result;
 }
 
+/*!
+  \internal
+  Writes the atoms of \a text to \a out.
+ */
+static void serializeText(QDataStream &out, const Text &text)
+{
+    qint32 count = 0;
+    for (const Atom *atom = text.firstAtom(); atom; atom = atom->next())
+        ++count;
+    out << count;
+    for (const Atom *atom = text.firstAtom(); atom; atom = atom->next()) {
+        out << static_cast<qint32>(atom->type()) << atom->strings() << atom->isLinkAtom();
+        if (atom->isLinkAtom())
+            out << static_cast<const LinkAtom *>(atom)->squareBracketParams();
+    }
+}
+
+/*!
+  \internal
+  Reads atoms written by serializeText() from \a in and appends them
+  to \a text. Returns the appended atoms in the order they were read.
+ */
+static QList<Atom *> deserializeText(QDataStream &in, Text &text)
+{
+    QList<Atom *> atoms;
+    qint32 count = 0;
+    in >> count;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        qint32 type = 0;
+        QStringList strings;
+        bool isLinkAtom = false;
+        in >> type >> strings >> isLinkAtom;
+        const QString first = strings.value(0);
+        if (isLinkAtom) {
+            QString squareBracketParams;
+            in >> squareBracketParams;
+            text << LinkAtom(first, squareBracketParams);
+        } else {
+            text << Atom(static_cast<Atom::AtomType>(type), first, strings.value(1));
+        }
+        atoms << text.lastAtom();
+    }
+    return atoms;
+}
+
+/*!
+  \internal
+  Returns the positions in \a atoms of the atoms listed in \a subset.
+ */
+static QList<qint32> atomIndexes(const QList<const Atom *> &atoms, const QList<Atom *> &subset)
+{
+    QList<qint32> indexes;
+    indexes.reserve(subset.size());
+    for (const Atom *atom : subset)
+        indexes << static_cast<qint32>(atoms.indexOf(atom));
+    return indexes;
+}
+
+/*!
+  Writes the parsed contents of this Doc to \a out, such that
+  deserialize() can rebuild it without running the DocParser.
+
+  Returns \c false if the Doc cannot be represented in serialized
+  form, in which case the contents of \a out are unspecified.
+
+  \sa DocCache
+ */
+bool Doc::serialize(QDataStream &out) const
+{
+    if (m_priv == nullptr || m_priv->m_start_loc.depth() != 1 || m_priv->m_end_loc.depth() != 1)
+        return false;
+
+    const auto writeLocation = [&out](const Location &location) {
+        out << location.filePath() << static_cast<qint32>(location.lineNo())
+            << static_cast<qint32>(location.columnNo()) << location.etc();
+    };
+    writeLocation(m_priv->m_start_loc);
+    writeLocation(m_priv->m_end_loc);
+    out << m_priv->m_src;
+
+    serializeText(out, m_priv->m_text);
+    out << static_cast<qint32>(m_priv->m_alsoList.size());
+    for (const auto &also : m_priv->m_alsoList)
+        serializeText(out, also);
+
+    out << m_priv->m_params << m_priv->m_enumItemList << m_priv->m_omitEnumItemList
+        << m_priv->m_metacommandsUsed << m_priv->m_metaCommandMap;
+
+    out << static_cast<qint32>(m_priv->m_topics.size());
+    for (const auto &topic : m_priv->m_topics)
+        out << topic.m_topic << topic.m_args;
+
+    out << bool(m_priv->m_hasLegalese) << (m_priv->extra != nullptr);
+    if (m_priv->extra) {
+        QList<const Atom *> atoms;
+        for (const Atom *atom = m_priv->m_text.firstAtom(); atom; atom = atom->next())
+            atoms << atom;
+        const DocPrivateExtra *extra = m_priv->extra;
+        const QList<qint32> tableOfContents = atomIndexes(atoms, extra->m_tableOfContents);
+        const QList<qint32> keywords = atomIndexes(atoms, extra->m_keywords);
+        const QList<qint32> targets = atomIndexes(atoms, extra->m_targets);
+        if (tableOfContents.contains(-1) || keywords.contains(-1) || targets.contains(-1))
+            return false;
+        out << tableOfContents << extra->m_tableOfContentsLevels << keywords << targets
+            << extra->m_metaMap;
+    }
+    return out.status() == QDataStream::Ok;
+}
+
+/*!
+  Reads a Doc written by serialize() from \a in and returns it.
+  Returns an empty Doc if \a in does not hold a valid Doc.
+ */
+Doc Doc::deserialize(QDataStream &in)
+{
+    const auto readLocation = [&in]() {
+        QString filePath;
+        qint32 lineNo = 0;
+        qint32 columnNo = 0;
+        bool etc = false;
+        in >> filePath >> lineNo >> columnNo >> etc;
+        Location location(filePath);
+        location.setLineNo(lineNo);
+        location.setColumnNo(columnNo);
+        location.setEtc(etc);
+        return location;
+    };
+
+    Doc doc;
+    const Location start = readLocation();
+    const Location end = readLocation();
+    QString source;
+    in >> source;
+    doc.m_priv = new DocPrivate(start, end, source);
+
+    const QList<Atom *> atoms = deserializeText(in, doc.m_priv->m_text);
+    qint32 alsoCount = 0;
+    in >> alsoCount;
+    for (qint32 i = 0; i < alsoCount && in.status() == QDataStream::Ok; ++i) {
+        Text also;
+        deserializeText(in, also);
+        doc.m_priv->addAlso(also);
+    }
+
+    in >> doc.m_priv->m_params >> doc.m_priv->m_enumItemList
+            >> doc.m_priv->m_omitEnumItemList >> doc.m_priv->m_metacommandsUsed
+            >> doc.m_priv->m_metaCommandMap;
+
+    qint32 topicCount = 0;
+    in >> topicCount;
+    for (qint32 i = 0; i < topicCount && in.status() == QDataStream::Ok; ++i) {
+        Topic topic;
+        in >> topic.m_topic >> topic.m_args;
+        doc.m_priv->m_topics << topic;
+    }
+
+    bool hasLegalese = false;
+    bool hasExtra = false;
+    in >> hasLegalese >> hasExtra;
+    doc.m_priv->m_hasLegalese = hasLegalese;
+    if (hasExtra) {
+        QList<qint32> tableOfContents;
+        QList<qint32> keywords;
+        QList<qint32> targets;
+        doc.m_priv->constructExtra();
+        DocPrivateExtra *extra = doc.m_priv->extra;
+        in >> tableOfContents >> extra->m_tableOfContentsLevels >> keywords >> targets
+                >> extra->m_metaMap;
+        const auto resolveAtoms = [&atoms, &in](const QList<qint32> &indexes) {
+            QList<Atom *> result;
+            result.reserve(indexes.size());
+            for (qint32 index : indexes) {
+                if (index < 0 || index >= atoms.size()) {
+                    in.setStatus(QDataStream::ReadCorruptData);
+                    break;
+                }
+                result << atoms.at(index);
+            }
+            return result;
+        };
+        extra->m_tableOfContents = resolveAtoms(tableOfContents);
+        extra->m_keywords = resolveAtoms(keywords);
+        extra->m_targets = resolveAtoms(targets);
+    }
+
+    if (in.status() != QDataStream::Ok)
+        return Doc();
+    return doc;
+}
+
 void Doc::detach()
 {
     if (m_priv == nullptr) {
@@ -20,6 +20,7 @@ QT_BEGIN_NAMESPACE
 class Atom;
 class CodeMarker;
 class DocPrivate;
+class QDataStream;
 class Quoter;
 class Text;
 
@@ -73,6 +74,9 @@ public:
     [[nodiscard]] const QList<Atom *> &targets() const;
     [[nodiscard]] QStringMultiMap *metaTagMap() const;
 
+    bool serialize(QDataStream &out) const;
+    static Doc deserialize(QDataStream &in);
+
     static void initialize(FileResolver& file_resolver);
     static void terminate();
     static QString alias(const QString &english);
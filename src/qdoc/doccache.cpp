@@ -0,0 +1,265 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include "doccache.h"
+
+#include "config.h"
+#include "location.h"
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qsavefile.h>
+
+QT_BEGIN_NAMESPACE
+
+static const quint32 s_cacheMagic = 0x51444343; // "QDCC"
+static const quint32 s_cacheVersion = 1;
+
+/*!
+  \class DocCache
+  \internal
+  \brief The DocCache class stores parsed documentation comments
+  between QDoc runs.
+
+  When the \c cachedir configuration variable (or the \c -cachedir
+  command line option) is set, the code parsers record, for each
+  source file, the Doc objects built from its documentation comments.
+  The record is keyed by the content of the source file, by the
+  files that the comments quote or include, and by the
+  Config::fingerprint() of the run.
+
+  On later runs, a parser can retrieve the comments of an unchanged
+  file with find() instead of running the DocParser on them again.
+  The topic and meta-commands of the retrieved comments are then
+  processed as usual, as their results depend on the rest of the
+  documentation tree.
+
+  Files for which parsing emitted any message are not recorded, so
+  that those messages are repeated by every run.
+ */
+
+/*!
+  Enables the cache if the \c cachedir configuration variable is set.
+  Must be called after the configuration has been loaded.
+ */
+void DocCache::initialize()
+{
+    const Config &config = Config::instance();
+    m_cacheDir.clear();
+    m_fileHashes.clear();
+    m_recording = false;
+
+    // Dumping the atoms of each comment requires parsing it.
+    if (config.getAtomsDump())
+        return;
+
+    const QString cacheDir = config.getString(CONFIG_CACHEDIR);
+    if (cacheDir.isEmpty())
+        return;
+
+    const QString commentDir = cacheDir + QLatin1String("/comments");
+    if (!QDir().mkpath(commentDir)) {
+        Location().warning(QStringLiteral("Cannot create cache directory '%1'").arg(commentDir));
+        return;
+    }
+    m_cacheDir = commentDir;
+    m_fingerprint = config.fingerprint() + QByteArray(QT_VERSION_STR);
+}
+
+/*!
+  Disables the cache and releases its data.
+ */
+void DocCache::terminate()
+{
+    m_cacheDir.clear();
+    m_fingerprint.clear();
+    m_fileHashes.clear();
+    m_dependencies.clear();
+    m_comments.clear();
+    m_commentCount = 0;
+    m_recording = false;
+}
+
+/*!
+  Returns the path of the cache entry for the source file \a filePath.
+ */
+QString DocCache::entryPath(const QString &filePath) const
+{
+    const QByteArray key = QCryptographicHash::hash(m_fingerprint + filePath.toUtf8(),
+                                                    QCryptographicHash::Sha1);
+    return m_cacheDir + QLatin1Char('/') + QString::fromLatin1(key.toHex());
+}
+
+/*!
+  Returns the hash of the contents of the file \a filePath, or an
+  empty byte array if the file cannot be read. Hashes are computed
+  once per run.
+ */
+QByteArray DocCache::fileHash(const QString &filePath)
+{
+    auto it = m_fileHashes.constFind(filePath);
+    if (it != m_fileHashes.cend())
+        return *it;
+
+    QByteArray hash;
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadOnly))
+        hash = QCryptographicHash::hash(file.readAll(), QCryptographicHash::Sha1);
+    m_fileHashes.insert(filePath, hash);
+    return hash;
+}
+
+/*!
+  Looks up the comments recorded for the source file \a filePath
+  with the contents \a content. If an up-to-date entry exists, stores
+  the comments in \a comments and returns \c true. Otherwise, returns
+  \c false.
+ */
+bool DocCache::find(const QString &filePath, const QByteArray &content,
+                    CachedCommentList &comments)
+{
+    if (!isEnabled())
+        return false;
+
+    QFile file(entryPath(filePath));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    QByteArray fingerprint;
+    QString recordedPath;
+    QByteArray contentHash;
+    in >> magic >> version;
+    if (magic != s_cacheMagic || version != s_cacheVersion)
+        return false;
+    in >> fingerprint >> recordedPath >> contentHash;
+    if (fingerprint != m_fingerprint || recordedPath != filePath
+        || contentHash != QCryptographicHash::hash(content, QCryptographicHash::Sha1)) {
+        return false;
+    }
+
+    QList<std::pair<QString, QByteArray>> dependencies;
+    in >> dependencies;
+    for (const auto &[path, hash] : std::as_const(dependencies)) {
+        if (hash.isEmpty() || fileHash(path) != hash)
+            return false;
+    }
+
+    qint32 count = 0;
+    in >> count;
+    CachedCommentList result;
+    for (qint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        CachedComment comment;
+        qint32 lineNo = 0, columnNo = 0, nextLineNo = -1, nextColumnNo = -1;
+        in >> lineNo >> columnNo >> nextLineNo >> nextColumnNo;
+        comment.m_lineNo = lineNo;
+        comment.m_columnNo = columnNo;
+        comment.m_nextLineNo = nextLineNo;
+        comment.m_nextColumnNo = nextColumnNo;
+        comment.m_doc = Doc::deserialize(in);
+        result << comment;
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+
+    comments = result;
+    return true;
+}
+
+/*!
+  Starts recording the comments of the source file \a filePath,
+  whose contents are \a content. Does nothing if the cache is
+  disabled.
+
+  \sa addComment(), endFile()
+ */
+void DocCache::beginFile(const QString &filePath, const QByteArray &content)
+{
+    m_recording = isEnabled();
+    if (!m_recording)
+        return;
+
+    m_messageCount = Location::messageCount();
+    m_filePath = filePath;
+    m_contentHash = QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+    m_dependencies.clear();
+    m_comments.clear();
+    m_commentCount = 0;
+}
+
+/*!
+  Records \a comment for the current source file.
+
+  The comment is serialized right away, before the parser processes
+  its topic and meta-commands. If it cannot be serialized, nothing is
+  recorded for the current source file.
+ */
+void DocCache::addComment(const CachedComment &comment)
+{
+    if (!m_recording)
+        return;
+
+    QDataStream out(&m_comments, QIODevice::WriteOnly | QIODevice::Append);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << static_cast<qint32>(comment.m_lineNo) << static_cast<qint32>(comment.m_columnNo)
+        << static_cast<qint32>(comment.m_nextLineNo) << static_cast<qint32>(comment.m_nextColumnNo);
+    if (comment.m_doc.serialize(out))
+        ++m_commentCount;
+    else
+        m_recording = false;
+}
+
+/*!
+  Records that the comments of the current source file depend on
+  the contents of the file \a filePath.
+ */
+void DocCache::addDependency(const QString &filePath)
+{
+    if (m_recording && !m_dependencies.contains(filePath))
+        m_dependencies << filePath;
+}
+
+/*!
+  Stops recording and writes the entry for the current source file,
+  unless a message was emitted while it was parsed or one of its
+  comments cannot be serialized.
+ */
+void DocCache::endFile()
+{
+    if (!m_recording)
+        return;
+    m_recording = false;
+
+    if (Location::messageCount() != m_messageCount)
+        return;
+
+    QList<std::pair<QString, QByteArray>> dependencies;
+    for (const auto &path : std::as_const(m_dependencies)) {
+        const QByteArray hash = fileHash(path);
+        if (hash.isEmpty())
+            return;
+        dependencies.append({ path, hash });
+    }
+
+    QSaveFile file(entryPath(m_filePath));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << s_cacheMagic << s_cacheVersion << m_fingerprint << m_filePath << m_contentHash
+        << dependencies << m_commentCount;
+    out.writeRawData(m_comments.constData(), int(m_comments.size()));
+    m_comments.clear();
+    m_commentCount = 0;
+    if (out.status() == QDataStream::Ok)
+        file.commit();
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,63 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef DOCCACHE_H
+#define DOCCACHE_H
+
+#include "doc.h"
+#include "singleton.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+
+QT_BEGIN_NAMESPACE
+
+struct CachedComment
+{
+    Doc m_doc {};
+    // Position of the comment, and of the token that follows it, in
+    // the source file. Only the clang parser uses these.
+    int m_lineNo { 0 };
+    int m_columnNo { 0 };
+    int m_nextLineNo { -1 };
+    int m_nextColumnNo { -1 };
+};
+typedef QList<CachedComment> CachedCommentList;
+
+class DocCache : public Singleton<DocCache>
+{
+public:
+    void initialize();
+    void terminate();
+
+    [[nodiscard]] bool isEnabled() const { return !m_cacheDir.isEmpty(); }
+    bool find(const QString &filePath, const QByteArray &content, CachedCommentList &comments);
+
+    void beginFile(const QString &filePath, const QByteArray &content);
+    void addComment(const CachedComment &comment);
+    void addDependency(const QString &filePath);
+    void endFile();
+
+private:
+    [[nodiscard]] QString entryPath(const QString &filePath) const;
+    QByteArray fileHash(const QString &filePath);
+
+    QString m_cacheDir {};
+    QByteArray m_fingerprint {};
+    QHash<QString, QByteArray> m_fileHashes {};
+
+    bool m_recording { false };
+    int m_messageCount { 0 };
+    QString m_filePath {};
+    QByteArray m_contentHash {};
+    QStringList m_dependencies {};
+    QByteArray m_comments {};
+    qint32 m_commentCount { 0 };
+};
+
+QT_END_NAMESPACE
+
+#endif // DOCCACHE_H
@@ -4,6 +4,7 @@
 
 #include "codemarker.h"
 #include "doc.h"
+#include "doccache.h"
 #include "docprivate.h"
 #include "editdistance.h"
 #include "macro.h"
@@ -1336,6 +1337,7 @@ void DocParser::include(const QString &fileName, const QString &identifier, cons
             location().warning(
                     QStringLiteral("Cannot open qdoc include file '%1'").arg(filePath));
         } else {
+            DocCache::instance().addDependency(filePath);
             location().push(fileName);
             QTextStream inStream(&inFile);
             QString includedContent = inStream.readAll();
@@ -5,7 +5,14 @@
 
 #include "boundaries/filesystem/filepath.h"
 
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QStringList>
 
 #include <iostream>
 #include <algorithm>
@@ -27,6 +34,12 @@
  * A file is considered to be resolved if, from any root directory,
  * the query represents an existing file.
  *
+ * To avoid probing the filesystem for each query, the root
+ * directories are listed once, when the first query is resolved, and
+ * the files they contain are looked up in memory. Queries that are
+ * not found in that listing are still searched for on the filesystem,
+ * so that files created afterwards can be resolved.
+ *
  * For example, consider the following directory structure on some
  * filesystem:
  *
@@ -136,6 +149,164 @@ FileResolver::FileResolver(std::vector<DirectoryPath>&& search_directories)
 // This will then define how we should handle absolute paths, if we
 // can receive them at all and so on.
 
+/*!
+ * Makes the instance store the listing of its root directories in
+ * the file at \a snapshot_path, and reuse it when the file exists.
+ *
+ * A directory is only listed again if it was modified since the
+ * snapshot was taken. This allows different runs of QDoc over the
+ * same directories, such as the prepare and generate phases, to
+ * share the work of listing them.
+ */
+void FileResolver::use_snapshot(QString snapshot_path)
+{
+    this->snapshot_path = std::move(snapshot_path);
+}
+
+namespace {
+
+struct DirectoryEntries {
+    qint64 last_modified{0};
+    QStringList files{};
+    QStringList directories{};
+    // Directories that are symbolic links, which could form cycles.
+    QStringList linked_directories{};
+};
+
+constexpr quint32 snapshot_magic{0x51444653};
+constexpr quint32 snapshot_version{1};
+
+QHash<QString, DirectoryEntries> read_snapshot(const QString& snapshot_path)
+{
+    QHash<QString, DirectoryEntries> snapshot{};
+
+    QFile file{snapshot_path};
+    if (!file.open(QIODevice::ReadOnly))
+        return snapshot;
+
+    QDataStream stream{&file};
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic{0}, version{0};
+    qint32 count{0};
+    stream >> magic >> version >> count;
+    if (magic != snapshot_magic || version != snapshot_version || count < 0)
+        return snapshot;
+
+    snapshot.reserve(count);
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path{};
+        DirectoryEntries entries{};
+        stream >> path >> entries.last_modified >> entries.files >> entries.directories
+               >> entries.linked_directories;
+        snapshot.insert(path, std::move(entries));
+    }
+
+    if (stream.status() != QDataStream::Ok)
+        snapshot.clear();
+    return snapshot;
+}
+
+void write_snapshot(const QString& snapshot_path, const QHash<QString, DirectoryEntries>& snapshot)
+{
+    QDir().mkpath(QFileInfo{snapshot_path}.absolutePath());
+
+    QSaveFile file{snapshot_path};
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream stream{&file};
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << snapshot_magic << snapshot_version << qint32(snapshot.size());
+    for (auto it = snapshot.cbegin(); it != snapshot.cend(); ++it) {
+        stream << it.key() << it->last_modified << it->files << it->directories
+               << it->linked_directories;
+    }
+    file.commit();
+}
+
+DirectoryEntries list_directory(const QString& path, qint64 last_modified)
+{
+    DirectoryEntries entries{last_modified};
+
+    QDirIterator iterator{path, QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Hidden};
+    while (iterator.hasNext()) {
+        iterator.next();
+        const QFileInfo info{iterator.fileInfo()};
+        if (info.isDir())
+            (info.isSymLink() ? entries.linked_directories : entries.directories).append(info.fileName());
+        else if (info.isFile())
+            entries.files.append(info.fileName());
+    }
+
+    return entries;
+}
+
+} // namespace
+
+/*!
+ * \internal
+ *
+ * Maps the path of each file below the root directories, relative to
+ * the root directory, to the path of the file in the first root
+ * directory that contains it.
+ */
+void FileResolver::build_index() const
+{
+    is_indexed = true;
+
+    const QHash<QString, DirectoryEntries> snapshot{
+        snapshot_path.isEmpty() ? QHash<QString, DirectoryEntries>{} : read_snapshot(snapshot_path)
+    };
+    QHash<QString, DirectoryEntries> listed_directories{};
+    bool is_snapshot_outdated{false};
+
+    for (auto& directory_path : search_directories) {
+        QSet<QString> visited_links{};
+        std::vector<QString> pending{QString{}};
+        while (!pending.empty()) {
+            const QString relative_path{std::move(pending.back())};
+            pending.pop_back();
+
+            const QString path{relative_path.isEmpty() ? directory_path.value() : directory_path.value() + "/" + relative_path};
+
+            // Root directories may be nested, so a directory can be
+            // reached more than once.
+            auto listed_entries{listed_directories.constFind(path)};
+            if (listed_entries == listed_directories.cend()) {
+                const qint64 last_modified{QFileInfo{path}.lastModified().toMSecsSinceEpoch()};
+                auto snapshot_entries{snapshot.constFind(path)};
+                if (snapshot_entries != snapshot.cend() && snapshot_entries->last_modified == last_modified) {
+                    listed_entries = listed_directories.insert(path, *snapshot_entries);
+                } else {
+                    listed_entries = listed_directories.insert(path, list_directory(path, last_modified));
+                    is_snapshot_outdated = true;
+                }
+            }
+            const DirectoryEntries& entries{*listed_entries};
+
+            const QString prefix{relative_path.isEmpty() ? QString{} : relative_path + "/"};
+            for (const QString& file : std::as_const(entries.files)) {
+                const QString key{prefix + file};
+                if (!index.contains(key))
+                    index.insert(key, path + "/" + file);
+            }
+            for (const QString& directory : std::as_const(entries.directories))
+                pending.push_back(prefix + directory);
+            for (const QString& directory : std::as_const(entries.linked_directories)) {
+                const QString target{QFileInfo{path + "/" + directory}.canonicalFilePath()};
+                if (!visited_links.contains(target)) {
+                    visited_links.insert(target);
+                    pending.push_back(prefix + directory);
+                }
+            }
+        }
+    }
+
+    if (!snapshot_path.isEmpty() && (is_snapshot_outdated || listed_directories.size() != snapshot.size()))
+        write_snapshot(snapshot_path, listed_directories);
+}
+
 /*!
 * Returns a ResolvedFile if \a query can be resolved or std::nullopt
 * otherwise.
@@ -144,6 +315,24 @@ FileResolver::FileResolver(std::vector<DirectoryPath>&& search_directories)
 * query and the path that the \a query was resolved to.
 */
 [[nodiscard]] std::optional<ResolvedFile> FileResolver::resolve(QString query) const {
+    // Only plain relative paths are looked up in the index, as paths
+    // with "." or ".." components depend on the filesystem.
+    const QString key{QDir::fromNativeSeparators(query)};
+    if (!key.isEmpty() && !key.startsWith('/') && QDir::cleanPath(key) == key) {
+        if (auto resolved_path{resolved_paths.find(key)}; resolved_path != resolved_paths.end())
+            return ResolvedFile{std::move(query), resolved_path->second};
+
+        if (!is_indexed)
+            build_index();
+
+        if (auto indexed_path{index.constFind(key)}; indexed_path != index.cend()) {
+            if (auto maybe_filepath = FilePath::refine(*indexed_path)) {
+                resolved_paths.emplace(key, *maybe_filepath);
+                return ResolvedFile{std::move(query), std::move(*maybe_filepath)};
+            }
+        }
+    }
+
     for (auto& directory_path : search_directories) {
         auto maybe_filepath = FilePath::refine(QDir(directory_path.value() + "/" + query).path());
         if (maybe_filepath) return ResolvedFile{std::move(query), std::move(*maybe_filepath)};
@@ -7,18 +7,30 @@
 #include "boundaries/filesystem/resolvedfile.h"
 
 #include <optional>
+#include <unordered_map>
 #include <vector>
 
+#include <QtCore/qhash.h>
 #include <QtCore/qstring.h>
 
 class FileResolver {
 public:
     FileResolver(std::vector<DirectoryPath>&& search_directories);
 
+    void use_snapshot(QString snapshot_path);
+
     [[nodiscard]] std::optional<ResolvedFile> resolve(QString filename) const;
 
     [[nodiscard]] const std::vector<DirectoryPath>& get_search_directories() const { return search_directories; }
 
 private:
+    void build_index() const;
+
     std::vector<DirectoryPath> search_directories;
+    QString snapshot_path;
+
+    // Built on the first query, see resolve().
+    mutable bool is_indexed{false};
+    mutable QHash<QString, QString> index;
+    mutable std::unordered_map<QString, FilePath> resolved_paths;
 };
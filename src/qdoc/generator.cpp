@@ -29,6 +29,8 @@
 #include <QtCore/qdir.h>
 #include <QtCore/qregularexpression.h>
 
+#include <algorithm>
+
 #ifndef QT_BOOTSTRAPPED
 #    include "QtCore/qurl.h"
 #endif
@@ -53,6 +55,8 @@ bool Generator::s_autolinkErrors = false;
 bool Generator::s_redirectDocumentationToDevNull = false;
 bool Generator::s_useOutputSubdirs = true;
 QmlTypeNode *Generator::s_qmlTypeContext = nullptr;
+int Generator::s_pageWriteJobs = 1;
+std::deque<std::pair<QString, std::future<void>>> Generator::s_pendingPageWrites;
 
 static QRegularExpression tag("</?@[^>]*>");
 static QLatin1String amp("&amp;");
@@ -197,6 +201,8 @@ QFile *Generator::openSubPageFile(const Node *node, const QString &fileName)
     path += fileName;
 
     auto outPath = s_redirectDocumentationToDevNull ? QStringLiteral("/dev/null") : path;
+    // Don't truncate a file that is still being written by a worker thread
+    waitForPageWrites(outPath);
     auto outFile = new QFile(outPath);
 
     if (!s_redirectDocumentationToDevNull && outFile->exists())
@@ -214,26 +220,89 @@ QFile *Generator::openSubPageFile(const Node *node, const QString &fileName)
 
 /*!
   Creates the file named \a fileName in the output directory.
-  Attaches a QTextStream to the created file, which is written
-  to all over the place using out().
+  Attaches a QTextStream to an in-memory buffer for the page,
+  which is written to all over the place using out().
+
+  \sa endSubPage()
  */
 void Generator::beginSubPage(const Node *node, const QString &fileName)
 {
     QFile *outFile = openSubPageFile(node, fileName);
-    auto *out = new QTextStream(outFile);
+    auto *out = new QTextStream(new QString);
     outStreamStack.push(out);
+    m_outFileStack.push(outFile);
 }
 
 /*!
   Flush the text stream associated with the subpage, and
   then pop it off the text stream stack and delete it.
-  This terminates output of the subpage.
+  This terminates output of the subpage, whose contents
+  are then written to its file by writeSubPageFile().
  */
 void Generator::endSubPage()
 {
-    outStreamStack.top()->flush();
-    delete outStreamStack.top()->device();
-    delete outStreamStack.pop();
+    QTextStream *out = outStreamStack.pop();
+    out->flush();
+    QString *text = out->string();
+    delete out;
+    writeSubPageFile(m_outFileStack.pop(), std::move(*text));
+    delete text;
+}
+
+/*!
+  Writes \a text, encoded in UTF-8, to the file \a outFile,
+  and deletes \a outFile.
+
+  If the \c jobs configuration variable allows more than one
+  thread, the page is encoded and written on a worker thread,
+  so that the generator can go on with the next page. At most
+  that many pages are written at the same time.
+
+  Only writing is asynchronous; the pages are still rendered one
+  at a time. Rendering a page goes through state kept in the
+  generator itself, like the out() stream stack, m_link,
+  m_inLink, m_sectionNumber and the table state, and through
+  lookups that fill caches in QDocDatabase. Rendering pages
+  concurrently would need all of that to be per page first.
+
+  \sa waitForPageWrites()
+ */
+void Generator::writeSubPageFile(QFile *outFile, QString &&text)
+{
+    auto write = [outFile, text = std::move(text)]() {
+        outFile->write(text.toUtf8());
+        delete outFile;
+    };
+    if (s_pageWriteJobs <= 1) {
+        write();
+        return;
+    }
+
+    while (s_pendingPageWrites.size() >= static_cast<size_t>(s_pageWriteJobs)) {
+        s_pendingPageWrites.front().second.get();
+        s_pendingPageWrites.pop_front();
+    }
+    QString filePath = outFile->fileName();
+    s_pendingPageWrites.emplace_back(std::move(filePath),
+                                     std::async(std::launch::async, std::move(write)));
+}
+
+/*!
+  Waits until the pages written on worker threads are complete.
+  If \a filePath is not empty, waits only if the file \a filePath
+  is one of them.
+ */
+void Generator::waitForPageWrites(const QString &filePath)
+{
+    if (!filePath.isEmpty()) {
+        auto it = std::find_if(s_pendingPageWrites.cbegin(), s_pendingPageWrites.cend(),
+                               [&filePath](const auto &write) { return write.first == filePath; });
+        if (it == s_pendingPageWrites.cend())
+            return;
+    }
+    for (auto &write : s_pendingPageWrites)
+        write.second.get();
+    s_pendingPageWrites.clear();
 }
 
 /*
@@ -1525,6 +1594,7 @@ void Generator::generateDocs()
 {
     s_currentGenerator = this;
     generateDocumentation(m_qdb->primaryTreeRoot());
+    waitForPageWrites();
 }
 
 Generator *Generator::generatorForFormat(const QString &format)
@@ -1585,6 +1655,7 @@ void Generator::initialize()
     Config &config = Config::instance();
     s_outputFormats = config.getOutputFormats();
     s_redirectDocumentationToDevNull = config.getBool(CONFIG_REDIRECTDOCUMENTATIONTODEVNULL);
+    s_pageWriteJobs = config.jobCount();
 
     for (auto &g : s_generators) {
         if (s_outputFormats.contains(g->format())) {
@@ -1778,7 +1849,7 @@ QTextStream &Generator::out()
 
 QString Generator::outFileName()
 {
-    return QFileInfo(static_cast<QFile *>(out().device())->fileName()).fileName();
+    return QFileInfo(m_outFileStack.top()->fileName()).fileName();
 }
 
 QString Generator::outputPrefix(const Node *node)
@@ -1964,6 +2035,7 @@ void Generator::supplementAlsoList(const Node *node, QList<Text> &alsoList)
 
 void Generator::terminate()
 {
+    waitForPageWrites();
     for (const auto &generator : std::as_const(s_generators)) {
         if (s_outputFormats.contains(generator->format()))
             generator->terminateGenerator();
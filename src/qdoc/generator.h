@@ -14,6 +14,9 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qtextstream.h>
 
+#include <deque>
+#include <future>
+
 QT_BEGIN_NAMESPACE
 
 typedef QMultiMap<QString, Node *> NodeMultiMap;
@@ -148,6 +151,7 @@ protected:
     QString naturalLanguage;
     QString tagFile_;
     QStack<QTextStream *> outStreamStack;
+    QStack<QFile *> m_outFileStack;
 
     void appendFullName(Text &text, const Node *apparentNode, const Node *relative,
                         const Node *actualNode = nullptr);
@@ -183,9 +187,13 @@ private:
     static bool s_redirectDocumentationToDevNull;
     static bool s_useOutputSubdirs;
     static QmlTypeNode *s_qmlTypeContext;
+    static int s_pageWriteJobs;
+    static std::deque<std::pair<QString, std::future<void>>> s_pendingPageWrites;
 
     void generateReimplementsClause(const FunctionNode *fn, CodeMarker *marker);
     static void copyTemplateFiles(const QString &configVar, const QString &subDir);
+    static void writeSubPageFile(QFile *outFile, QString &&text);
+    static void waitForPageWrites(const QString &filePath = QString());
 
 protected:
     FileResolver& file_resolver;
@@ -17,6 +17,7 @@ QT_BEGIN_NAMESPACE
 
 int Location::s_tabSize;
 int Location::s_warningCount = 0;
+int Location::s_messageCount = 0;
 int Location::s_warningLimit = -1;
 QString Location::s_programName;
 QString Location::s_project;
@@ -208,6 +209,11 @@ QString Location::fileSuffix() const
   \sa filePath(), lineNo()
 */
 
+/*! \fn int Location::messageCount()
+  Returns the number of warnings, errors and reports written
+  to stderr so far.
+*/
+
 /*!
   Writes \a message and \a details to stderr as a formatted
   warning message. Does not write the message if qdoc is in
@@ -367,6 +373,7 @@ void Location::emitMessage(MessageType type, const QString &message, const QStri
     }
     if (type != Report)
         result.prepend(toString());
+    ++s_messageCount;
     fprintf(stderr, "%s\n", result.toLatin1().data());
     fflush(stderr);
 }
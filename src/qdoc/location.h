@@ -55,6 +55,7 @@ public:
     static void information(const QString &message);
     static void internalError(const QString &hint);
     static int exitCode();
+    static int messageCount() { return s_messageCount; }
 
 private:
     enum MessageType { Warning, Error, Report };
@@ -79,6 +80,7 @@ private:
 
     static int s_tabSize;
     static int s_warningCount;
+    static int s_messageCount;
     static int s_warningLimit;
     static QString s_programName;
     static QString s_project;
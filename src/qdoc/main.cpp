@@ -8,6 +8,7 @@
 #include "cppcodemarker.h"
 #include "doc.h"
 #include "docbookgenerator.h"
+#include "doccache.h"
 #include "htmlgenerator.h"
 #include "location.h"
 #include "puredocparser.h"
@@ -23,6 +24,7 @@
 #include "filesystem/fileresolver.h"
 #include "boundaries/filesystem/directorypath.h"
 
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdatetime.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qglobal.h>
@@ -339,6 +341,17 @@ static void processQdocconfFile(const QString &fileName)
 
     FileResolver file_resolver{std::move(validated_search_directories)};
 
+    // Share the listing of the search directories with the other runs
+    // that use the same cache directory, such as the generate phase.
+    const QString cacheDir = config.getString(CONFIG_CACHEDIR);
+    if (!cacheDir.isEmpty()) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        for (const DirectoryPath &directory : file_resolver.get_search_directories())
+            hash.addData(directory.value().toUtf8() + '\n');
+        file_resolver.use_snapshot(cacheDir + QLatin1String("/directories/")
+                                   + QString::fromLatin1(hash.result().toHex()));
+    }
+
     // REMARK: The constructor for generators doesn't actually perform
     // initialization of their content.
     // Indeed, Generators use the general antipattern of the static
@@ -386,6 +399,7 @@ static void processQdocconfFile(const QString &fileName)
     CodeParser::initialize();
     Generator::initialize();
     Doc::initialize(file_resolver);
+    DocCache::instance().initialize();
 
 #ifndef QT_NO_TRANSLATION
     /*
@@ -538,6 +552,20 @@ static void processQdocconfFile(const QString &fileName)
 
         clangParser_->precompileHeaders();
 
+        /*
+          Let the clang parser run libclang ahead of time on worker
+          threads for the C++ sources, in the order they are parsed
+          below. The resulting trees are still visited one by one.
+        */
+        if (const int jobs = config.jobCount(); jobs > 1) {
+            QStringList clangSources;
+            for (auto it = sources.cbegin(), end = sources.cend(); it != end; ++it) {
+                if (CodeParser::parserForSourceFile(it.key()) == clangParser_)
+                    clangSources << it.key();
+            }
+            clangParser_->setSourceFilesToParse(clangSources, jobs);
+        }
+
         /*
           Parse each source text file in the set using the appropriate parser and
           add it to the big tree.
@@ -591,6 +619,7 @@ static void processQdocconfFile(const QString &fileName)
     Generator::terminate();
     CodeParser::terminate();
     CodeMarker::terminate();
+    DocCache::instance().terminate();
     Doc::terminate();
     Tokenizer::terminate();
     Location::terminate();
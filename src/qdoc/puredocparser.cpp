@@ -3,6 +3,7 @@
 
 #include "puredocparser.h"
 
+#include "doccache.h"
 #include "qdocdatabase.h"
 #include "tokenizer.h"
 
@@ -38,11 +39,8 @@ void PureDocParser::parseSourceFile(const Location &location, const QString &fil
         m_currentFile.clear();
         return;
     }
-
-    Location fileLocation(filePath);
-    Tokenizer fileTokenizer(fileLocation, in);
-    m_tokenizer = &fileTokenizer;
-    m_token = m_tokenizer->getToken();
+    const QByteArray content = in.readAll();
+    in.close();
 
     /*
       The set of open namespaces is cleared before parsing
@@ -50,8 +48,22 @@ void PureDocParser::parseSourceFile(const Location &location, const QString &fil
      */
     m_qdb->clearOpenNamespaces();
 
-    processQdocComments();
-    in.close();
+    DocCache &cache = DocCache::instance();
+    CachedCommentList comments;
+    if (cache.find(filePath, content, comments)) {
+        for (const auto &comment : std::as_const(comments))
+            processDoc(comment.m_doc);
+    } else {
+        Location fileLocation(filePath);
+        Tokenizer fileTokenizer(fileLocation, content);
+        m_tokenizer = &fileTokenizer;
+        m_token = m_tokenizer->getToken();
+
+        cache.beginFile(filePath, content);
+        processQdocComments();
+        cache.endFile();
+        m_tokenizer = nullptr;
+    }
     m_currentFile.clear();
 }
 
@@ -75,22 +87,8 @@ bool PureDocParser::processQdocComments()
 
             // Doc constructor parses the comment.
             Doc doc(start_loc, end_loc, comment, commands, topicCommands());
-            const TopicList &topics = doc.topicsUsed();
-            if (topics.isEmpty()) {
-                doc.location().warning(QStringLiteral("This qdoc comment contains no topic command "
-                                                      "(e.g., '\\%1', '\\%2').")
-                                               .arg(COMMAND_MODULE, COMMAND_PAGE));
-                continue;
-            }
-            if (hasTooManyTopics(doc))
-                continue;
-
-            DocList docs;
-            NodeList nodes;
-            QString topic = topics[0].m_topic;
-
-            processTopicArgs(doc, topic, nodes, docs);
-            processMetaCommands(nodes, docs);
+            DocCache::instance().addComment(CachedComment { doc });
+            processDoc(doc);
         } else {
             m_token = m_tokenizer->getToken();
         }
@@ -98,4 +96,28 @@ bool PureDocParser::processQdocComments()
     return true;
 }
 
+/*!
+  Adds the nodes documented by the parsed qdoc comment \a doc
+  to the database.
+ */
+void PureDocParser::processDoc(const Doc &doc)
+{
+    const TopicList &topics = doc.topicsUsed();
+    if (topics.isEmpty()) {
+        doc.location().warning(QStringLiteral("This qdoc comment contains no topic command "
+                                              "(e.g., '\\%1', '\\%2').")
+                                       .arg(COMMAND_MODULE, COMMAND_PAGE));
+        return;
+    }
+    if (hasTooManyTopics(doc))
+        return;
+
+    DocList docs;
+    NodeList nodes;
+    QString topic = topics[0].m_topic;
+
+    processTopicArgs(doc, topic, nodes, docs);
+    processMetaCommands(nodes, docs);
+}
+
 QT_END_NAMESPACE
@@ -21,6 +21,7 @@ public:
 
 private:
     bool processQdocComments();
+    void processDoc(const Doc &doc);
     Tokenizer *m_tokenizer { nullptr };
     int m_token { 0 };
 };
@@ -35,7 +35,9 @@ QDocCommandLineParser::QDocCommandLineParser()
       frameworkOption("F", "Add macOS framework to the include path for header files.",
                       "framework"),
       timestampsOption(QStringList() << QStringLiteral("timestamps")),
-      useDocBookExtensions(QStringList() << QStringLiteral("docbook-extensions"))
+      useDocBookExtensions(QStringList() << QStringLiteral("docbook-extensions")),
+      jobsOption(QStringList() << QStringLiteral("jobs")),
+      cacheDirOption(QStringList() << QStringLiteral("cachedir"))
 {
     setApplicationDescription(QCoreApplication::translate("qdoc", "Qt documentation generator"));
     addHelpOption();
@@ -140,6 +142,17 @@ QDocCommandLineParser::QDocCommandLineParser()
     useDocBookExtensions.setDescription(QCoreApplication::translate(
             "qdoc", "Use the DocBook Library extensions for metadata."));
     addOption(useDocBookExtensions);
+
+    jobsOption.setDescription(QCoreApplication::translate(
+            "qdoc", "Use up to n threads for work that can run concurrently; 0 uses one "
+                    "thread per core."));
+    jobsOption.setValueName(QStringLiteral("n"));
+    addOption(jobsOption);
+
+    cacheDirOption.setDescription(QCoreApplication::translate(
+            "qdoc", "Specify a directory where QDoc keeps parsing results between runs"));
+    cacheDirOption.setValueName(QStringLiteral("dir"));
+    addOption(cacheDirOption);
 }
 
 /*!
@@ -5,6 +5,7 @@
 
 #include "atom.h"
 #include "collectionnode.h"
+#include "doc.h"
 #include "functionnode.h"
 #include "generator.h"
 #include "qdocindexfiles.h"
@@ -329,6 +330,20 @@ const FunctionNode *QDocForest::findFunctionNode(const QStringList &path,
     return nullptr;
 }
 
+/*
+  Returns the node where a search that begins at \a relative and
+  moves up the parent chain can first find a match. Nodes that
+  aren't aggregates have no children, so the searches skip them;
+  lookups from any member of an aggregate therefore give the
+  same result.
+ */
+static const Node *searchStart(const Node *relative)
+{
+    while (relative && !relative->isAggregate() && relative->parent())
+        relative = relative->parent();
+    return relative;
+}
+
 /*! \class QDocDatabase
   This class provides exclusive access to the qdoc database,
   which consists of a forrest of trees and a lot of maps and
@@ -951,6 +966,7 @@ const NodeMultiMap &QDocDatabase::getSinceMap(const QString &key)
  */
 void QDocDatabase::resolveStuff()
 {
+    resetLookupCache(false);
     const auto &config = Config::instance();
     if (config.dualExec() || config.preparing()) {
         // order matters
@@ -983,6 +999,84 @@ void QDocDatabase::resolveStuff()
     }
     if (config.dualExec())
         QDocIndexFiles::destroyQDocIndexFiles();
+
+    // From now on, the trees don't change until the next project
+    resetLookupCache(true);
+}
+
+/*!
+  Clears the memoized results of findTypeNode(), findFunctionNode(),
+  findNodeForTarget() and findNodeForAtom(), and the forest-wide
+  lookup indexes. If \a enabled is \c true, the indexes are built
+  again and further results are memoized.
+
+  Lookups are only memoized after resolveStuff(), while the
+  documentation is generated. Making any change to the forest
+  disables memoizing again.
+ */
+void QDocDatabase::resetLookupCache(bool enabled)
+{
+    m_lookupCache.clear();
+    m_childNames.clear();
+    m_treesByTitle.clear();
+    m_titleIndexBuilt = false;
+    m_lookupCacheEnabled = enabled;
+    if (!enabled)
+        return;
+
+    // The names don't depend on the search order, so index every tree
+    QSet<const Tree *> trees;
+    if (primaryTree())
+        trees.insert(primaryTree());
+    for (const auto *tree : std::as_const(m_forest.m_forest))
+        trees.insert(tree);
+    for (const auto *tree : std::as_const(trees))
+        tree->root()->findAllChildNames(m_childNames);
+}
+
+/*!
+  Clears the lookup results that depend on the search order,
+  without turning memoizing off. Called whenever the search
+  order changes.
+ */
+void QDocDatabase::searchOrderChanged()
+{
+    m_lookupCache.clear();
+    m_treesByTitle.clear();
+    m_titleIndexBuilt = false;
+}
+
+/*!
+  Maps each page title to the first tree in the search order
+  that has a page with that title.
+ */
+void QDocDatabase::buildTitleIndex()
+{
+    for (const auto *tree : searchOrder()) {
+        for (auto it = tree->m_pageNodesByTitle.cbegin(); it != tree->m_pageNodesByTitle.cend();
+             ++it) {
+            if (!m_treesByTitle.contains(it.key()))
+                m_treesByTitle.insert(it.key(), tree);
+        }
+    }
+    m_titleIndexBuilt = true;
+}
+
+/*!
+  Returns the page node with the specified \a title, searching
+  the trees in the search order. Once the trees are resolved,
+  the tree to search is looked up in the title index.
+ */
+const PageNode *QDocDatabase::findPageNodeByTitle(const QString &title)
+{
+    if (!m_lookupCacheEnabled)
+        return m_forest.findPageNodeByTitle(title);
+
+    if (!m_titleIndexBuilt)
+        buildTitleIndex();
+    const Tree *tree = m_treesByTitle.value(
+            title.contains(QChar(' ')) ? Doc::canonicalTitle(title) : title);
+    return tree ? tree->findPageNodeByTitle(title) : nullptr;
 }
 
 void QDocDatabase::resolveBaseClasses()
@@ -1157,7 +1251,15 @@ const FunctionNode *QDocDatabase::findFunctionNode(const QString &target, const
         function = function.left(position);
     }
     QStringList path = function.split("::");
-    return m_forest.findFunctionNode(path, Parameters(signature), relative, genus);
+    if (!m_lookupCacheEnabled)
+        return m_forest.findFunctionNode(path, Parameters(signature), relative, genus);
+
+    const LookupKey key { LookupKey::FindFunctionNode, target, relative, nullptr, genus };
+    if (auto it = m_lookupCache.constFind(key); it != m_lookupCache.cend())
+        return static_cast<const FunctionNode *>(it->m_node);
+    const FunctionNode *fn = m_forest.findFunctionNode(path, Parameters(signature), relative, genus);
+    m_lookupCache.insert(key, { fn });
+    return fn;
 }
 
 /*!
@@ -1178,7 +1280,22 @@ const Node *QDocDatabase::findTypeNode(const QString &type, const Node *relative
         if (it != s_typeNodeMap.end())
             return it.value();
     }
-    return m_forest.findTypeNode(path, relative, genus);
+    if (!m_lookupCacheEnabled)
+        return m_forest.findTypeNode(path, relative, genus);
+    if (!m_childNames.contains(path.last()))
+        return nullptr;
+
+    // Key the result by what the search depends on; see searchStart()
+    Node::Genus searchGenus = genus;
+    if (relative && genus == Node::DontCare && relative->genus() != Node::DOC)
+        searchGenus = relative->genus();
+    const LookupKey key { LookupKey::FindTypeNode, type, searchStart(relative), nullptr,
+                          searchGenus };
+    if (auto it = m_lookupCache.constFind(key); it != m_lookupCache.cend())
+        return it->m_node;
+    const Node *node = m_forest.findTypeNode(path, relative, genus);
+    m_lookupCache.insert(key, { node });
+    return node;
 }
 
 /*!
@@ -1192,18 +1309,31 @@ const Node *QDocDatabase::findNodeForTarget(const QString &target, const Node *r
     const Node *node = nullptr;
     if (target.isEmpty())
         node = relative;
-    else if (target.endsWith(".html"))
-        node = findNodeByNameAndType(QStringList(target), &Node::isPageNode);
-    else {
+    else if (target.endsWith(".html")) {
+        if (!m_lookupCacheEnabled || m_childNames.contains(target))
+            node = findNodeByNameAndType(QStringList(target), &Node::isPageNode);
+    } else {
+        const LookupKey key { LookupKey::FindNodeForTarget, target, searchStart(relative),
+                              nullptr, Node::DontCare };
+        if (m_lookupCacheEnabled) {
+            if (auto it = m_lookupCache.constFind(key); it != m_lookupCache.cend())
+                return it->m_node;
+        }
         QStringList path = target.split("::");
         int flags = SearchBaseClasses | SearchEnumValues;
-        for (const auto *tree : searchOrder()) {
-            const Node *n = tree->findNode(path, relative, flags, Node::DontCare);
-            if (n)
-                return n;
-            relative = nullptr;
+        // No tree has a node by that name; only a page title can match
+        if (!m_lookupCacheEnabled || m_childNames.contains(path.last())) {
+            for (const auto *tree : searchOrder()) {
+                node = tree->findNode(path, relative, flags, Node::DontCare);
+                if (node)
+                    break;
+                relative = nullptr;
+            }
         }
-        node = findPageNodeByTitle(target);
+        if (!node)
+            node = findPageNodeByTitle(target);
+        if (m_lookupCacheEnabled)
+            m_lookupCache.insert(key, { node });
     }
     return node;
 }
@@ -1513,6 +1643,28 @@ void QDocDatabase::mergeCollections(CollectionNode *c)
  */
 const Node *QDocDatabase::findNodeForAtom(const Atom *a, const Node *relative, QString &ref,
                                           Node::Genus genus)
+{
+    if (!m_lookupCacheEnabled || !ref.isEmpty())
+        return findNodeForAtomUncached(a, relative, ref, genus);
+
+    Atom *atom = const_cast<Atom *>(a);
+    const LookupKey key { LookupKey::FindNodeForAtom, atom->string(), relative,
+                          atom->isLinkAtom() ? atom->domain() : nullptr,
+                          atom->isLinkAtom() ? atom->genus() : genus };
+    if (auto it = m_lookupCache.constFind(key); it != m_lookupCache.cend()) {
+        ref = it->m_ref;
+        return it->m_node;
+    }
+    const Node *node = findNodeForAtomUncached(a, relative, ref, genus);
+    m_lookupCache.insert(key, { node, ref });
+    return node;
+}
+
+/*!
+  Does the work of findNodeForAtom(), without memoizing the result.
+ */
+const Node *QDocDatabase::findNodeForAtomUncached(const Atom *a, const Node *relative,
+                                                  QString &ref, Node::Genus genus)
 {
     const Node *node = nullptr;
 
@@ -11,7 +11,9 @@
 #include "tree.h"
 
 #include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qmap.h>
+#include <QtCore/qset.h>
 #include <QtCore/qstring.h>
 
 QT_BEGIN_NAMESPACE
@@ -276,10 +278,7 @@ public:
                                          Node::Genus genus);
     const Node *findTypeNode(const QString &type, const Node *relative, Node::Genus genus);
     const Node *findNodeForTarget(const QString &target, const Node *relative);
-    const PageNode *findPageNodeByTitle(const QString &title)
-    {
-        return m_forest.findPageNodeByTitle(title);
-    }
+    const PageNode *findPageNodeByTitle(const QString &title);
     Node *findNodeByNameAndType(const QStringList &path, bool (Node::*isMatch)() const)
     {
         return m_forest.findNodeByNameAndType(path, isMatch);
@@ -332,16 +331,44 @@ public:
     // Try to make this function private.
     QDocForest &forest() { return m_forest; }
     NamespaceNode *primaryTreeRoot() { return m_forest.primaryTreeRoot(); }
-    void newPrimaryTree(const QString &module) { m_forest.newPrimaryTree(module); }
-    void setPrimaryTree(const QString &t) { m_forest.setPrimaryTree(t); }
-    NamespaceNode *newIndexTree(const QString &module) { return m_forest.newIndexTree(module); }
+    void newPrimaryTree(const QString &module)
+    {
+        resetLookupCache(false);
+        m_forest.newPrimaryTree(module);
+    }
+    void setPrimaryTree(const QString &t)
+    {
+        resetLookupCache(false);
+        m_forest.setPrimaryTree(t);
+    }
+    NamespaceNode *newIndexTree(const QString &module)
+    {
+        resetLookupCache(false);
+        return m_forest.newIndexTree(module);
+    }
     const QList<Tree *> &searchOrder() { return m_forest.searchOrder(); }
-    void setLocalSearch() { m_forest.m_searchOrder = QList<Tree *>(1, primaryTree()); }
-    void setSearchOrder(const QList<Tree *> &searchOrder) { m_forest.m_searchOrder = searchOrder; }
-    void setSearchOrder(QStringList &t) { m_forest.setSearchOrder(t); }
+    void setLocalSearch()
+    {
+        m_forest.m_searchOrder = QList<Tree *>(1, primaryTree());
+        searchOrderChanged();
+    }
+    void setSearchOrder(const QList<Tree *> &searchOrder)
+    {
+        m_forest.m_searchOrder = searchOrder;
+        searchOrderChanged();
+    }
+    void setSearchOrder(QStringList &t)
+    {
+        m_forest.setSearchOrder(t);
+        searchOrderChanged();
+    }
     void mergeCollections(Node::NodeType type, CNMap &cnm, const Node *relative);
     void mergeCollections(CollectionNode *c);
-    void clearSearchOrder() { m_forest.clearSearchOrder(); }
+    void clearSearchOrder()
+    {
+        m_forest.clearSearchOrder();
+        searchOrderChanged();
+    }
     QStringList keys() { return m_forest.keys(); }
     void resolveNamespaces();
     void resolveProxies();
@@ -391,6 +418,55 @@ private:
     NodeMapMap m_functionIndex {};
     TextToNodeMap m_legaleseTexts {};
     QSet<QString> m_openNamespaces {};
+
+    /*
+      Results of link and type lookups, memoized once the trees
+      have been resolved and no longer change.
+     */
+    struct LookupKey
+    {
+        enum Kind { FindTypeNode, FindFunctionNode, FindNodeForTarget, FindNodeForAtom };
+        Kind m_kind;
+        QString m_target;
+        const Node *m_relative;
+        const Tree *m_domain;
+        int m_genus;
+
+        friend bool operator==(const LookupKey &a, const LookupKey &b)
+        {
+            return a.m_kind == b.m_kind && a.m_relative == b.m_relative
+                    && a.m_domain == b.m_domain && a.m_genus == b.m_genus
+                    && a.m_target == b.m_target;
+        }
+        friend size_t qHash(const LookupKey &key, size_t seed = 0)
+        {
+            return qHashMulti(seed, key.m_kind, key.m_target, key.m_relative, key.m_domain,
+                              key.m_genus);
+        }
+    };
+    struct LookupResult
+    {
+        const Node *m_node { nullptr };
+        QString m_ref {};
+    };
+
+    void resetLookupCache(bool enabled);
+    void searchOrderChanged();
+    void buildTitleIndex();
+    const Node *findNodeForAtomUncached(const Atom *atom, const Node *relative, QString &ref,
+                                        Node::Genus genus);
+
+    bool m_lookupCacheEnabled { false };
+    QHash<LookupKey, LookupResult> m_lookupCache {};
+
+    /*
+      Forest-wide indexes, built along with the memo. Every name
+      a child can be found by in any tree, and for each page
+      title, the first tree in the search order that has it.
+     */
+    QSet<QString> m_childNames {};
+    QHash<QString, const Tree *> m_treesByTitle {};
+    bool m_titleIndexBuilt { false };
 };
 
 QT_END_NAMESPACE
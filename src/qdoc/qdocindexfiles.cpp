@@ -5,6 +5,7 @@
 
 #include "access.h"
 #include "atom.h"
+#include "binaryindex.h"
 #include "classnode.h"
 #include "collectionnode.h"
 #include "config.h"
@@ -105,6 +106,14 @@ void QDocIndexFiles::readIndexes(const QStringList &indexFiles)
  */
 void QDocIndexFiles::readIndexFile(const QString &path)
 {
+    // Prefer the binary form of the index, when it is up to date
+    BinaryIndexReader binaryReader(path);
+    if (binaryReader.isValid()) {
+        qCDebug(lcQdoc) << "Reading binary index file:" << BinaryIndexReader::binaryPath(path);
+        readIndex(binaryReader, path);
+        return;
+    }
+
     QFile file(path);
     if (!file.open(QFile::ReadOnly)) {
         qWarning() << "Could not read index file" << path;
@@ -113,7 +122,16 @@ void QDocIndexFiles::readIndexFile(const QString &path)
 
     QXmlStreamReader reader(&file);
     reader.setNamespaceProcessing(false);
+    readIndex(reader, path);
+}
 
+/*!
+  Reads the index file \a path with \a reader, which is either a
+  QXmlStreamReader or a BinaryIndexReader.
+ */
+template <typename Reader>
+void QDocIndexFiles::readIndex(Reader &reader, const QString &path)
+{
     if (!reader.readNextStartElement())
         return;
 
@@ -163,8 +181,8 @@ void QDocIndexFiles::readIndexFile(const QString &path)
   Read a <section> element from the index file and create the
   appropriate node(s).
  */
-void QDocIndexFiles::readIndexSection(QXmlStreamReader &reader, Node *current,
-                                      const QString &indexUrl)
+template <typename Reader>
+void QDocIndexFiles::readIndexSection(Reader &reader, Node *current, const QString &indexUrl)
 {
     QXmlStreamAttributes attributes = reader.attributes();
     QStringView elementName = reader.name();
@@ -1414,6 +1432,9 @@ void QDocIndexFiles::generateIndex(const QString &fileName, const QString &url,
     writer.writeEndElement(); // QDOCINDEX
     writer.writeEndDocument();
     file.close();
+
+    if (!BinaryIndexReader::write(fileName))
+        qCDebug(lcQdoc) << "Could not write binary index file for" << fileName;
 }
 
 QT_END_NAMESPACE
@@ -7,6 +7,8 @@
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qregularexpression.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 QHash<QString, QString> Quoter::s_commentHash;
@@ -81,6 +83,80 @@ static void trimWhiteSpace(QString &str)
     str.resize(++j);
 }
 
+std::shared_ptr<const QuotedFile> QuotedFile::create(const QString &userFriendlyFilePath,
+                                                     const QString &plainCode,
+                                                     const QString &markedCode)
+{
+    auto file = std::make_shared<QuotedFile>();
+
+    /*
+      Split the source code into logical lines. Empty lines are
+      treated specially. Before:
+
+   p->alpha();
+   p->beta();
+
+   p->gamma();
+
+
+   p->delta();
+
+      After:
+
+   p->alpha();
+   p->beta();\n
+   p->gamma();\n\n
+   p->delta();
+
+      Newlines are preserved because they affect codeLocation.
+    */
+    file->m_plainLines = Quoter::splitLines(plainCode);
+    file->m_markedLines = Quoter::splitLines(markedCode);
+    if (file->m_markedLines.size() != file->m_plainLines.size()) {
+        Location(userFriendlyFilePath).warning(
+                QStringLiteral("Something is wrong with qdoc's handling of marked code"));
+        file->m_markedLines = file->m_plainLines;
+    }
+
+    /*
+      Squeeze blanks (cat -s).
+    */
+    int lineNumber = 0;
+    file->m_lineNumbers.reserve(file->m_markedLines.size() + 1);
+    for (auto &line : file->m_markedLines) {
+        replaceMultipleNewlines(line);
+        file->m_lineNumbers.append(lineNumber);
+        lineNumber += line.count(QLatin1Char('\n')) + 1;
+    }
+    file->m_lineNumbers.append(lineNumber);
+
+    /*
+      Index the snippet delimiters the way Quoter::match() compares
+      them, so that quoteSnippet() can jump to them.
+    */
+    QString opening = Quoter::commentForFile(QFileInfo(userFriendlyFilePath).fileName());
+    trimWhiteSpace(opening);
+    opening += QLatin1Char('[');
+    for (qsizetype i = 0; i < file->m_plainLines.size(); ++i) {
+        if (!file->m_plainLines.at(i).contains(QLatin1Char('[')))
+            continue;
+        QString str = file->m_plainLines.at(i);
+        while (str.endsWith(QLatin1Char('\n')))
+            str.chop(1);
+        trimWhiteSpace(str);
+        for (qsizetype from = str.indexOf(opening); from != -1;
+             from = str.indexOf(opening, from + 1)) {
+            const qsizetype close = str.indexOf(QLatin1Char(']'), from + opening.size());
+            if (close == -1)
+                break;
+            auto &lines = file->m_snippetLines[str.mid(from, close - from + 1)];
+            if (lines.isEmpty() || lines.constLast() != i)
+                lines.append(i);
+        }
+    }
+    return file;
+}
+
 Quoter::Quoter() : m_silent(false)
 {
     /* We're going to hard code these delimiters:
@@ -106,59 +182,25 @@ Quoter::Quoter() : m_silent(false)
 void Quoter::reset()
 {
     m_silent = false;
-    m_plainLines.clear();
-    m_markedLines.clear();
+    m_file.reset();
+    m_line = 0;
     m_codeLocation = Location();
 }
 
-void Quoter::quoteFromFile(const QString &userFriendlyFilePath, const QString &plainCode,
-                           const QString &markedCode)
+void Quoter::quoteFromFile(const QString &userFriendlyFilePath,
+                           std::shared_ptr<const QuotedFile> file)
 {
     m_silent = false;
-
-    /*
-      Split the source code into logical lines. Empty lines are
-      treated specially. Before:
-
-   p->alpha();
-   p->beta();
-
-   p->gamma();
-
-
-   p->delta();
-
-      After:
-
-   p->alpha();
-   p->beta();\n
-   p->gamma();\n\n
-   p->delta();
-
-      Newlines are preserved because they affect codeLocation.
-    */
     m_codeLocation = Location(userFriendlyFilePath);
-
-    m_plainLines = splitLines(plainCode);
-    m_markedLines = splitLines(markedCode);
-    if (m_markedLines.size() != m_plainLines.size()) {
-        m_codeLocation.warning(
-                QStringLiteral("Something is wrong with qdoc's handling of marked code"));
-        m_markedLines = m_plainLines;
-    }
-
-    /*
-      Squeeze blanks (cat -s).
-    */
-    for (auto &line : m_markedLines)
-        replaceMultipleNewlines(line);
+    m_file = std::move(file);
+    m_line = 0;
     m_codeLocation.start();
 }
 
 QString Quoter::quoteLine(const Location &docLocation, const QString &command,
                           const QString &pattern)
 {
-    if (m_plainLines.isEmpty()) {
+    if (atEnd()) {
         failedAtEnd(docLocation, command);
         return QString();
     }
@@ -168,7 +210,7 @@ QString Quoter::quoteLine(const Location &docLocation, const QString &command,
         return QString();
     }
 
-    if (match(docLocation, pattern, m_plainLines.first()))
+    if (match(docLocation, pattern, plainLine()))
         return getLine();
 
     if (!m_silent) {
@@ -186,8 +228,25 @@ QString Quoter::quoteSnippet(const Location &docLocation, const QString &identif
     QString t;
     int indent = 0;
 
-    while (!m_plainLines.isEmpty()) {
-        if (match(docLocation, delimiter, m_plainLines.first())) {
+    // Look the delimiter up in the index of the file instead of matching
+    // every line, unless brackets in the identifier could confuse the index
+    const QList<qsizetype> *delimiterLines = nullptr;
+    if (m_file && !identifier.contains(QLatin1Char('[')) && !identifier.contains(QLatin1Char(']'))) {
+        static const QList<qsizetype> noLines;
+        QString key = delimiter;
+        trimWhiteSpace(key);
+        const auto it = m_file->m_snippetLines.constFind(key);
+        delimiterLines = it != m_file->m_snippetLines.cend() ? &it.value() : &noLines;
+    }
+    const auto nextDelimiterLine = [this, delimiterLines] {
+        const auto it = std::lower_bound(delimiterLines->cbegin(), delimiterLines->cend(), m_line);
+        return it != delimiterLines->cend() ? *it : m_file->m_plainLines.size();
+    };
+
+    if (delimiterLines)
+        skipTo(nextDelimiterLine());
+    while (!atEnd()) {
+        if (delimiterLines || match(docLocation, delimiter, plainLine())) {
             QString startLine = getLine();
             while (indent < startLine.size() && startLine[indent] == QLatin1Char(' '))
                 indent++;
@@ -195,9 +254,10 @@ QString Quoter::quoteSnippet(const Location &docLocation, const QString &identif
         }
         getLine();
     }
-    while (!m_plainLines.isEmpty()) {
-        QString line = m_plainLines.first();
-        if (match(docLocation, delimiter, line)) {
+    const qsizetype endLine = delimiterLines && !atEnd() ? nextDelimiterLine() : -1;
+    while (!atEnd()) {
+        QString line = plainLine();
+        if (delimiterLines ? m_line == endLine : match(docLocation, delimiter, line)) {
             QString lastLine = getLine(indent);
             qsizetype dIndex = lastLine.indexOf(delimiter);
             if (dIndex > 0) {
@@ -227,13 +287,13 @@ QString Quoter::quoteTo(const Location &docLocation, const QString &command, con
     QString comment = commentForCode();
 
     if (pattern.isEmpty()) {
-        while (!m_plainLines.isEmpty()) {
-            QString line = m_plainLines.first();
+        while (!atEnd()) {
+            QString line = plainLine();
             t += removeSpecialLines(line, comment);
         }
     } else {
-        while (!m_plainLines.isEmpty()) {
-            if (match(docLocation, pattern, m_plainLines.first())) {
+        while (!atEnd()) {
+            if (match(docLocation, pattern, plainLine())) {
                 return t;
             }
             t += getLine();
@@ -251,14 +311,18 @@ QString Quoter::quoteUntil(const Location &docLocation, const QString &command,
     return t;
 }
 
+void Quoter::skipTo(qsizetype line)
+{
+    m_codeLocation.advanceLines(m_file->m_lineNumbers.at(line) - m_file->m_lineNumbers.at(m_line));
+    m_line = line;
+}
+
 QString Quoter::getLine(int unindent)
 {
-    if (m_plainLines.isEmpty())
+    if (atEnd())
         return QString();
 
-    m_plainLines.removeFirst();
-
-    QString t = m_markedLines.takeFirst();
+    QString t = m_file->m_markedLines.at(m_line++);
     int i = 0;
     while (i < unindent && i < t.size() && t[i] == QLatin1Char(' '))
         i++;
@@ -306,7 +370,12 @@ void Quoter::failedAtEnd(const Location &docLocation, const QString &command)
 
 QString Quoter::commentForCode() const
 {
-    QFileInfo fi = QFileInfo(m_codeLocation.fileName());
+    return commentForFile(m_codeLocation.fileName());
+}
+
+QString Quoter::commentForFile(const QString &fileName)
+{
+    QFileInfo fi = QFileInfo(fileName);
     if (fi.fileName() == "CMakeLists.txt")
         return "#!";
     return s_commentHash.value(fi.suffix(), "//!");
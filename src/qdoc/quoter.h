@@ -7,26 +7,55 @@
 #include "location.h"
 
 #include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
 #include <QtCore/qstringlist.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
+/*
+  The lines of a quoted file, which do not change however often the
+  file is quoted.
+*/
+struct QuotedFile
+{
+    static std::shared_ptr<const QuotedFile> create(const QString &userFriendlyFilePath,
+                                                    const QString &plainCode,
+                                                    const QString &markedCode);
+
+    QStringList m_plainLines {};
+    QStringList m_markedLines {};
+    // The number of source lines before each line, for codeLocation
+    QList<int> m_lineNumbers {};
+    // The lines on which each snippet delimiter, with white space
+    // trimmed, appears
+    QHash<QString, QList<qsizetype>> m_snippetLines {};
+};
+
 class Quoter
 {
 public:
     Quoter();
 
     void reset();
-    void quoteFromFile(const QString &userFriendlyFileName, const QString &plainCode,
-                       const QString &markedCode);
+    void quoteFromFile(const QString &userFriendlyFileName,
+                       std::shared_ptr<const QuotedFile> file);
     QString quoteLine(const Location &docLocation, const QString &command, const QString &pattern);
     QString quoteTo(const Location &docLocation, const QString &command, const QString &pattern);
     QString quoteUntil(const Location &docLocation, const QString &command, const QString &pattern);
     QString quoteSnippet(const Location &docLocation, const QString &identifier);
 
     static QStringList splitLines(const QString &line);
+    static QString commentForFile(const QString &fileName);
 
 private:
+    [[nodiscard]] bool atEnd() const
+    {
+        return !m_file || m_line >= m_file->m_plainLines.size();
+    }
+    [[nodiscard]] const QString &plainLine() const { return m_file->m_plainLines.at(m_line); }
+    void skipTo(qsizetype line);
     QString getLine(int unindent = 0);
     void failedAtEnd(const Location &docLocation, const QString &command);
     bool match(const Location &docLocation, const QString &pattern, const QString &line);
@@ -34,8 +63,8 @@ private:
     QString removeSpecialLines(const QString &line, const QString &comment, int unindent = 0);
 
     bool m_silent {};
-    QStringList m_plainLines {};
-    QStringList m_markedLines {};
+    std::shared_ptr<const QuotedFile> m_file {};
+    qsizetype m_line { 0 };
     Location m_codeLocation {};
     static QHash<QString, QString> s_commentHash;
 };
@@ -32,6 +32,8 @@
 #include <QtCore/qdir.h>
 #include <QtCore/qlibraryinfo.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE
 
 typedef QMap<QString, bool> widget_map;
@@ -536,6 +538,18 @@ public:
     void setupWidgetMap() const;
 };
 
+class QUiTemplatePrivate : public QSharedData
+{
+public:
+#ifdef QFORMINTERNAL_NAMESPACE
+    std::unique_ptr<QFormInternal::DomUI> ui;
+    QFormInternal::QFormBuilderPropertyCache propertyCache;
+#else
+    std::unique_ptr<DomUI> ui;
+    QFormBuilderPropertyCache propertyCache;
+#endif
+};
+
 void QUiLoaderPrivate::setupWidgetMap() const
 {
     if (!g_widgets()->isEmpty())
@@ -600,12 +614,84 @@ void QUiLoaderPrivate::setupWidgetMap() const
     example, you might want to have a list of the actions created when loading
     a form or creating a custom widget.
 
+    If the same form is created many times, for example for the rows of a
+    view, use loadTemplate() to parse the UI file only once and pass the
+    returned QUiTemplate to load() for each instance.
+
     For a complete example using the QUiLoader class, see the
     \l{Calculator Builder}.
 
     \sa {Qt UI Tools}, QFormBuilder
 */
 
+/*!
+    \class QUiTemplate
+    \inmodule QtUiTools
+    \since 6.6
+
+    \brief The QUiTemplate class holds a parsed UI file that can be
+    instantiated repeatedly by QUiLoader.
+
+    A template is created by QUiLoader::loadTemplate() and turned into
+    widgets by QUiLoader::load(). Besides sparing the parsing of the XML,
+    the template keeps the property values it converted and the indexes of
+    the properties in each class, so that creating further instances does
+    not look the properties up again.
+
+    QUiTemplate is implicitly shared. It may be used with several loaders,
+    but only from the thread that creates the widgets.
+
+    \sa QUiLoader
+*/
+
+/*!
+    Constructs a null template.
+
+    \sa isNull()
+*/
+QUiTemplate::QUiTemplate() noexcept = default;
+
+/*!
+    Constructs a copy of \a other. The parsed form is shared.
+*/
+QUiTemplate::QUiTemplate(const QUiTemplate &other) noexcept = default;
+
+/*!
+    Assigns \a other to this template and returns a reference to it.
+*/
+QUiTemplate &QUiTemplate::operator=(const QUiTemplate &other) noexcept = default;
+
+/*!
+    \fn QUiTemplate::QUiTemplate(QUiTemplate &&other)
+
+    Move-constructs a template from \a other, which becomes null.
+*/
+
+/*!
+    \fn QUiTemplate &QUiTemplate::operator=(QUiTemplate &&other)
+
+    Move-assigns \a other to this template and returns a reference to it.
+*/
+
+/*!
+    \fn void QUiTemplate::swap(QUiTemplate &other)
+
+    Swaps this template with \a other. This operation is very fast and
+    never fails.
+*/
+
+/*!
+    Destroys the template.
+*/
+QUiTemplate::~QUiTemplate() = default;
+
+/*!
+    \fn bool QUiTemplate::isNull() const
+
+    Returns \c true if the template does not hold a form, for example
+    because the UI file could not be read.
+*/
+
 /*!
     Creates a form loader with the given \a parent.
 */
@@ -656,6 +742,56 @@ QWidget *QUiLoader::load(QIODevice *device, QWidget *parentWidget)
     return d->builder.load(device, parentWidget);
 }
 
+/*!
+    \since 6.6
+
+    Reads a form from the given \a device into a template, which can be
+    passed to load() to create any number of widgets without parsing the
+    form again. Returns a null template if the form cannot be read.
+
+    \sa errorString()
+*/
+QUiTemplate QUiLoader::loadTemplate(QIODevice *device)
+{
+    Q_D(QUiLoader);
+    // QXmlStreamReader will report errors on open failure.
+    if (!device->isOpen())
+        device->open(QIODevice::ReadOnly|QIODevice::Text);
+
+    QUiTemplate result;
+    if (auto *ui = d->builder.d->readUi(device)) {
+        result.d = new QUiTemplatePrivate;
+        result.d->ui.reset(ui);
+    }
+    return result;
+}
+
+/*!
+    \since 6.6
+
+    Creates a new widget with the given \a parentWidget from the form held
+    by \a uiTemplate.
+
+    \sa loadTemplate(), errorString()
+*/
+QWidget *QUiLoader::load(const QUiTemplate &uiTemplate, QWidget *parentWidget)
+{
+    Q_D(QUiLoader);
+    auto &extra = *d->builder.d;
+    if (uiTemplate.isNull()) {
+        extra.m_errorString = extra.msgInvalidUiFile();
+        return nullptr;
+    }
+
+    extra.m_errorString.clear();
+    extra.m_propertyCache = &uiTemplate.d->propertyCache;
+    QWidget *widget = d->builder.create(uiTemplate.d->ui.get(), parentWidget);
+    extra.m_propertyCache = nullptr;
+    if (!widget && extra.m_errorString.isEmpty())
+        extra.m_errorString = extra.msgInvalidUiFile();
+    return widget;
+}
+
 /*!
     Returns a list naming the paths in which the loader will search when
     locating custom widget plugins.
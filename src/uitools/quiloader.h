@@ -7,6 +7,7 @@
 #include <QtUiTools/qtuitoolsglobal.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qscopedpointer.h>
+#include <QtCore/qshareddata.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -18,6 +19,28 @@ class QString;
 class QIODevice;
 class QDir;
 
+class QUiTemplatePrivate;
+class Q_UITOOLS_EXPORT QUiTemplate
+{
+public:
+    QUiTemplate() noexcept;
+    QUiTemplate(const QUiTemplate &other) noexcept;
+    QUiTemplate &operator=(const QUiTemplate &other) noexcept;
+    QUiTemplate(QUiTemplate &&other) noexcept = default;
+    QT_MOVE_ASSIGNMENT_OPERATOR_IMPL_VIA_PURE_SWAP(QUiTemplate)
+    ~QUiTemplate();
+
+    void swap(QUiTemplate &other) noexcept { d.swap(other.d); }
+
+    bool isNull() const noexcept { return !d; }
+
+private:
+    friend class QUiLoader;
+    QExplicitlySharedDataPointer<QUiTemplatePrivate> d;
+};
+
+Q_DECLARE_SHARED(QUiTemplate)
+
 class QUiLoaderPrivate;
 class Q_UITOOLS_EXPORT QUiLoader : public QObject
 {
@@ -31,6 +54,8 @@ public:
     void addPluginPath(const QString &path);
 
     QWidget *load(QIODevice *device, QWidget *parentWidget = nullptr);
+    QUiTemplate loadTemplate(QIODevice *device);
+    QWidget *load(const QUiTemplate &uiTemplate, QWidget *parentWidget = nullptr);
     QStringList availableWidgets() const;
     QStringList availableLayouts() const;
 
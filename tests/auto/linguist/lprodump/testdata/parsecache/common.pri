@@ -0,0 +1 @@
+TRANSLATIONS += $$PWD/shared_de.ts
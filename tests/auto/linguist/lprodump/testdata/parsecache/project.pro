@@ -0,0 +1,3 @@
+include(common.pri)
+
+SOURCES += main.cpp
@@ -0,0 +1,4 @@
+include(../common.pri)
+
+SOURCES += alpha.cpp
+TRANSLATIONS = alpha_de.ts alpha_fr.ts
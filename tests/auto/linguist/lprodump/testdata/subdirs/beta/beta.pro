@@ -0,0 +1,4 @@
+include(../common.pri)
+
+SOURCES += beta.cpp
+TRANSLATIONS = beta_de.ts beta_fr.ts
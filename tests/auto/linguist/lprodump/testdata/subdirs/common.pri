@@ -0,0 +1,2 @@
+INCLUDEPATH += $$PWD
+HEADERS += $$PWD/common.h
@@ -0,0 +1,4 @@
+include(../common.pri)
+
+SOURCES += delta.cpp
+TRANSLATIONS = delta_de.ts delta_fr.ts
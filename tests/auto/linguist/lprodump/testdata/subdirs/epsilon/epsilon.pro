@@ -0,0 +1,4 @@
+include(../common.pri)
+
+SOURCES += epsilon.cpp
+TRANSLATIONS = epsilon_de.ts epsilon_fr.ts
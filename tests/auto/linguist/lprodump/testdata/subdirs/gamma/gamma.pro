@@ -0,0 +1,4 @@
+include(../common.pri)
+
+SOURCES += gamma.cpp
+TRANSLATIONS = gamma_de.ts gamma_fr.ts
@@ -0,0 +1,4 @@
+include(../../common.pri)
+
+SOURCES += eta.cpp
+TRANSLATIONS = eta_de.ts
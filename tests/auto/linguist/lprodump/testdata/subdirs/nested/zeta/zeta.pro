@@ -0,0 +1,4 @@
+include(../../common.pri)
+
+SOURCES += zeta.cpp
+TRANSLATIONS = zeta_de.ts
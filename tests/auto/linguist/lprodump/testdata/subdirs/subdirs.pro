@@ -0,0 +1,2 @@
+TEMPLATE = subdirs
+SUBDIRS = alpha beta gamma delta epsilon nested
@@ -0,0 +1,150 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QProcess>
+
+#include <QtTest/QtTest>
+
+using namespace Qt::Literals::StringLiterals;
+
+class tst_lprodump : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_lprodump()
+        : lprodump(QLibraryInfo::path(QLibraryInfo::LibraryExecutablesPath) + "/lprodump")
+        , dataDir(QFINDTESTDATA("testdata/"))
+    {}
+
+private slots:
+    void jobs();
+    void parseCache();
+
+private:
+    QByteArray runLprodump(const QStringList &arguments, const QString &workDir);
+
+    const QString lprodump;
+    const QString dataDir;
+};
+
+QByteArray tst_lprodump::runLprodump(const QStringList &arguments, const QString &workDir)
+{
+    const QString outFile = QDir(workDir).filePath(u"project.json"_s);
+    QFile::remove(outFile);
+    QProcess proc;
+    proc.setWorkingDirectory(workDir);
+    proc.start(lprodump, QStringList{ u"-silent"_s, u"-out"_s, outFile } + arguments);
+    if (!proc.waitForFinished(30000) || proc.exitStatus() != QProcess::NormalExit
+            || proc.exitCode() != 0) {
+        qWarning() << proc.readAllStandardError();
+        return QByteArray();
+    }
+    QFile out(outFile);
+    if (!out.open(QIODevice::ReadOnly))
+        return QByteArray();
+    return out.readAll();
+}
+
+static QStringList projectFiles(const QJsonArray &projects)
+{
+    QStringList result;
+    for (const QJsonValue &value : projects) {
+        const QJsonObject project = value.toObject();
+        result << QFileInfo(project.value(u"projectFile"_s).toString()).fileName();
+        result += projectFiles(project.value(u"subProjects"_s).toArray());
+    }
+    return result;
+}
+
+void tst_lprodump::jobs()
+{
+    QTemporaryDir workDir;
+    QVERIFY(workDir.isValid());
+    const QString project = dataDir + u"subdirs/subdirs.pro"_s;
+
+    const QByteArray serial = runLprodump({ u"-jobs"_s, u"1"_s, project }, workDir.path());
+    QVERIFY(!serial.isEmpty());
+    const QJsonArray projects = QJsonDocument::fromJson(serial).array();
+    const QStringList expectedOrder = { u"subdirs.pro"_s, u"alpha.pro"_s, u"beta.pro"_s,
+                                        u"gamma.pro"_s, u"delta.pro"_s, u"epsilon.pro"_s,
+                                        u"nested.pro"_s, u"zeta.pro"_s, u"eta.pro"_s };
+    QCOMPARE(projectFiles(projects), expectedOrder);
+
+    // The subprojects are evaluated in parallel, but must be reported in the
+    // order of SUBDIRS, with the same content.
+    for (int i = 0; i < 5; ++i) {
+        const QByteArray parallel = runLprodump({ u"-jobs"_s, u"4"_s, project }, workDir.path());
+        QCOMPARE(parallel, serial);
+    }
+}
+
+void tst_lprodump::parseCache()
+{
+    QTemporaryDir workDir;
+    QVERIFY(workDir.isValid());
+    const QString parseCacheDir = dataDir + u"parsecache/"_s;
+    for (const QString &fileName : { u"project.pro"_s, u"common.pri"_s, u"main.cpp"_s })
+        QVERIFY(QFile::copy(parseCacheDir + fileName, workDir.filePath(fileName)));
+
+    const QStringList arguments = { u"-cache-dir"_s, workDir.filePath(u"cache"_s),
+                                    u"project.pro"_s };
+    const QByteArray uncached = runLprodump(arguments, workDir.path());
+    QVERIFY(uncached.contains("/shared_de.ts"));
+    const QString cacheFileName = workDir.filePath(u"cache/lprodump.cache"_s);
+    QVERIFY(QFile::exists(cacheFileName));
+    QCOMPARE(runLprodump(arguments, workDir.path()), uncached);
+
+    // Edit a string in the stored token stream of common.pri, so that only a
+    // cache hit can produce it.
+    QFile cacheFile(cacheFileName);
+    QVERIFY(cacheFile.open(QIODevice::ReadOnly));
+    QByteArray cache = cacheFile.readAll();
+    cacheFile.close();
+    const auto utf16 = [](const QString &str) {
+        QByteArray bytes;
+        QDataStream(&bytes, QIODevice::WriteOnly) << str;
+        return bytes.mid(sizeof(quint32)); // without the length
+    };
+    QVERIFY(cache.contains(utf16(u"shared_de"_s)));
+    cache.replace(utf16(u"shared_de"_s), utf16(u"cached_de"_s));
+    const auto writeCache = [&](const QByteArray &data) {
+        QFile file(cacheFileName);
+        return file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+                && file.write(data) == data.size();
+    };
+    QVERIFY(writeCache(cache));
+    const QByteArray cached = runLprodump(arguments, workDir.path());
+    QVERIFY2(cached.contains("/cached_de.ts"), cached.constData());
+
+    // A cache file that is truncated, was written by another version of the
+    // format, or is not a cache file at all is ignored.
+    QByteArray otherVersion = cache;
+    otherVersion[7] = char(otherVersion.at(7) + 1);
+    const QList<QByteArray> brokenCaches = { cache.left(cache.size() - 3), otherVersion,
+                                             QByteArray("not a cache file") };
+    for (const QByteArray &broken : brokenCaches) {
+        QVERIFY(writeCache(broken));
+        QCOMPARE(runLprodump(arguments, workDir.path()), uncached);
+    }
+
+    // An edited file is parsed again, even though its entry is in the cache
+    QVERIFY(writeCache(cache));
+    QVERIFY(QFile::remove(workDir.filePath(u"common.pri"_s)));
+    QVERIFY(QFile::copy(parseCacheDir + u"common.pri.changed"_s,
+                        workDir.filePath(u"common.pri"_s)));
+    const QByteArray changed = runLprodump(arguments, workDir.path());
+    QVERIFY2(changed.contains("/shared_de.ts"), changed.constData());
+    QVERIFY(changed.contains("/shared_fr.ts"));
+    QVERIFY(!changed.contains("/cached_de.ts"));
+}
+
+QTEST_MAIN(tst_lprodump)
+#include "tst_lprodump.moc"
@@ -27,6 +27,8 @@ private slots:
     void markuntranslated();
     void dupes();
     void noTranslations();
+    void jobs();
+    void incremental();
 
 private:
     void doCompare(const QStringList &actual, const QString &expectedFn);
@@ -194,5 +196,46 @@ void tst_lrelease::noTranslations()
     QVERIFY(stderrOutput.contains("lrelease warning: Met no 'TRANSLATIONS' entry in project file"));
 }
 
+void tst_lrelease::jobs()
+{
+    QVERIFY(!QProcess::execute(lrelease, QStringList() << "-jobs" << "2"
+                                                       << (dataDir + "translate.ts")
+                                                       << (dataDir + "compressed.ts")));
+
+    QTranslator translator;
+    QVERIFY(translator.load(dataDir + "translate.qm"));
+    QCOMPARE(translator.translate("CubeForm", "Test"), QString::fromLatin1("BBBB"));
+
+    QTranslator compressedTranslator;
+    QVERIFY(compressedTranslator.load(dataDir + "compressed.qm"));
+    QCOMPARE(compressedTranslator.translate("Context1", "Foo"),
+             QString::fromLatin1("in first context"));
+}
+
+void tst_lrelease::incremental()
+{
+    QTemporaryDir tmpDir;
+    QVERIFY(tmpDir.isValid());
+    const QString tsFile = tmpDir.filePath("translate.ts");
+    QVERIFY(QFile::copy(dataDir + "translate.ts", tsFile));
+
+    auto release = [&](const QStringList &options) {
+        QProcess proc;
+        proc.start(lrelease, QStringList() << options << "-incremental" << tsFile);
+        if (!proc.waitForFinished() || proc.exitStatus() != QProcess::NormalExit
+            || proc.exitCode() != 0) {
+            return QByteArray();
+        }
+        return proc.readAllStandardOutput();
+    };
+
+    QVERIFY(release({}).contains("Updating"));
+    QVERIFY(QFile::exists(tmpDir.filePath("translate.qm")));
+    QVERIFY(release({}).contains("is up to date"));
+    // Other options produce another QM file
+    QVERIFY(release({ "-compress" }).contains("Updating"));
+    QVERIFY(release({ "-compress" }).contains("is up to date"));
+}
+
 QTEST_MAIN(tst_lrelease)
 #include "tst_lrelease.moc"
@@ -0,0 +1,5 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#define OPEN QT_TRANSLATE_NOOP("Context", "Open")
+#define CLOSE QT_TRANSLATE_NOOP("Context", "Close")
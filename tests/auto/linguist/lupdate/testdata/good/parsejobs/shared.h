@@ -0,0 +1,15 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#ifndef SHARED_H
+#define SHARED_H
+
+class Dialog
+{
+    Q_OBJECT
+public:
+    Dialog();
+    void retranslate();
+};
+
+#endif
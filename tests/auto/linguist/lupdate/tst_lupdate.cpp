@@ -6,6 +6,7 @@
 #endif
 
 #include <QtCore/QByteArray>
+#include <QtCore/QDataStream>
 #include <QtCore/QDebug>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
@@ -28,6 +29,7 @@ public:
 private slots:
     void good_data();
     void good();
+    void extractionCache();
 #if CHECK_SIMTEXTH
     void simtexth();
     void simtexth_data();
@@ -236,6 +238,8 @@ void tst_lupdate::good_data()
         "cmdline_deeppath", //no project file, new parser does not support (yet) this way of launching lupdate
         "cmdline_order", // no project, new parser do not pickup on macro defined but not used. Test not needed for new parser.
         "cmdline_recurse", // recursive scan without project file not supported (yet) with the new parser
+        "jobs", // no project file, tests updating TS files rather than parsing
+        "parsejobs", // no project file, tests the built-in parser
     };
     for (const QString &dir : dirs) {
         if (ignoredTests.contains(dir))
@@ -341,6 +345,66 @@ void tst_lupdate::good()
     }
 }
 
+void tst_lupdate::extractionCache()
+{
+    QTemporaryDir workDir;
+    QVERIFY(workDir.isValid());
+    const QString dataDir = m_basePath + u"extractioncache/"_s;
+    QVERIFY(QFile::copy(dataDir + u"main.cpp"_s, workDir.filePath(u"main.cpp"_s)));
+    QVERIFY(QFile::copy(dataDir + u"shared.h"_s, workDir.filePath(u"shared.h"_s)));
+
+    const QStringList arguments = { u"-silent"_s, u"-cache-dir"_s, workDir.filePath(u"cache"_s),
+                                    u"main.cpp"_s, u"-ts"_s, u"project.ts"_s };
+    const auto runLupdate = [&]() {
+        QFile::remove(workDir.filePath(u"project.ts"_s));
+        QProcess proc;
+        proc.setWorkingDirectory(workDir.path());
+        proc.setProcessChannelMode(QProcess::MergedChannels);
+        proc.start(m_cmdLupdate, arguments);
+        return proc.waitForFinished(30000) && proc.exitStatus() == QProcess::NormalExit
+                && proc.exitCode() == 0;
+    };
+
+    QVERIFY2(runLupdate(), qPrintable(arguments.join(u' ')));
+    doCompare(workDir.filePath(u"project.ts"_s), dataDir + u"project.ts.result"_s, false);
+    if (QTest::currentTestFailed())
+        return;
+
+    // The second run takes the messages from the cache. Edit the source text
+    // in the cache entry, so that only a cache hit can produce it.
+    const QFileInfoList entries = QDir(workDir.filePath(u"cache"_s)).entryInfoList(QDir::Files);
+    QCOMPARE(entries.size(), 1);
+    QFile entry(entries.first().filePath());
+    QVERIFY(entry.open(QIODevice::ReadWrite));
+    QByteArray data = entry.readAll();
+    const auto utf16 = [](const QString &str) {
+        QByteArray bytes;
+        QDataStream(&bytes, QIODevice::WriteOnly) << str;
+        return bytes;
+    };
+    const QByteArray original = utf16(u"Retranslate"_s);
+    const QByteArray edited = utf16(u"FromTheCach"_s);
+    QVERIFY(data.contains(original));
+    data.replace(original, edited);
+    QVERIFY(entry.seek(0));
+    QCOMPARE(entry.write(data), data.size());
+    entry.close();
+
+    QVERIFY2(runLupdate(), qPrintable(arguments.join(u' ')));
+    QFile ts(workDir.filePath(u"project.ts"_s));
+    QVERIFY(ts.open(QIODevice::ReadOnly));
+    const QByteArray tsContent = ts.readAll();
+    QVERIFY2(tsContent.contains("<source>FromTheCach</source>"), tsContent.constData());
+    QVERIFY(!tsContent.contains("<source>Retranslate</source>"));
+    ts.close();
+
+    // Changing an included header invalidates the entry of the source file
+    QVERIFY(QFile::remove(workDir.filePath(u"shared.h"_s)));
+    QVERIFY(QFile::copy(dataDir + u"shared.h.changed"_s, workDir.filePath(u"shared.h"_s)));
+    QVERIFY2(runLupdate(), qPrintable(arguments.join(u' ')));
+    doCompare(workDir.filePath(u"project.ts"_s), dataDir + u"project.ts.changed.result"_s, false);
+}
+
 #if CHECK_SIMTEXTH
 void tst_lupdate::simtexth()
 {
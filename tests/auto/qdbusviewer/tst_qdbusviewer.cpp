@@ -0,0 +1,135 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+#include <QtTest/QtTest>
+
+#include <QtCore/QProcess>
+#include <QtCore/QStandardPaths>
+#include <QtDBus/QDBusConnection>
+
+#include "../../../src/qdbus/qdbusviewer/qdbusintrospector.h"
+#include "../../../src/qdbus/qdbusviewer/qdbusmodel.h"
+
+#include <algorithm>
+
+static const char serviceName[] = "org.qtproject.tst_qdbusviewer";
+
+class Exported : public QObject
+{
+    Q_OBJECT
+
+public slots:
+    void ping() {}
+};
+
+class tst_QDBusViewer : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void invalidatePrefix();
+    void refreshDropsPrefetchedChildren();
+
+private:
+    bool registerObject(const QString &path);
+    static bool hasChild(const QDBusIntrospectedObject &object, const QString &name);
+
+    QProcess m_daemon;
+    QString m_address;
+    Exported m_object;
+};
+
+// Runs a private bus, so that the test doesn't depend on the session bus
+void tst_QDBusViewer::initTestCase()
+{
+    const QString daemon = QStandardPaths::findExecutable(QLatin1String("dbus-daemon"));
+    if (daemon.isEmpty())
+        QSKIP("dbus-daemon is not available");
+
+    m_daemon.start(daemon, { QLatin1String("--session"), QLatin1String("--nofork"),
+                             QLatin1String("--print-address") });
+    QVERIFY2(m_daemon.waitForStarted(), qPrintable(m_daemon.errorString()));
+    while (!m_daemon.canReadLine())
+        QVERIFY(m_daemon.waitForReadyRead(10000));
+    m_address = QString::fromLocal8Bit(m_daemon.readLine()).trimmed();
+
+    QDBusConnection server = QDBusConnection::connectToBus(m_address, QLatin1String("server"));
+    QVERIFY(server.isConnected());
+    QVERIFY(server.registerService(QLatin1String(serviceName)));
+    QVERIFY(registerObject(QLatin1String("/a/b")));
+    QVERIFY(registerObject(QLatin1String("/ab")));
+    QVERIFY(registerObject(QLatin1String("/c")));
+}
+
+void tst_QDBusViewer::cleanupTestCase()
+{
+    QDBusConnection::disconnectFromBus(QLatin1String("client"));
+    QDBusConnection::disconnectFromBus(QLatin1String("server"));
+    if (m_daemon.state() != QProcess::NotRunning) {
+        m_daemon.kill();
+        m_daemon.waitForFinished();
+    }
+}
+
+bool tst_QDBusViewer::registerObject(const QString &path)
+{
+    return QDBusConnection(QLatin1String("server"))
+            .registerObject(path, &m_object, QDBusConnection::ExportAllSlots);
+}
+
+bool tst_QDBusViewer::hasChild(const QDBusIntrospectedObject &object, const QString &name)
+{
+    return std::any_of(object.cbegin(), object.cend(), [&name](const QDBusIntrospectedItem &item) {
+        return item.type == QDBusModel::PathItem && item.name == name + QLatin1Char('/');
+    });
+}
+
+void tst_QDBusViewer::invalidatePrefix()
+{
+    const QString service = QLatin1String(serviceName);
+    QDBusIntrospector introspector(QDBusConnection::connectToBus(m_address,
+                                                                 QLatin1String("client")));
+    const QStringList paths = { QLatin1String("/a"), QLatin1String("/a/b"),
+                                QLatin1String("/ab"), QLatin1String("/c") };
+    QDBusIntrospectedObject object;
+    for (const QString &path : paths) {
+        introspector.introspect(service, path);
+        QTRY_VERIFY(introspector.cachedObject(service, path, &object));
+    }
+
+    introspector.invalidatePrefix(service, QLatin1String("/a"));
+    QVERIFY(!introspector.cachedObject(service, QLatin1String("/a"), &object));
+    QVERIFY(!introspector.cachedObject(service, QLatin1String("/a/b"), &object));
+    QVERIFY(introspector.cachedObject(service, QLatin1String("/ab"), &object));
+    QVERIFY(introspector.cachedObject(service, QLatin1String("/c"), &object));
+
+    introspector.invalidatePrefix(service, QLatin1String("/"));
+    for (const QString &path : paths)
+        QVERIFY(!introspector.cachedObject(service, path, &object));
+}
+
+void tst_QDBusViewer::refreshDropsPrefetchedChildren()
+{
+    const QString service = QLatin1String(serviceName);
+    QDBusConnection client = QDBusConnection::connectToBus(m_address, QLatin1String("client"));
+    QDBusIntrospector introspector(client);
+    QDBusModel model(service, client, &introspector);
+
+    // Introspecting the root prefetches its children
+    QDBusIntrospectedObject object;
+    QTRY_VERIFY(introspector.cachedObject(service, QLatin1String("/a"), &object));
+    QVERIFY(hasChild(object, QLatin1String("b")));
+    QVERIFY(!hasChild(object, QLatin1String("d")));
+
+    QVERIFY(registerObject(QLatin1String("/a/d")));
+    model.refresh();
+    QVERIFY(!introspector.cachedObject(service, QLatin1String("/a"), &object));
+
+    QTRY_VERIFY(introspector.cachedObject(service, QLatin1String("/a"), &object));
+    QVERIFY(hasChild(object, QLatin1String("b")));
+    QVERIFY(hasChild(object, QLatin1String("d")));
+}
+
+QTEST_MAIN(tst_QDBusViewer)
+#include "tst_qdbusviewer.moc"
@@ -21,6 +21,9 @@ private slots:
     void htmlFromCpp();
     void htmlFromQml();
     void htmlFromCppBug80259();
+    void htmlFromCppParallelParsing();
+    void htmlFromCppCachedComments();
+    void htmlWrittenAsynchronously();
 
     // WebXML generator
     void webXmlFromQDocFile();
@@ -259,6 +262,75 @@ void tst_generatedOutput::htmlFromCppBug80259()
                    "index.html");
 }
 
+void tst_generatedOutput::htmlFromCppParallelParsing()
+{
+    // Parsing sources on worker threads must not change the output
+    testAndCompare("testdata/configs/testcpp.qdocconf",
+                   "testcpp-module.html "
+                   "testqdoc-test.html "
+                   "testqdoc-test-members.html "
+                   "testqdoc-testderived.html "
+                   "testqdoc.html",
+                   "-jobs 4");
+}
+
+void tst_generatedOutput::htmlFromCppCachedComments()
+{
+    // The first run fills the cache, the second one reads from it
+    QTemporaryDir cacheDir;
+    QVERIFY(cacheDir.isValid());
+    const QByteArray cacheParam = QByteArray("-cachedir ") + cacheDir.path().toLocal8Bit();
+    for (int run = 0; run < 2; ++run) {
+        QScopedValueRollback<bool> skipRegen(m_regen, false);
+        testAndCompare("testdata/configs/testcpp.qdocconf",
+                       "testcpp-module.html "
+                       "testqdoc-test.html "
+                       "testqdoc-test-members.html "
+                       "testqdoc-testderived.html "
+                       "testqdoc.html",
+                       cacheParam.constData());
+        if (QTest::currentTestFailed())
+            return;
+    }
+}
+
+void tst_generatedOutput::htmlWrittenAsynchronously()
+{
+    // Writing pages on worker threads must produce the same files as writing
+    // them one after another
+    const QString config = QFINDTESTDATA("testdata/configs/testqml.qdocconf");
+    const QString serialDir = m_outputDir->path() + "/serial";
+    const QString asyncDir = m_outputDir->path() + "/async";
+    runQDocProcess({ "-outputdir", serialDir, "-jobs", "1", config });
+    if (QTest::currentTestFailed())
+        return;
+    runQDocProcess({ "-outputdir", asyncDir, "-jobs", "4", config });
+    if (QTest::currentTestFailed())
+        return;
+
+    QStringList files;
+    QDirIterator it(serialDir, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+        files << QDir(serialDir).relativeFilePath(it.next());
+    QVERIFY(!files.isEmpty());
+
+    QStringList asyncFiles;
+    QDirIterator asyncIt(asyncDir, QDir::Files, QDirIterator::Subdirectories);
+    while (asyncIt.hasNext())
+        asyncFiles << QDir(asyncDir).relativeFilePath(asyncIt.next());
+    files.sort();
+    asyncFiles.sort();
+    QCOMPARE(asyncFiles, files);
+
+    for (const QString &file : std::as_const(files)) {
+        QFile serialFile(serialDir + "/" + file);
+        QFile asyncFile(asyncDir + "/" + file);
+        QVERIFY(serialFile.open(QIODevice::ReadOnly));
+        QVERIFY(asyncFile.open(QIODevice::ReadOnly));
+        QVERIFY2(asyncFile.readAll() == serialFile.readAll(), qPrintable(file));
+    }
+}
+
 void tst_generatedOutput::webXmlFromQDocFile()
 {
     testAndCompare("testdata/configs/webxml_test.qdocconf",
@@ -0,0 +1,93 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <qdoc_catch_conversions.h>
+
+#include <catch.hpp>
+
+#include <binaryindex.h>
+
+#include <QTemporaryDir>
+#include <QFile>
+#include <QXmlStreamReader>
+
+static const char indexContents[] =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<!DOCTYPE QDOCINDEX>\n"
+        "<INDEX url=\"https://doc.qt.io\" title=\"Test\" project=\"Test\">\n"
+        "    <namespace name=\"\" status=\"active\">\n"
+        "        <class name=\"QFoo\" href=\"qfoo.html\" brief=\"A &lt;foo&gt; \xc3\xa9\">\n"
+        "            <function name=\"bar\" signature=\"void bar()\"/>\n"
+        "            <keyword name=\"foo\" title=\"\"/>\n"
+        "        </class>\n"
+        "        <page name=\"index.html\" href=\"index.html\"/>\n"
+        "    </namespace>\n"
+        "</INDEX>\n";
+
+template <typename Reader>
+static QStringList readTokens(Reader &reader)
+{
+    QStringList tokens;
+    while (reader.readNextStartElement()) {
+        tokens << QLatin1String("<") + reader.name().toString();
+        for (const auto &attribute : reader.attributes())
+            tokens << attribute.qualifiedName().toString() + QLatin1Char('=')
+                            + attribute.value().toString();
+        if (reader.name() == QLatin1String("keyword")) {
+            reader.skipCurrentElement();
+            tokens << QLatin1String("skipped");
+            continue;
+        }
+        tokens << readTokens(reader);
+        tokens << QLatin1String(">");
+    }
+    return tokens;
+}
+
+SCENARIO("Reading the binary form of an index file", "[BinaryIndex]") {
+    GIVEN("An index file") {
+        QTemporaryDir workingDirectory;
+        REQUIRE(workingDirectory.isValid());
+        const QString indexPath = workingDirectory.filePath("test.index");
+        {
+            QFile indexFile(indexPath);
+            REQUIRE(indexFile.open(QIODevice::WriteOnly));
+            indexFile.write(indexContents);
+        }
+
+        WHEN("No binary form of it has been written") {
+            THEN("The binary reader is not valid") {
+                REQUIRE(!BinaryIndexReader(indexPath).isValid());
+            }
+        }
+
+        WHEN("Its binary form is written") {
+            REQUIRE(BinaryIndexReader::write(indexPath));
+
+            THEN("Reading it reports the same elements and attributes as reading the XML file") {
+                QFile indexFile(indexPath);
+                REQUIRE(indexFile.open(QIODevice::ReadOnly));
+                QXmlStreamReader xmlReader(&indexFile);
+                xmlReader.setNamespaceProcessing(false);
+
+                BinaryIndexReader binaryReader(indexPath);
+                REQUIRE(binaryReader.isValid());
+
+                const QStringList expected = readTokens(xmlReader);
+                REQUIRE(!expected.isEmpty());
+                REQUIRE(readTokens(binaryReader) == expected);
+            }
+
+            AND_WHEN("The index file is modified afterwards") {
+                QFile indexFile(indexPath);
+                REQUIRE(indexFile.open(QIODevice::Append));
+                indexFile.write("\n");
+                indexFile.close();
+
+                THEN("The binary reader is not valid") {
+                    REQUIRE(!BinaryIndexReader(indexPath).isValid());
+                }
+            }
+        }
+    }
+}
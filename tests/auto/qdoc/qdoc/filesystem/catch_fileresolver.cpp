@@ -305,3 +305,45 @@ TEST_CASE(
         QFileInfo{greatest_lower_bound.value() + "/" + relative_path}.canonicalFilePath()
     );
 }
+
+TEST_CASE(
+    "When a snapshot of the search directories is used, files are resolved as if the directories were searched directly",
+    "[ResolvingFiles][File][Path][Snapshot]"
+) {
+    QTemporaryDir working_directory{};
+    REQUIRE(working_directory.isValid());
+
+    QTemporaryDir snapshot_directory{};
+    REQUIRE(snapshot_directory.isValid());
+
+    const QString snapshot_path{snapshot_directory.path() + "/snapshot"};
+
+    REQUIRE(QDir{working_directory.path()}.mkpath("images"));
+    REQUIRE(QFile{working_directory.path() + "/images/first.png"}.open(QIODeviceBase::ReadWrite | QIODeviceBase::NewOnly));
+
+    DirectoryPath directory{*DirectoryPath::refine(working_directory.path())};
+
+    {
+        FileResolver file_resolver{std::vector{directory}};
+        file_resolver.use_snapshot(snapshot_path);
+
+        REQUIRE(file_resolver.resolve("images/first.png"));
+        REQUIRE(QFileInfo{snapshot_path}.isFile());
+    }
+
+    REQUIRE(QDir{working_directory.path()}.mkpath("snippets"));
+    REQUIRE(QFile{working_directory.path() + "/snippets/second.cpp"}.open(QIODeviceBase::ReadWrite | QIODeviceBase::NewOnly));
+
+    FileResolver file_resolver{std::vector{directory}};
+    file_resolver.use_snapshot(snapshot_path);
+
+    auto maybe_first_file{file_resolver.resolve("images/first.png")};
+    REQUIRE(maybe_first_file);
+    REQUIRE(maybe_first_file->get_path() == QFileInfo{working_directory.path() + "/images/first.png"}.canonicalFilePath());
+
+    auto maybe_second_file{file_resolver.resolve("snippets/second.cpp")};
+    REQUIRE(maybe_second_file);
+    REQUIRE(maybe_second_file->get_path() == QFileInfo{working_directory.path() + "/snippets/second.cpp"}.canonicalFilePath());
+
+    REQUIRE(!file_resolver.resolve("images/missing.png"));
+}
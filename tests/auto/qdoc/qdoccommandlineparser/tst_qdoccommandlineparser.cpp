@@ -94,6 +94,8 @@ void tst_QDocCommandLineParser::process()
     QVERIFY(!parser.isSet(parser.logProgressOption));
     QVERIFY(!parser.isSet(parser.singleExecOption));
     QVERIFY(!parser.isSet(parser.frameworkOption));
+    QVERIFY(!parser.isSet(parser.jobsOption));
+    QVERIFY(!parser.isSet(parser.cacheDirOption));
 
     const QStringList expectedPositionalArgument = {
         QStringLiteral("/src/qt5/qtgamepad/src/gamepad/doc/qtgamepad.qdocconf")
@@ -152,6 +154,8 @@ void tst_QDocCommandLineParser::argumentsFromCommandLineAndFile()
     QVERIFY(!parser.isSet(parser.logProgressOption));
     QVERIFY(!parser.isSet(parser.singleExecOption));
     QVERIFY(!parser.isSet(parser.frameworkOption));
+    QVERIFY(!parser.isSet(parser.jobsOption));
+    QVERIFY(!parser.isSet(parser.cacheDirOption));
 
     QCOMPARE(parser.positionalArguments(), expectedPositionalArgument);
 }
@@ -0,0 +1,66 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+#include <QtTest/QtTest>
+
+#include <QtCore/QTemporaryDir>
+#include <QtHelp/QHelpEngineCore>
+#include <QtHelp/QHelpSearchEngine>
+
+#include "../../../src/assistant/qhelpgenerator/qhelpprojectdata_p.h"
+#include "../../../src/assistant/qhelpgenerator/helpgenerator.h"
+
+class tst_QHelpSearchEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void namedEntities();
+
+private:
+    QTemporaryDir m_dir;
+    QString m_colFile;
+};
+
+void tst_QHelpSearchEngine::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    QHelpProjectData data;
+    QVERIFY(data.readData(QLatin1String(SRCDIR) + QLatin1String("/data/entities.qhp")));
+    const QString qchFile = m_dir.filePath(QLatin1String("entities.qch"));
+    HelpGenerator generator(true);
+    QVERIFY(generator.generate(&data, qchFile));
+
+    m_colFile = m_dir.filePath(QLatin1String("collection.qhc"));
+    QHelpEngineCore help(m_colFile);
+    QVERIFY(help.setupData());
+    QVERIFY(help.registerDocumentation(qchFile));
+}
+
+// Entities other than the handful of common ones are decoded too
+void tst_QHelpSearchEngine::namedEntities()
+{
+    QHelpEngineCore help(m_colFile);
+    QVERIFY(help.setupData());
+    QHelpSearchEngine search(&help);
+
+    QSignalSpy indexingSpy(&search, &QHelpSearchEngine::indexingFinished);
+    search.reindexDocumentation();
+    QVERIFY(indexingSpy.wait(10000));
+
+    QSignalSpy searchingSpy(&search, &QHelpSearchEngine::searchingFinished);
+    search.search(QString::fromUtf8("café"));
+    QVERIFY(searchingSpy.wait(10000));
+    QCOMPARE(search.searchResultCount(), 1);
+    const QList<QHelpSearchResult> results = search.searchResults(0, 1);
+    QCOMPARE(results.constFirst().url().fileName(), QLatin1String("entities.html"));
+
+    // The entity itself is not indexed
+    search.search(QLatin1String("eacute"));
+    QVERIFY(searchingSpy.wait(10000));
+    QCOMPARE(search.searchResultCount(), 0);
+}
+
+QTEST_MAIN(tst_QHelpSearchEngine)
+#include "tst_qhelpsearchengine.moc"
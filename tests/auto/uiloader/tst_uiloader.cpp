@@ -0,0 +1,134 @@
+// Copyright (C) 2023 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+#include <QtTest/QtTest>
+
+#include <QtCore/QBuffer>
+#include <QtUiTools/QUiLoader>
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QWidget>
+
+#include <memory>
+#include <vector>
+#include <utility>
+
+static const char form[] = R"(<?xml version="1.0" encoding="UTF-8"?>
+<ui version="4.0">
+ <class>Editor</class>
+ <widget class="QWidget" name="Editor">
+  <property name="geometry">
+   <rect><x>0</x><y>0</y><width>200</width><height>60</height></rect>
+  </property>
+  <layout class="QHBoxLayout" name="layout">
+   <item>
+    <widget class="QLabel" name="label">
+     <property name="text">
+      <string>Name:</string>
+     </property>
+     <property name="buddy">
+      <cstring>lineEdit</cstring>
+     </property>
+    </widget>
+   </item>
+   <item>
+    <widget class="QLineEdit" name="lineEdit">
+     <property name="maxLength">
+      <number>12</number>
+     </property>
+     <property name="placeholderText">
+      <string>Enter a name</string>
+     </property>
+     <property name="hint" stdset="0">
+      <string>dynamic</string>
+     </property>
+    </widget>
+   </item>
+  </layout>
+ </widget>
+</ui>
+)";
+
+class tst_QUiLoader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void templateInstances();
+    void nullTemplate();
+    void moveTemplate();
+};
+
+void tst_QUiLoader::templateInstances()
+{
+    QUiLoader loader;
+    QBuffer buffer;
+    buffer.setData(form);
+    const QUiTemplate uiTemplate = loader.loadTemplate(&buffer);
+    QVERIFY(!uiTemplate.isNull());
+
+    std::vector<std::unique_ptr<QWidget>> widgets;
+    for (int i = 0; i < 3; ++i) {
+        std::unique_ptr<QWidget> widget(loader.load(uiTemplate));
+        QVERIFY2(widget, qPrintable(loader.errorString()));
+        QCOMPARE(widget->objectName(), QLatin1String("Editor"));
+        QCOMPARE(widget->size(), QSize(200, 60));
+
+        auto *label = widget->findChild<QLabel *>(QLatin1String("label"));
+        auto *lineEdit = widget->findChild<QLineEdit *>(QLatin1String("lineEdit"));
+        QVERIFY(label);
+        QVERIFY(lineEdit);
+        QCOMPARE(label->text(), QLatin1String("Name:"));
+        QCOMPARE(label->buddy(), lineEdit);
+        QCOMPARE(lineEdit->maxLength(), 12);
+        QCOMPARE(lineEdit->placeholderText(), QLatin1String("Enter a name"));
+        QCOMPARE(lineEdit->property("hint").toString(), QLatin1String("dynamic"));
+
+        // Instances don't share state
+        for (const auto &other : widgets)
+            QVERIFY(other->findChild<QLineEdit *>(QLatin1String("lineEdit")) != lineEdit);
+        widgets.push_back(std::move(widget));
+    }
+
+    // A copy shares the parsed form and can be used with another loader
+    const QUiTemplate copy = uiTemplate;
+    QUiLoader otherLoader;
+    std::unique_ptr<QWidget> widget(otherLoader.load(copy));
+    QVERIFY(widget);
+    QCOMPARE(widget->findChild<QLineEdit *>(QLatin1String("lineEdit"))->maxLength(), 12);
+}
+
+void tst_QUiLoader::nullTemplate()
+{
+    QUiLoader loader;
+    QBuffer buffer;
+    buffer.setData("not a form");
+    const QUiTemplate uiTemplate = loader.loadTemplate(&buffer);
+    QVERIFY(uiTemplate.isNull());
+    QVERIFY(!loader.load(uiTemplate));
+    QVERIFY(!loader.errorString().isEmpty());
+}
+
+void tst_QUiLoader::moveTemplate()
+{
+    QUiLoader loader;
+    QBuffer buffer;
+    buffer.setData(form);
+    QUiTemplate uiTemplate = loader.loadTemplate(&buffer);
+    QVERIFY(!uiTemplate.isNull());
+
+    QUiTemplate moved(std::move(uiTemplate));
+    QVERIFY(!moved.isNull());
+
+    QUiTemplate other;
+    other.swap(moved);
+    QVERIFY(moved.isNull());
+    QVERIFY(!other.isNull());
+
+    moved = std::move(other);
+    QVERIFY(!moved.isNull());
+    std::unique_ptr<QWidget> widget(loader.load(moved));
+    QVERIFY(widget);
+}
+
+QTEST_MAIN(tst_QUiLoader)
+#include "tst_uiloader.moc"